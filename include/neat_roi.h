@@ -0,0 +1,45 @@
+/**
+ * Marks the region of interest of an application run under NEAT with the
+ * -roi_markers flag. Include this header in the application and call
+ * NEAT_RoiBegin() and NEAT_RoiEnd() around the code to instrument. Outside
+ * NEAT the markers do nothing.
+ */
+
+#ifndef NEAT_ROI_H_
+#define NEAT_ROI_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Attributes of the markers. noipa, where the compiler supports it, also
+/// keeps the calls from being optimized with knowledge of the markers' bodies.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 8
+#define NEAT_ROI_MARKER_ATTRIBUTES noinline, noipa, used
+#else
+#define NEAT_ROI_MARKER_ATTRIBUTES noinline, used
+#endif
+
+/// Written by the markers, so that their bodies differ and identical code
+/// folding cannot merge them into a single function.
+static volatile int NEAT_RoiMarkerState;
+
+/// Starts the region of interest. NEAT finds it by name, so it must not be
+/// inlined or removed. Every file including this header gets its own copy,
+/// which NEAT finds under the same name.
+static __attribute__((NEAT_ROI_MARKER_ATTRIBUTES)) void NEAT_RoiBegin(void) {
+  NEAT_RoiMarkerState = 1;
+  __asm__ __volatile__("" ::: "memory");
+}
+
+/// Ends the region of interest.
+static __attribute__((NEAT_ROI_MARKER_ATTRIBUTES)) void NEAT_RoiEnd(void) {
+  NEAT_RoiMarkerState = 0;
+  __asm__ __volatile__("" ::: "memory");
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // NEAT_ROI_H_
@@ -0,0 +1,120 @@
+#include "client_lib/default_fp_selectors/address_range_fp_selector.h"
+
+#include <pin.H>
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/registry/internal/fp_implementation_factory_registry.h"
+#include "client_lib/utils/config_file_reader.h"
+#include "client_lib/utils/fp_implementation_parameters.h"
+#include "client_lib/utils/fp_instruction.h"
+
+namespace NEAT {
+namespace {
+
+/**
+ * Parses an unsigned offset, in hexadecimal if it starts with 0x.
+ *
+ * @return Whether the whole string is a valid offset.
+ */
+BOOL ParseOffset(const string &text, ADDRINT *offset) {
+  if (text.empty() || text[0] == '-' || text[0] == '+') {
+    return FALSE;
+  }
+  char *end;
+  *offset = static_cast<ADDRINT>(strtoull(text.c_str(), &end, 0));
+  return *end == '\0';
+}
+
+}  // namespace
+
+AddressRangeFpSelector::AddressRangeFpSelector(const string &config_file_name)
+    : default_fp_implementation_(NULL) {
+  ConfigFileReader config_file(config_file_name);
+  vector<string> tokens;
+  while (config_file.NextLine(&tokens)) {
+    if (tokens[0] == "default") {
+      if (tokens.size() < 2) {
+        config_file.ErrorAndDie("expected default <implementation>");
+      }
+      if (default_fp_implementation_ != NULL) {
+        config_file.ErrorAndDie("the default implementation is already set");
+      }
+      default_fp_implementation_ =
+          config_file.CreateFpImplementationOrDie(tokens, 1);
+      continue;
+    }
+
+    if (tokens.size() < 3) {
+      config_file.ErrorAndDie(
+          "expected <image> <offset>[-<end offset>] <implementation>");
+    }
+    AddressRange range;
+    const size_t separator = tokens[1].find('-');
+    if (separator == string::npos) {
+      if (!ParseOffset(tokens[1], &range.start)) {
+        config_file.ErrorAndDie("invalid offset " + tokens[1]);
+      }
+      range.end = range.start + 1;
+    } else if (!ParseOffset(tokens[1].substr(0, separator), &range.start) ||
+               !ParseOffset(tokens[1].substr(separator + 1), &range.end) ||
+               range.end <= range.start) {
+      config_file.ErrorAndDie("invalid offset range " + tokens[1]);
+    }
+    range.fp_implementation = config_file.CreateFpImplementationOrDie(tokens, 2);
+
+    // Keep the ranges of each image sorted, rejecting overlaps as they are
+    // inserted.
+    vector<AddressRange> &ranges = image_ranges_[tokens[0]];
+    const auto next = upper_bound(ranges.begin(), ranges.end(), range);
+    if ((next != ranges.end() && next->start < range.end) ||
+        (next != ranges.begin() && (next - 1)->end > range.start)) {
+      config_file.ErrorAndDie("offset range " + tokens[1] +
+                              " overlaps another range of " + tokens[0]);
+    }
+    ranges.insert(next, range);
+  }
+
+  if (default_fp_implementation_ == NULL) {
+    default_fp_implementation_ =
+        internal::FpImplementationFactoryRegistry::
+            GetFpImplementationFactoryRegistry()
+                ->CreateFpImplementationOrDie("normal",
+                                              FpImplementationParameters());
+  }
+}
+
+FpImplementation *AddressRangeFpSelector::SelectStaticFpImplementation(
+    const FpInstruction &instruction) {
+  const string &image_path = instruction.image_name;
+  const string image_file_name = image_path.substr(image_path.rfind('/') + 1);
+  for (const string &image_name : {image_path, image_file_name}) {
+    const auto ranges = image_ranges_.find(image_name);
+    if (ranges != image_ranges_.end()) {
+      FpImplementation *fp_implementation =
+          FindRange(ranges->second, instruction.image_offset);
+      if (fp_implementation != NULL) {
+        return fp_implementation;
+      }
+    }
+  }
+  return default_fp_implementation_;
+}
+
+FpImplementation *AddressRangeFpSelector::FindRange(
+    const vector<AddressRange> &ranges, const ADDRINT offset) {
+  AddressRange key;
+  key.start = offset;
+  // The last range starting at or before the offset is the only candidate.
+  const auto next = upper_bound(ranges.begin(), ranges.end(), key);
+  if (next == ranges.begin() || (next - 1)->end <= offset) {
+    return NULL;
+  }
+  return (next - 1)->fp_implementation;
+}
+
+}  // namespace NEAT
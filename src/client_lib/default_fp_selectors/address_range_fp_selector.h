@@ -0,0 +1,85 @@
+#ifndef CLIENT_LIB_DEFAULT_FP_SELECTORS_ADDRESS_RANGE_FP_SELECTOR_H_
+#define CLIENT_LIB_DEFAULT_FP_SELECTORS_ADDRESS_RANGE_FP_SELECTOR_H_
+
+#include <pin.H>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/interfaces/fp_selector.h"
+#include "client_lib/utils/fp_instruction.h"
+#include "client_lib/utils/fp_operation.h"
+
+namespace NEAT {
+
+/**
+ * An FpSelector that selects an FpImplementation based on the address of each
+ * floating-point instruction relative to the image containing it, as
+ * configured by a file read at startup. Each line of the file is a rule:
+ *
+ *     <image> <offset> <implementation> [<parameter>=<value> ...]
+ *     <image> <start offset>-<end offset> <implementation> [...]
+ *     default <implementation> [<parameter>=<value> ...]
+ *
+ * The image is either the full path or the file name of an image. Offsets are
+ * decimal, or hexadecimal with a 0x prefix, and ranges exclude their end. The
+ * ranges of an image may not overlap. Instructions outside every range use
+ * the default rule, or the normal implementation if there is none. Text after
+ * a # is ignored.
+ *
+ * The -print_fp_ins_addresses flag of NEAT lists the offset of every
+ * floating-point instruction to help write such files.
+ */
+class AddressRangeFpSelector : public FpSelector {
+ public:
+  /**
+   * Reads the rules in a config file, exiting the application if the file is
+   * invalid.
+   *
+   * @param[in] config_file_name The name of the config file.
+   */
+  explicit AddressRangeFpSelector(const string &config_file_name);
+
+  /**
+   * Never called, since every instruction is resolved when it is
+   * instrumented.
+   */
+  FpImplementation *SelectFpImplementation(
+      const FpOperation &operation) override {
+    return default_fp_implementation_;
+  }
+
+  FpImplementation *SelectStaticFpImplementation(
+      const FpInstruction &instruction) override;
+
+  BOOL NeedsFunctionCallbacks() override { return FALSE; }
+
+ private:
+  struct AddressRange {
+    ADDRINT start;
+    ADDRINT end;
+    FpImplementation *fp_implementation;
+
+    BOOL operator<(const AddressRange &other) const {
+      return start < other.start;
+    }
+  };
+
+  /**
+   * Returns the FpImplementation of the range containing an offset in a
+   * sorted list of ranges, or NULL if no range contains it.
+   */
+  static FpImplementation *FindRange(const vector<AddressRange> &ranges,
+                                     const ADDRINT offset);
+
+  /// Ranges of every image sorted by their start, keyed by the image name as
+  /// written in the config file.
+  unordered_map<string, vector<AddressRange>> image_ranges_;
+  FpImplementation *default_fp_implementation_;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_DEFAULT_FP_SELECTORS_ADDRESS_RANGE_FP_SELECTOR_H_
@@ -0,0 +1,116 @@
+#include "client_lib/default_fp_selectors/config_file_fp_selector.h"
+
+#include <pin.H>
+
+#include <fnmatch.h>
+#include <regex.h>
+
+#include <string>
+#include <vector>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/registry/internal/fp_implementation_factory_registry.h"
+#include "client_lib/utils/config_file_reader.h"
+#include "client_lib/utils/fp_implementation_parameters.h"
+#include "client_lib/utils/fp_instruction.h"
+
+namespace NEAT {
+
+ConfigFileFpSelector::ConfigFileFpSelector(const string &config_file_name)
+    : default_fp_implementation_(NULL) {
+  ConfigFileReader config_file(config_file_name);
+  vector<string> tokens;
+  while (config_file.NextLine(&tokens)) {
+    if (tokens[0] == "default") {
+      if (tokens.size() < 2) {
+        config_file.ErrorAndDie("expected default <implementation>");
+      }
+      if (default_fp_implementation_ != NULL) {
+        config_file.ErrorAndDie("the default implementation is already set");
+      }
+      default_fp_implementation_ =
+          config_file.CreateFpImplementationOrDie(tokens, 1);
+      continue;
+    }
+
+    Rule rule;
+    if (tokens[0] == "exact") {
+      rule.kind = kExactPattern;
+    } else if (tokens[0] == "glob") {
+      rule.kind = kGlobPattern;
+    } else if (tokens[0] == "regex") {
+      rule.kind = kRegexPattern;
+    } else {
+      config_file.ErrorAndDie("unknown rule " + tokens[0]);
+    }
+    if (tokens.size() < 3) {
+      config_file.ErrorAndDie("expected " + tokens[0] +
+                              " <pattern> <implementation>");
+    }
+    rule.pattern = tokens[1];
+    rule.regex = NULL;
+    if (rule.kind == kRegexPattern) {
+      // Like exact names and globs, the expression must match the whole name.
+      rule.regex = new regex_t;
+      if (regcomp(rule.regex, ("^(" + rule.pattern + ")$").c_str(),
+                  REG_EXTENDED | REG_NOSUB) != 0) {
+        config_file.ErrorAndDie("invalid regular expression " + rule.pattern);
+      }
+    }
+    rule.fp_implementation = config_file.CreateFpImplementationOrDie(tokens, 2);
+    rules_.push_back(rule);
+  }
+
+  if (default_fp_implementation_ == NULL) {
+    default_fp_implementation_ =
+        internal::FpImplementationFactoryRegistry::
+            GetFpImplementationFactoryRegistry()
+                ->CreateFpImplementationOrDie("normal",
+                                              FpImplementationParameters());
+  }
+}
+
+ConfigFileFpSelector::~ConfigFileFpSelector() {
+  for (const Rule &rule : rules_) {
+    if (rule.regex != NULL) {
+      regfree(rule.regex);
+      delete rule.regex;
+    }
+  }
+}
+
+FpImplementation *ConfigFileFpSelector::SelectStaticFpImplementation(
+    const FpInstruction &instruction) {
+  const auto resolved = resolved_functions_.find(instruction.function_name);
+  if (resolved != resolved_functions_.end()) {
+    return resolved->second;
+  }
+  FpImplementation *fp_implementation = Resolve(instruction.function_name);
+  resolved_functions_[instruction.function_name] = fp_implementation;
+  return fp_implementation;
+}
+
+FpImplementation *ConfigFileFpSelector::Resolve(
+    const string &function_name) const {
+  for (const Rule &rule : rules_) {
+    BOOL matches = FALSE;
+    switch (rule.kind) {
+      case kExactPattern:
+        matches = rule.pattern == function_name;
+        break;
+      case kGlobPattern:
+        matches = fnmatch(rule.pattern.c_str(), function_name.c_str(), 0) == 0;
+        break;
+      case kRegexPattern:
+        matches =
+            regexec(rule.regex, function_name.c_str(), 0, NULL, 0) == 0;
+        break;
+    }
+    if (matches) {
+      return rule.fp_implementation;
+    }
+  }
+  return default_fp_implementation_;
+}
+
+}  // namespace NEAT
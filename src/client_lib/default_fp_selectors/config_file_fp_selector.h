@@ -0,0 +1,86 @@
+#ifndef CLIENT_LIB_DEFAULT_FP_SELECTORS_CONFIG_FILE_FP_SELECTOR_H_
+#define CLIENT_LIB_DEFAULT_FP_SELECTORS_CONFIG_FILE_FP_SELECTOR_H_
+
+#include <pin.H>
+
+#include <regex.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/interfaces/fp_selector.h"
+#include "client_lib/utils/fp_instruction.h"
+#include "client_lib/utils/fp_operation.h"
+
+namespace NEAT {
+
+/**
+ * An FpSelector that selects an FpImplementation based on the function
+ * containing each floating-point instruction, as configured by a file read at
+ * startup. Each line of the file is a rule:
+ *
+ *     exact <function name> <implementation> [<parameter>=<value> ...]
+ *     glob <shell pattern> <implementation> [<parameter>=<value> ...]
+ *     regex <extended regular expression> <implementation> [...]
+ *     default <implementation> [<parameter>=<value> ...]
+ *
+ * Implementations are names registered with RegisterFpImplementationFactory,
+ * and every rule creates its own instance with its parameters. The first rule
+ * matching a function applies; functions matching no rule use the default
+ * rule, or the normal implementation if there is none. Patterns match whole
+ * function names, including regular expressions. Text after a # is ignored.
+ * Parameters that the implementation does not read are rejected.
+ *
+ * Rules are resolved once per instruction when it is instrumented, so no
+ * selection happens while the application runs.
+ */
+class ConfigFileFpSelector : public FpSelector {
+ public:
+  /**
+   * Reads and compiles the rules in a config file, exiting the application if
+   * the file is invalid.
+   *
+   * @param[in] config_file_name The name of the config file.
+   */
+  explicit ConfigFileFpSelector(const string &config_file_name);
+
+  ~ConfigFileFpSelector();
+
+  FpImplementation *SelectFpImplementation(
+      const FpOperation &operation) override {
+    return Resolve(operation.function_name);
+  }
+
+  FpImplementation *SelectStaticFpImplementation(
+      const FpInstruction &instruction) override;
+
+  BOOL NeedsFunctionCallbacks() override { return FALSE; }
+
+ private:
+  enum PatternKind { kExactPattern, kGlobPattern, kRegexPattern };
+
+  struct Rule {
+    PatternKind kind;
+    string pattern;
+    /// The compiled pattern of regex rules, NULL for other rules.
+    regex_t *regex;
+    FpImplementation *fp_implementation;
+  };
+
+  /**
+   * Returns the FpImplementation of the first rule matching a function.
+   */
+  FpImplementation *Resolve(const string &function_name) const;
+
+  vector<Rule> rules_;
+  FpImplementation *default_fp_implementation_;
+  /// FpImplementations already resolved for each function, only accessed
+  /// while instrumenting.
+  unordered_map<string, FpImplementation *> resolved_functions_;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_DEFAULT_FP_SELECTORS_CONFIG_FILE_FP_SELECTOR_H_
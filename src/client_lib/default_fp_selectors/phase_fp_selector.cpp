@@ -0,0 +1,154 @@
+#include "client_lib/default_fp_selectors/phase_fp_selector.h"
+
+#include <pin.H>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/utils/config_file_reader.h"
+#include "client_lib/utils/fp_operation.h"
+
+namespace NEAT {
+
+PhaseFpSelector::PhaseFpSelector(const string &config_file_name)
+    : phase_state_(0) {
+  ConfigFileReader config_file(config_file_name);
+  vector<string> tokens;
+  while (config_file.NextLine(&tokens)) {
+    if (!phases_.empty() && phases_.back().fp_op_limit == 0 &&
+        phases_.back().end_function_name.empty()) {
+      config_file.ErrorAndDie("only the last phase may have no end");
+    }
+
+    Phase phase;
+    phase.fp_op_limit = 0;
+    const vector<string>::iterator until =
+        find(tokens.begin(), tokens.end(), "until");
+    if (until != tokens.end()) {
+      if (tokens.end() - until != 3) {
+        config_file.ErrorAndDie(
+            "expected until fp_ops <count> or until function <name>");
+      }
+      const string &value = *(until + 2);
+      if (*(until + 1) == "fp_ops") {
+        char *end;
+        phase.fp_op_limit = strtoull(value.c_str(), &end, 10);
+        if (value[0] == '-' || *end != '\0' || phase.fp_op_limit == 0 ||
+            phase.fp_op_limit >= 1ull << kPhaseShift) {
+          config_file.ErrorAndDie("invalid floating-point operation count " +
+                                  value);
+        }
+      } else if (*(until + 1) == "function") {
+        phase.end_function_name = value;
+      } else {
+        config_file.ErrorAndDie("unknown phase end " + *(until + 1));
+      }
+      tokens.erase(until, tokens.end());
+    }
+    if (tokens.empty()) {
+      config_file.ErrorAndDie("expected an implementation");
+    }
+
+    if (tokens[0] == "native") {
+      if (tokens.size() > 1) {
+        config_file.ErrorAndDie("native takes no parameters");
+      }
+      phase.fp_implementation = NULL;
+    } else {
+      phase.fp_implementation =
+          config_file.CreateFpImplementationOrDie(tokens, 0);
+    }
+    phases_.push_back(phase);
+  }
+
+  if (phases_.size() > 1ull << (64 - kPhaseShift)) {
+    cerr << config_file_name << ": too many phases" << endl;
+    exit(1);
+  }
+  if (phases_.empty()) {
+    cerr << config_file_name << ": expected at least one phase" << endl;
+    exit(1);
+  }
+  if (phases_.back().fp_op_limit > 0 ||
+      !phases_.back().end_function_name.empty()) {
+    cerr << config_file_name << ": the last phase may not end" << endl;
+    exit(1);
+  }
+}
+
+FpImplementation *PhaseFpSelector::SelectFpImplementation(
+    const FpOperation &operation) {
+  UINT32 phase = GetCurrentPhase();
+  // Operations of a native phase are counted while passing through.
+  while (phases_[phase].fp_implementation != NULL &&
+         phases_[phase].fp_op_limit > 0 &&
+         !CountFpOp(phase, operation.thread_id)) {
+    EndPhase(phase);
+    phase = GetCurrentPhase();
+  }
+  FpImplementation *fp_implementation = phases_[phase].fp_implementation;
+  return fp_implementation != NULL ? fp_implementation
+                                   : &normal_fp_implementation_;
+}
+
+VOID PhaseFpSelector::OnFunctionStart(const string &function_name) {
+  const UINT32 phase = GetCurrentPhase();
+  if (function_name == phases_[phase].end_function_name) {
+    EndPhase(phase);
+  }
+}
+
+BOOL PhaseFpSelector::CountFpOp(const UINT32 phase,
+                                const THREADID thread_id) {
+  ThreadFpOpClaim &claim = thread_fp_op_claims_.Get(thread_id);
+  if (claim.phase != phase || claim.fp_ops_left == 0) {
+    claim.phase = phase;
+    claim.fp_ops_left = 0;
+    const UINT64 fp_op_count_mask = (1ull << kPhaseShift) - 1;
+    UINT64 state = phase_state_.load();
+    while (state >> kPhaseShift == phase) {
+      const UINT64 fp_ops_left =
+          phases_[phase].fp_op_limit - (state & fp_op_count_mask);
+      if (fp_ops_left == 0) {
+        break;
+      }
+      const UINT64 fp_ops =
+          fp_ops_left < kFpOpClaimSize ? fp_ops_left : kFpOpClaimSize;
+      if (phase_state_.compare_exchange_weak(state, state + fp_ops)) {
+        claim.fp_ops_left = fp_ops;
+        break;
+      }
+    }
+    if (claim.fp_ops_left == 0) {
+      return FALSE;
+    }
+  }
+  claim.fp_ops_left--;
+  return TRUE;
+}
+
+VOID PhaseFpSelector::EndPhase(const UINT32 phase) {
+  if (phase + 1 >= phases_.size()) {
+    return;
+  }
+  // The count of the new phase starts at 0 as the phase is published.
+  UINT64 state = phase_state_.load();
+  do {
+    if (state >> kPhaseShift != phase) {
+      return;
+    }
+  } while (!phase_state_.compare_exchange_weak(
+      state, static_cast<UINT64>(phase + 1) << kPhaseShift));
+  // Code instrumented to replace floating-point instructions keeps running
+  // until it is instrumented again for the native phase.
+  if (phases_[phase].fp_implementation != NULL &&
+      phases_[phase + 1].fp_implementation == NULL) {
+    PIN_RemoveInstrumentation();
+  }
+}
+
+}  // namespace NEAT
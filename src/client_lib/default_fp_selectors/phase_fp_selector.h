@@ -0,0 +1,131 @@
+#ifndef CLIENT_LIB_DEFAULT_FP_SELECTORS_PHASE_FP_SELECTOR_H_
+#define CLIENT_LIB_DEFAULT_FP_SELECTORS_PHASE_FP_SELECTOR_H_
+
+#include <pin.H>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "client_lib/default_fp_selectors/normal_fp_implementation.h"
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/interfaces/fp_selector.h"
+#include "client_lib/utils/fp_operation.h"
+#include "client_lib/utils/thread_local.h"
+
+namespace NEAT {
+
+/**
+ * An FpSelector that goes through a sequence of phases, each using a single
+ * FpImplementation or executing natively, as configured by a file read at
+ * startup. Each line of the file is a phase:
+ *
+ *     <implementation> [<parameter>=<value> ...] until fp_ops <count>
+ *     <implementation> [<parameter>=<value> ...] until function <name>
+ *     <implementation> [<parameter>=<value> ...]
+ *
+ * A phase ends once it has performed the given number of floating-point
+ * operations, or when the named function is entered, and the last phase never
+ * ends. A marker phase change can be placed anywhere in the application by
+ * calling an empty function that is not inlined. The implementation native
+ * executes floating-point instructions without instrumenting them, so native
+ * phases such as initialization run at nearly full speed. Text after a # is
+ * ignored.
+ *
+ * Each thread claims the operations of a limited phase kFpOpClaimSize at a
+ * time rather than counting every operation in a shared counter. The phase
+ * ends once its whole limit is claimed, so in multithreaded applications it
+ * may perform up to kFpOpClaimSize fewer operations per thread.
+ */
+class PhaseFpSelector : public FpSelector {
+ public:
+  /**
+   * Reads the phases in a config file, exiting the application if the file is
+   * invalid.
+   *
+   * @param[in] config_file_name The name of the config file.
+   */
+  explicit PhaseFpSelector(const string &config_file_name);
+
+  FpImplementation *SelectFpImplementation(
+      const FpOperation &operation) override;
+
+  VOID OnFunctionStart(const string &function_name) override;
+
+  BOOL IsPassThrough() override {
+    return phases_[GetCurrentPhase()].fp_implementation == NULL;
+  }
+
+  UINT64 GetPassThroughFpOpLimit() override {
+    return phases_[GetCurrentPhase()].fp_op_limit;
+  }
+
+  BOOL IsPassThroughTrigger(const string &function_name) override {
+    return function_name == phases_[GetCurrentPhase()].end_function_name;
+  }
+
+  VOID EndPassThrough(const THREADID thread_id) override {
+    EndPhase(GetCurrentPhase());
+  }
+
+ private:
+  /// Number of operations of a limited phase a thread claims at a time.
+  static const UINT64 kFpOpClaimSize = 64;
+  /// Position of the current phase in phase_state_, below which the number of
+  /// operations claimed from its limit is kept.
+  static const UINT32 kPhaseShift = 48;
+
+  struct Phase {
+    /// The implementation used by the phase, or NULL to execute natively.
+    FpImplementation *fp_implementation;
+    /// Number of floating-point operations after which the phase ends, or 0.
+    UINT64 fp_op_limit;
+    /// Name of the function whose entry ends the phase, or empty.
+    string end_function_name;
+  };
+
+  /**
+   * The operations a thread claimed from the limit of a phase and has not
+   * performed yet.
+   */
+  struct ThreadFpOpClaim {
+    ThreadFpOpClaim() : phase(0), fp_ops_left(0) {}
+
+    UINT32 phase;
+    UINT64 fp_ops_left;
+  };
+
+  UINT32 GetCurrentPhase() const {
+    return static_cast<UINT32>(phase_state_.load() >> kPhaseShift);
+  }
+
+  /**
+   * Counts an operation of a thread in a limited phase, claiming more
+   * operations from the limit of the phase once the thread used its claim.
+   *
+   * @return Whether the operation is within the limit of the phase, and FALSE
+   *     if the phase has ended or its whole limit is claimed.
+   */
+  BOOL CountFpOp(const UINT32 phase, const THREADID thread_id);
+
+  /**
+   * Moves on to the phase after the supplied one, unless another thread
+   * already did.
+   */
+  VOID EndPhase(const UINT32 phase);
+
+  vector<Phase> phases_;
+  /// The current phase, shifted by kPhaseShift, plus the number of
+  /// operations claimed from its limit. Both are updated by a single atomic
+  /// operation, so that a new phase never starts with the count of the
+  /// previous one.
+  atomic<UINT64> phase_state_;
+  ThreadLocal<ThreadFpOpClaim> thread_fp_op_claims_;
+  /// Used while code that was instrumented before a native phase started
+  /// still runs.
+  NormalFpImplementation normal_fp_implementation_;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_DEFAULT_FP_SELECTORS_PHASE_FP_SELECTOR_H_
@@ -0,0 +1,68 @@
+#ifndef CLIENT_LIB_DEFAULT_FP_SELECTORS_POSIT_FP_IMPLEMENTATION_H_
+#define CLIENT_LIB_DEFAULT_FP_SELECTORS_POSIT_FP_IMPLEMENTATION_H_
+
+#include <pin.H>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/utils/fp_operation.h"
+#include "client_lib/utils/posit.h"
+#include "client_lib/utils/soft_float.h"
+
+namespace NEAT {
+
+/**
+ * An implementation of floating-point arithmetic that emulates posits without
+ * a quire. Both operands are first rounded to the nearest posit, then the exact
+ * result of the operation is rounded to the nearest posit and converted back
+ * to the nearest FLT32. Operations producing NaR return NaN.
+ *
+ * @tparam Bits Number of bits of the posit, between 3 and 32.
+ * @tparam ExponentBits Number of exponent bits of the posit.
+ */
+template <UINT32 Bits, UINT32 ExponentBits>
+class PositFpImplementation : public FpImplementation {
+ public:
+  FLT32 FpAdd(const FpOperation &operation) override {
+    return Round(AddRoundedToOdd(Convert(operation.operand1),
+                                 Convert(operation.operand2)));
+  }
+
+  FLT32 FpSub(const FpOperation &operation) override {
+    return Round(AddRoundedToOdd(Convert(operation.operand1),
+                                 -Convert(operation.operand2)));
+  }
+
+  FLT32 FpMul(const FpOperation &operation) override {
+    const FLT64 operand1 = Convert(operation.operand1);
+    const FLT64 operand2 = Convert(operation.operand2);
+    // Posits of up to 16 bits have at most 14 significand bits, so their
+    // products are exact.
+    return Round(Bits <= 16
+                     ? MultiplyExactly(operand1, operand2)
+                     : internal::MultiplyRoundedToOdd(operand1, operand2));
+  }
+
+  FLT32 FpDiv(const FpOperation &operation) override {
+    const FLT64 operand1 = Convert(operation.operand1);
+    const FLT64 operand2 = Convert(operation.operand2);
+    return Round(Bits <= 16
+                     ? DivideRoundedToOdd(operand1, operand2)
+                     : internal::DivideWideRoundedToOdd(operand1, operand2));
+  }
+
+ private:
+  FLT64 Convert(const FLT32 value) const {
+    return decoder_.Decode(Posit<Bits, ExponentBits>::FromFlt64(value));
+  }
+
+  FLT32 Round(const FLT64 value) const {
+    return static_cast<FLT32>(
+        decoder_.Decode(Posit<Bits, ExponentBits>::FromFlt64(value)));
+  }
+
+  PositDecoder<Bits, ExponentBits> decoder_;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_DEFAULT_FP_SELECTORS_POSIT_FP_IMPLEMENTATION_H_
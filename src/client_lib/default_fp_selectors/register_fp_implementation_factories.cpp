@@ -0,0 +1,144 @@
+#include <pin.H>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "client_lib/default_fp_selectors/normal_fp_implementation.h"
+#include "client_lib/default_fp_selectors/posit_fp_implementation.h"
+#include "client_lib/default_fp_selectors/soft_float_fp_implementation.h"
+#include "client_lib/default_fp_selectors/stochastic_rounding_fp_implementation.h"
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/registry/internal/fp_implementation_factory_registry.h"
+#include "client_lib/registry/register_fp_implementation_factory.h"
+#include "client_lib/utils/cached_fp_implementation.h"
+#include "client_lib/utils/fp_implementation_parameters.h"
+#include "client_lib/utils/soft_float.h"
+
+namespace NEAT {
+namespace {
+
+/**
+ * Creates a SoftFloatFpImplementation from the parameters exponent_bits and
+ * mantissa_bits (a FLT32 by default), rounding (nearest_even, toward_zero, up,
+ * down or stochastic), flush_denormals and has_infinity.
+ */
+FpImplementation *CreateSoftFloatFpImplementation(
+    const FpImplementationParameters &parameters) {
+  const string rounding = parameters.GetString("rounding", "nearest_even");
+  FpRoundingMode rounding_mode;
+  if (rounding == "nearest_even") {
+    rounding_mode = kRoundNearestEven;
+  } else if (rounding == "toward_zero") {
+    rounding_mode = kRoundTowardZero;
+  } else if (rounding == "up") {
+    rounding_mode = kRoundUp;
+  } else if (rounding == "down") {
+    rounding_mode = kRoundDown;
+  } else if (rounding == "stochastic") {
+    rounding_mode = kRoundStochastic;
+  } else {
+    cerr << "Unknown rounding mode " << rounding << endl;
+    exit(1);
+  }
+  return new SoftFloatFpImplementation(
+      parameters.GetUint32("exponent_bits", 8),
+      parameters.GetUint32("mantissa_bits", 23), rounding_mode,
+      parameters.GetBool("flush_denormals", FALSE) ? kDenormalsFlushed
+                                                   : kDenormalsPreserved,
+      parameters.GetBool("has_infinity", TRUE));
+}
+
+/**
+ * Creates a StochasticRoundingFpImplementation from the parameter
+ * mantissa_bits, 23 by default.
+ */
+FpImplementation *CreateStochasticRoundingFpImplementation(
+    const FpImplementationParameters &parameters) {
+  return new StochasticRoundingFpImplementation(
+      parameters.GetUint32("mantissa_bits", 23));
+}
+
+/**
+ * Creates a CachedFpImplementation of the FpImplementation named by the
+ * parameter implementation (normal by default), which is created with the
+ * same parameters. Its results are persisted to the parameter cache_file, or
+ * only cached in memory if it is not set, and are only shared with
+ * implementations of the same name and parameters. The parameter version (0 by
+ * default) must be changed whenever the results of the implementation change.
+ * Implementations that round stochastically cannot be cached.
+ */
+FpImplementation *CreateCachedFpImplementation(
+    const FpImplementationParameters &parameters) {
+  const string implementation_name =
+      parameters.GetString("implementation", "normal");
+  if (implementation_name == "cached") {
+    cerr << "A cached FpImplementation cannot cache itself" << endl;
+    exit(1);
+  }
+  if (implementation_name == "stochastic_rounding" ||
+      (implementation_name == "soft_float" &&
+       parameters.GetString("rounding", "") == "stochastic")) {
+    cerr << "A cached FpImplementation cannot cache the random results of "
+         << implementation_name << endl;
+    exit(1);
+  }
+  // The parameters of the cache are read before the implementation is
+  // created, which fails on any parameter still unread.
+  const UINT32 version = parameters.GetUint32("version", 0);
+  const string cache_file_name = parameters.GetString("cache_file", "");
+  FpImplementation *fp_implementation =
+      internal::FpImplementationFactoryRegistry::
+          GetFpImplementationFactoryRegistry()
+              ->CreateFpImplementationOrDie(implementation_name, parameters);
+  // The cache file may be named differently by processes sharing it, so only
+  // the parameters of the implementation identify its results.
+  FpImplementationParameters implementation_parameters = parameters;
+  implementation_parameters.Erase("cache_file");
+  implementation_parameters.Erase("version");
+  implementation_parameters.Set("implementation", implementation_name);
+  return new CachedFpImplementation(fp_implementation,
+                                    implementation_parameters.ToString(),
+                                    version, cache_file_name);
+}
+
+}  // namespace
+
+static RegisterFpImplementationFactory normal_factory(
+    CreateFpImplementation<NormalFpImplementation>, "normal");
+static RegisterFpImplementationFactory soft_float_factory(
+    CreateSoftFloatFpImplementation, "soft_float");
+static RegisterFpImplementationFactory stochastic_rounding_factory(
+    CreateStochasticRoundingFpImplementation, "stochastic_rounding");
+static RegisterFpImplementationFactory cached_factory(
+    CreateCachedFpImplementation, "cached");
+static RegisterFpImplementationFactory fp16_factory(
+    CreateFpImplementation<Fp16FpImplementation>, "fp16");
+static RegisterFpImplementationFactory bfloat16_factory(
+    CreateFpImplementation<Bfloat16FpImplementation>, "bfloat16");
+static RegisterFpImplementationFactory tf32_factory(
+    CreateFpImplementation<Tf32FpImplementation>, "tf32");
+static RegisterFpImplementationFactory fp8_e4m3_factory(
+    CreateFpImplementation<Fp8E4M3FpImplementation>, "fp8_e4m3");
+static RegisterFpImplementationFactory fp8_e5m2_factory(
+    CreateFpImplementation<Fp8E5M2FpImplementation>, "fp8_e5m2");
+static RegisterFpImplementationFactory posit8_es0_factory(
+    CreateFpImplementation<PositFpImplementation<8, 0>>, "posit8_es0");
+static RegisterFpImplementationFactory posit8_es1_factory(
+    CreateFpImplementation<PositFpImplementation<8, 1>>, "posit8_es1");
+static RegisterFpImplementationFactory posit8_es2_factory(
+    CreateFpImplementation<PositFpImplementation<8, 2>>, "posit8_es2");
+static RegisterFpImplementationFactory posit16_es0_factory(
+    CreateFpImplementation<PositFpImplementation<16, 0>>, "posit16_es0");
+static RegisterFpImplementationFactory posit16_es1_factory(
+    CreateFpImplementation<PositFpImplementation<16, 1>>, "posit16_es1");
+static RegisterFpImplementationFactory posit16_es2_factory(
+    CreateFpImplementation<PositFpImplementation<16, 2>>, "posit16_es2");
+static RegisterFpImplementationFactory posit32_es0_factory(
+    CreateFpImplementation<PositFpImplementation<32, 0>>, "posit32_es0");
+static RegisterFpImplementationFactory posit32_es1_factory(
+    CreateFpImplementation<PositFpImplementation<32, 1>>, "posit32_es1");
+static RegisterFpImplementationFactory posit32_es2_factory(
+    CreateFpImplementation<PositFpImplementation<32, 2>>, "posit32_es2");
+
+}  // namespace NEAT
@@ -0,0 +1,26 @@
+#include "client_lib/default_fp_selectors/posit_fp_implementation.h"
+
+#include "client_lib/registry/register_single_fp_implementation_selector.h"
+
+namespace NEAT {
+
+static RegisterSingleFpImplementationSelector<PositFpImplementation<8, 0>>
+    posit8_es0_selector("posit8_es0");
+static RegisterSingleFpImplementationSelector<PositFpImplementation<8, 1>>
+    posit8_es1_selector("posit8_es1");
+static RegisterSingleFpImplementationSelector<PositFpImplementation<8, 2>>
+    posit8_es2_selector("posit8_es2");
+static RegisterSingleFpImplementationSelector<PositFpImplementation<16, 0>>
+    posit16_es0_selector("posit16_es0");
+static RegisterSingleFpImplementationSelector<PositFpImplementation<16, 1>>
+    posit16_es1_selector("posit16_es1");
+static RegisterSingleFpImplementationSelector<PositFpImplementation<16, 2>>
+    posit16_es2_selector("posit16_es2");
+static RegisterSingleFpImplementationSelector<PositFpImplementation<32, 0>>
+    posit32_es0_selector("posit32_es0");
+static RegisterSingleFpImplementationSelector<PositFpImplementation<32, 1>>
+    posit32_es1_selector("posit32_es1");
+static RegisterSingleFpImplementationSelector<PositFpImplementation<32, 2>>
+    posit32_es2_selector("posit32_es2");
+
+}  // namespace NEAT
@@ -0,0 +1,30 @@
+#include "client_lib/default_fp_selectors/soft_float_fp_implementation.h"
+
+#include "client_lib/registry/register_lookup_table_fp_selector.h"
+#include "client_lib/registry/register_single_fp_implementation_selector.h"
+
+namespace NEAT {
+
+static RegisterSingleFpImplementationSelector<Fp16FpImplementation>
+    fp16_selector("fp16");
+static RegisterSingleFpImplementationSelector<Bfloat16FpImplementation>
+    bfloat16_selector("bfloat16");
+static RegisterSingleFpImplementationSelector<Tf32FpImplementation>
+    tf32_selector("tf32");
+static RegisterSingleFpImplementationSelector<Fp8E4M3FpImplementation>
+    fp8_e4m3_selector("fp8_e4m3");
+static RegisterSingleFpImplementationSelector<Fp8E5M2FpImplementation>
+    fp8_e5m2_selector("fp8_e5m2");
+static RegisterSingleFpImplementationSelector<StochasticFp16FpImplementation>
+    fp16_stochastic_selector("fp16_stochastic");
+static RegisterSingleFpImplementationSelector<
+    StochasticBfloat16FpImplementation>
+    bfloat16_stochastic_selector("bfloat16_stochastic");
+
+// Every result of the 8-bit formats is precomputed when the application starts.
+static RegisterLookupTableFpSelector<Fp8E4M3FpImplementation>
+    fp8_e4m3_table_selector(4, 3, FALSE, "fp8_e4m3_table");
+static RegisterLookupTableFpSelector<Fp8E5M2FpImplementation>
+    fp8_e5m2_table_selector(5, 2, TRUE, "fp8_e5m2_table");
+
+}  // namespace NEAT
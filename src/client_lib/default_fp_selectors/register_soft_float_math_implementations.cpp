@@ -0,0 +1,12 @@
+#include "client_lib/default_fp_selectors/soft_float_math_implementation.h"
+
+#include "client_lib/registry/register_math_implementation.h"
+
+namespace NEAT {
+
+static RegisterMathImplementation<Fp16MathImplementation> fp16_math("fp16");
+static RegisterMathImplementation<Bfloat16MathImplementation> bfloat16_math(
+    "bfloat16");
+static RegisterMathImplementation<Tf32MathImplementation> tf32_math("tf32");
+
+}  // namespace NEAT
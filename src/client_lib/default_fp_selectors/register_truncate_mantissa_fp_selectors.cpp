@@ -0,0 +1,14 @@
+#include "client_lib/default_fp_selectors/truncate_mantissa_fp_result_transform.h"
+
+#include "client_lib/registry/register_single_fp_result_transform_selector.h"
+
+namespace NEAT {
+
+static RegisterSingleFpResultTransformSelector<
+    TruncateMantissaFpResultTransform<7>>
+    bfloat16_truncated_selector("bfloat16_truncated");
+static RegisterSingleFpResultTransformSelector<
+    TruncateMantissaFpResultTransform<10>>
+    tf32_truncated_selector("tf32_truncated");
+
+}  // namespace NEAT
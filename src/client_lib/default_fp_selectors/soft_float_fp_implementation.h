@@ -0,0 +1,191 @@
+#ifndef CLIENT_LIB_DEFAULT_FP_SELECTORS_SOFT_FLOAT_FP_IMPLEMENTATION_H_
+#define CLIENT_LIB_DEFAULT_FP_SELECTORS_SOFT_FLOAT_FP_IMPLEMENTATION_H_
+
+#include <pin.H>
+
+#include <cstdlib>
+#include <iostream>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/utils/fp_operation.h"
+#include "client_lib/utils/random.h"
+#include "client_lib/utils/soft_float.h"
+
+namespace NEAT {
+
+/**
+ * An implementation of floating-point arithmetic that emulates a binary
+ * floating-point format chosen at compile time. Both operands are first
+ * rounded to the format, then the exact result of the operation is rounded to
+ * the format.
+ *
+ * @tparam ExponentBits Number of exponent bits of the format, between 2 and 8.
+ * @tparam MantissaBits Number of explicitly stored mantissa bits of the
+ *     format, between 1 and 23.
+ * @tparam HasInfinity Whether the format can represent infinities.
+ * @tparam RoundingMode The rounding mode to use.
+ * @tparam DenormalMode How values too small to be normal are treated.
+ */
+template <UINT32 ExponentBits, UINT32 MantissaBits, BOOL HasInfinity = TRUE,
+          FpRoundingMode RoundingMode = kRoundNearestEven,
+          FpDenormalMode DenormalMode = kDenormalsPreserved>
+class StaticSoftFloatFpImplementation : public FpImplementation {
+ public:
+  static_assert(ExponentBits >= 2 && ExponentBits <= 8,
+                "Formats must have between 2 and 8 exponent bits");
+  static_assert(MantissaBits >= 1 && MantissaBits <= 23,
+                "Formats must have between 1 and 23 mantissa bits");
+
+  FLT32 FpAdd(const FpOperation &operation) override {
+    return Round(AddRoundedToOdd(Convert(operation.operand1, operation),
+                                 Convert(operation.operand2, operation)),
+                 operation);
+  }
+
+  FLT32 FpSub(const FpOperation &operation) override {
+    return Round(AddRoundedToOdd(Convert(operation.operand1, operation),
+                                 -Convert(operation.operand2, operation)),
+                 operation);
+  }
+
+  FLT32 FpMul(const FpOperation &operation) override {
+    return Round(MultiplyExactly(Convert(operation.operand1, operation),
+                                 Convert(operation.operand2, operation)),
+                 operation);
+  }
+
+  FLT32 FpDiv(const FpOperation &operation) override {
+    return Round(DivideRoundedToOdd(Convert(operation.operand1, operation),
+                                    Convert(operation.operand2, operation)),
+                 operation);
+  }
+
+ private:
+  static FLT64 Convert(const FLT32 value, const FpOperation &operation) {
+    return Round(value, operation);
+  }
+
+  static FLT64 Round(const FLT64 value, const FpOperation &operation) {
+    return RoundToFormat<RoundingMode>(
+        value, kFormat,
+        RoundingMode == kRoundStochastic ? NextRandomBits(operation.thread_id)
+                                         : 0);
+  }
+
+  static constexpr SoftFloatFormat kFormat = MakeSoftFloatFormat(
+      ExponentBits, MantissaBits, HasInfinity, DenormalMode);
+};
+
+template <UINT32 ExponentBits, UINT32 MantissaBits, BOOL HasInfinity,
+          FpRoundingMode RoundingMode, FpDenormalMode DenormalMode>
+constexpr SoftFloatFormat
+    StaticSoftFloatFpImplementation<ExponentBits, MantissaBits, HasInfinity,
+                                    RoundingMode, DenormalMode>::kFormat;
+
+/// IEEE 754 binary16.
+typedef StaticSoftFloatFpImplementation<5, 10> Fp16FpImplementation;
+/// The bfloat16 format, which has the exponent range of FLT32.
+typedef StaticSoftFloatFpImplementation<8, 7> Bfloat16FpImplementation;
+/// NVIDIA's TensorFloat-32 format.
+typedef StaticSoftFloatFpImplementation<8, 10> Tf32FpImplementation;
+/// The OCP 8-bit E4M3 format, which has no infinities and a single NaN
+/// mantissa.
+typedef StaticSoftFloatFpImplementation<4, 3, FALSE> Fp8E4M3FpImplementation;
+/// The OCP 8-bit E5M2 format.
+typedef StaticSoftFloatFpImplementation<5, 2> Fp8E5M2FpImplementation;
+/// IEEE 754 binary16 with stochastic rounding.
+typedef StaticSoftFloatFpImplementation<5, 10, TRUE, kRoundStochastic>
+    StochasticFp16FpImplementation;
+/// The bfloat16 format with stochastic rounding.
+typedef StaticSoftFloatFpImplementation<8, 7, TRUE, kRoundStochastic>
+    StochasticBfloat16FpImplementation;
+
+/**
+ * An implementation of floating-point arithmetic that emulates a binary
+ * floating-point format chosen at runtime. Both operands are first rounded to
+ * the format, then the exact result of the operation is rounded to the format.
+ *
+ * @see StaticSoftFloatFpImplementation for a faster implementation when the
+ *     format is known at compile time.
+ */
+class SoftFloatFpImplementation : public FpImplementation {
+ public:
+  /**
+   * @param[in] exponent_bits Number of exponent bits of the format, between 2
+   *     and 8.
+   * @param[in] mantissa_bits Number of explicitly stored mantissa bits of the
+   *     format, between 1 and 23.
+   * @param[in] rounding_mode The rounding mode to use.
+   * @param[in] denormal_mode How values too small to be normal are treated.
+   * @param[in] has_infinity Whether the format can represent infinities.
+   */
+  SoftFloatFpImplementation(
+      const UINT32 exponent_bits, const UINT32 mantissa_bits,
+      const FpRoundingMode rounding_mode = kRoundNearestEven,
+      const FpDenormalMode denormal_mode = kDenormalsPreserved,
+      const BOOL has_infinity = TRUE)
+      : format_(MakeSupportedFormatOrDie(exponent_bits, mantissa_bits,
+                                         has_infinity, denormal_mode)),
+        rounding_mode_(rounding_mode) {}
+
+  FLT32 FpAdd(const FpOperation &operation) override {
+    return Round(AddRoundedToOdd(Convert(operation.operand1, operation),
+                                 Convert(operation.operand2, operation)),
+                 operation);
+  }
+
+  FLT32 FpSub(const FpOperation &operation) override {
+    return Round(AddRoundedToOdd(Convert(operation.operand1, operation),
+                                 -Convert(operation.operand2, operation)),
+                 operation);
+  }
+
+  FLT32 FpMul(const FpOperation &operation) override {
+    return Round(MultiplyExactly(Convert(operation.operand1, operation),
+                                 Convert(operation.operand2, operation)),
+                 operation);
+  }
+
+  FLT32 FpDiv(const FpOperation &operation) override {
+    return Round(DivideRoundedToOdd(Convert(operation.operand1, operation),
+                                    Convert(operation.operand2, operation)),
+                 operation);
+  }
+
+ private:
+  /**
+   * Describes a format, or exits the application if it is not supported.
+   * Unsupported widths are rejected before MakeSoftFloatFormat shifts by them.
+   */
+  static SoftFloatFormat MakeSupportedFormatOrDie(
+      const UINT32 exponent_bits, const UINT32 mantissa_bits,
+      const BOOL has_infinity, const FpDenormalMode denormal_mode) {
+    if (exponent_bits < 2 || exponent_bits > 8 || mantissa_bits < 1 ||
+        mantissa_bits > 23) {
+      cerr << "Unsupported floating-point format with " << exponent_bits
+           << " exponent bits and " << mantissa_bits << " mantissa bits"
+           << endl;
+      exit(1);
+    }
+    return MakeSoftFloatFormat(exponent_bits, mantissa_bits, has_infinity,
+                               denormal_mode);
+  }
+
+  FLT64 Convert(const FLT32 value, const FpOperation &operation) const {
+    return Round(value, operation);
+  }
+
+  FLT64 Round(const FLT64 value, const FpOperation &operation) const {
+    return RoundToFormat(value, format_, rounding_mode_,
+                         rounding_mode_ == kRoundStochastic
+                             ? NextRandomBits(operation.thread_id)
+                             : 0);
+  }
+
+  const SoftFloatFormat format_;
+  const FpRoundingMode rounding_mode_;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_DEFAULT_FP_SELECTORS_SOFT_FLOAT_FP_IMPLEMENTATION_H_
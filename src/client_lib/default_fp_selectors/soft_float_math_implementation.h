@@ -0,0 +1,59 @@
+#ifndef CLIENT_LIB_DEFAULT_FP_SELECTORS_SOFT_FLOAT_MATH_IMPLEMENTATION_H_
+#define CLIENT_LIB_DEFAULT_FP_SELECTORS_SOFT_FLOAT_MATH_IMPLEMENTATION_H_
+
+#include <pin.H>
+
+#include "client_lib/interfaces/math_implementation.h"
+#include "client_lib/utils/math_call.h"
+#include "client_lib/utils/math_function.h"
+#include "client_lib/utils/soft_float.h"
+
+namespace NEAT {
+
+/**
+ * An implementation of the math library that emulates a binary
+ * floating-point format chosen at compile time. The arguments are first
+ * rounded to the format, then the function is evaluated in FLT64 and its
+ * result is rounded to nearest even in the format.
+ *
+ * @tparam ExponentBits Number of exponent bits of the format, between 2 and 8.
+ * @tparam MantissaBits Number of explicitly stored mantissa bits of the
+ *     format, between 1 and 23.
+ * @tparam HasInfinity Whether the format can represent infinities.
+ */
+template <UINT32 ExponentBits, UINT32 MantissaBits, BOOL HasInfinity = TRUE>
+class StaticSoftFloatMathImplementation : public MathImplementation {
+ public:
+  static_assert(ExponentBits >= 2 && ExponentBits <= 8,
+                "Formats must have between 2 and 8 exponent bits");
+  static_assert(MantissaBits >= 1 && MantissaBits <= 23,
+                "Formats must have between 1 and 23 mantissa bits");
+
+  FLT32 Evaluate(const MathCall &call) override {
+    return static_cast<FLT32>(Round(EvaluateMathFunction(
+        call.function, Round(call.argument1), Round(call.argument2))));
+  }
+
+ private:
+  static FLT64 Round(const FLT64 value) {
+    return RoundToFormat<kRoundNearestEven>(value, kFormat, 0);
+  }
+
+  static constexpr SoftFloatFormat kFormat = MakeSoftFloatFormat(
+      ExponentBits, MantissaBits, HasInfinity, kDenormalsPreserved);
+};
+
+template <UINT32 ExponentBits, UINT32 MantissaBits, BOOL HasInfinity>
+constexpr SoftFloatFormat StaticSoftFloatMathImplementation<
+    ExponentBits, MantissaBits, HasInfinity>::kFormat;
+
+/// IEEE 754 binary16.
+typedef StaticSoftFloatMathImplementation<5, 10> Fp16MathImplementation;
+/// The bfloat16 format, which has the exponent range of FLT32.
+typedef StaticSoftFloatMathImplementation<8, 7> Bfloat16MathImplementation;
+/// NVIDIA's TensorFloat-32 format.
+typedef StaticSoftFloatMathImplementation<8, 10> Tf32MathImplementation;
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_DEFAULT_FP_SELECTORS_SOFT_FLOAT_MATH_IMPLEMENTATION_H_
@@ -0,0 +1,78 @@
+#ifndef CLIENT_LIB_DEFAULT_FP_SELECTORS_STOCHASTIC_ROUNDING_FP_IMPLEMENTATION_H_
+#define CLIENT_LIB_DEFAULT_FP_SELECTORS_STOCHASTIC_ROUNDING_FP_IMPLEMENTATION_H_
+
+#include <pin.H>
+
+#include <cstdlib>
+#include <iostream>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/utils/fp_operation.h"
+#include "client_lib/utils/random.h"
+#include "client_lib/utils/soft_float.h"
+
+namespace NEAT {
+
+/**
+ * An implementation of floating-point arithmetic that stochastically rounds
+ * the exact result of every operation to a narrower mantissa, keeping the
+ * exponent range of FLT32. The operands are used as they are.
+ *
+ * Random bits are drawn from the generator of the thread performing the
+ * operation, so results are reproducible per thread for a given seed.
+ */
+class StochasticRoundingFpImplementation : public FpImplementation {
+ public:
+  /**
+   * @param[in] mantissa_bits Number of explicitly stored mantissa bits to
+   *     round to, between 1 and 23.
+   */
+  explicit StochasticRoundingFpImplementation(const UINT32 mantissa_bits)
+      : format_(MakeSupportedFormatOrDie(mantissa_bits)) {}
+
+  FLT32 FpAdd(const FpOperation &operation) override {
+    return Round(AddRoundedToOdd(operation.operand1, operation.operand2),
+                 operation);
+  }
+
+  FLT32 FpSub(const FpOperation &operation) override {
+    return Round(AddRoundedToOdd(operation.operand1, -operation.operand2),
+                 operation);
+  }
+
+  FLT32 FpMul(const FpOperation &operation) override {
+    return Round(MultiplyExactly(operation.operand1, operation.operand2),
+                 operation);
+  }
+
+  FLT32 FpDiv(const FpOperation &operation) override {
+    return Round(DivideRoundedToOdd(operation.operand1, operation.operand2),
+                 operation);
+  }
+
+ private:
+  /**
+   * Describes the format to round to, or exits the application if its width
+   * is not supported. Unsupported widths are rejected before
+   * MakeSoftFloatFormat shifts by them.
+   */
+  static SoftFloatFormat MakeSupportedFormatOrDie(const UINT32 mantissa_bits) {
+    if (mantissa_bits < 1 || mantissa_bits > 23) {
+      cerr << "Cannot stochastically round to " << mantissa_bits
+           << " mantissa bits" << endl;
+      exit(1);
+    }
+    return MakeSoftFloatFormat(8, mantissa_bits, TRUE, kDenormalsPreserved);
+  }
+
+  FLT32 Round(const FLT64 value, const FpOperation &operation) const {
+    return static_cast<FLT32>(RoundToFormat<kRoundStochastic>(
+        value, format_, NextRandomBits(operation.thread_id)));
+  }
+
+  const SoftFloatFormat format_;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_DEFAULT_FP_SELECTORS_STOCHASTIC_ROUNDING_FP_IMPLEMENTATION_H_
@@ -0,0 +1,39 @@
+#ifndef CLIENT_LIB_DEFAULT_FP_SELECTORS_TRUNCATE_MANTISSA_FP_RESULT_TRANSFORM_H_
+#define CLIENT_LIB_DEFAULT_FP_SELECTORS_TRUNCATE_MANTISSA_FP_RESULT_TRANSFORM_H_
+
+#include <pin.H>
+
+#include "client_lib/interfaces/fp_result_transform.h"
+
+namespace NEAT {
+
+/**
+ * Truncates the mantissa of the natively computed result of every
+ * floating-point instruction toward zero, keeping the exponent range of FLT32.
+ * Quiet NaNs stay NaNs since their most significant mantissa bit is kept.
+ *
+ * @tparam MantissaBits Number of mantissa bits to keep, between 1 and 22.
+ */
+template <UINT32 MantissaBits>
+class TruncateMantissaFpResultTransform : public FpResultTransform {
+ public:
+  static_assert(MantissaBits >= 1 && MantissaBits <= 22,
+                "Between 1 and 22 mantissa bits must be kept");
+
+  BOOL GetResultMask(UINT32 *mask) const override {
+    *mask = kMask;
+    return TRUE;
+  }
+
+  FLT32 TransformResult(const OPCODE opcode, const FLT32 result) override {
+    const UINT32 bits = *reinterpret_cast<const UINT32 *>(&result) & kMask;
+    return *reinterpret_cast<const FLT32 *>(&bits);
+  }
+
+ private:
+  static const UINT32 kMask = ~((1u << (23 - MantissaBits)) - 1);
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_DEFAULT_FP_SELECTORS_TRUNCATE_MANTISSA_FP_RESULT_TRANSFORM_H_
@@ -0,0 +1,39 @@
+#ifndef CLIENT_LIB_INTERFACES_FP_RESULT_TRANSFORM_H_
+#define CLIENT_LIB_INTERFACES_FP_RESULT_TRANSFORM_H_
+
+#include <pin.H>
+
+namespace NEAT {
+
+/**
+ * Transforms the result of a floating-point arithmetic instruction after the
+ * instruction has executed natively. This is much cheaper than replacing the
+ * instruction with an FpImplementation, but can only model arithmetic whose
+ * result is a function of the correctly rounded FLT32 result.
+ */
+class FpResultTransform {
+ public:
+  /**
+   * Returns whether this transform only clears bits of the result. The result
+   * of such transforms is computed by a Pin analysis routine that can be
+   * inlined, and TransformResult is not called.
+   *
+   * @param[out] mask The mask that the bit pattern of the result is ANDed
+   *     with, if this transform only clears bits.
+   * @return Whether this transform only clears bits of the result.
+   */
+  virtual BOOL GetResultMask(UINT32 *mask) const { return FALSE; }
+
+  /**
+   * Transforms the result of a single floating-point instruction.
+   *
+   * @param[in] opcode Opcode of the instruction.
+   * @param[in] result The result computed by the instruction.
+   * @return The transformed result.
+   */
+  virtual FLT32 TransformResult(const OPCODE opcode, const FLT32 result) = 0;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_INTERFACES_FP_RESULT_TRANSFORM_H_
@@ -6,6 +6,9 @@
 #include <string>
 
 #include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/interfaces/fp_result_transform.h"
+#include "client_lib/utils/fp_instruction.h"
+#include "client_lib/utils/fp_operand_predicate.h"
 #include "client_lib/utils/fp_operation.h"
 
 namespace NEAT {
@@ -14,6 +17,11 @@ namespace NEAT {
  * Selects which floating-point arithmetic implementation to use for an
  * arithmetic operation depending on the current state of the instrumented
  * application.
+ *
+ * The callbacks of a single FpSelector may run concurrently on different
+ * application threads. State that changes while the application runs should
+ * be kept per thread, for example in a ThreadLocal, rather than in members
+ * shared by every thread.
  */
 class FpSelector {
  public:
@@ -31,6 +39,23 @@ class FpSelector {
    */
   virtual VOID ExitCallback(const INT32 &code) {}
 
+  /**
+   * Called whenever a thread starts in the instrumented application, in that
+   * thread, before it performs any floating-point operation.
+   *
+   * @param[in] thread_id The Pin id of the thread that is starting.
+   */
+  virtual VOID OnThreadStart(const THREADID thread_id) {}
+
+  /**
+   * Called whenever a thread ends in the instrumented application, or for
+   * every remaining thread when the application exits. Per-thread state kept
+   * in a ThreadLocal is still available.
+   *
+   * @param[in] thread_id The Pin id of the thread that is ending.
+   */
+  virtual VOID OnThreadFini(const THREADID thread_id) {}
+
   /**
    * Called whenever a function begins in the instrumented application to
    * perform per-function setup for this class.
@@ -47,9 +72,43 @@ class FpSelector {
    */
   virtual VOID OnFunctionEnd(const string &function_name) {}
 
+  /**
+   * Called instead of OnFunctionStart with the thread calling the function,
+   * for FpSelectors that keep per-thread state. Calls OnFunctionStart by
+   * default.
+   *
+   * @param[in] function_name The name of the function that is beginning.
+   * @param[in] thread_id The Pin id of the thread calling the function.
+   */
+  virtual VOID OnFunctionStartInThread(const string &function_name,
+                                       const THREADID thread_id) {
+    OnFunctionStart(function_name);
+  }
+
+  /**
+   * Called instead of OnFunctionEnd with the thread returning from the
+   * function, for FpSelectors that keep per-thread state. Calls OnFunctionEnd
+   * by default.
+   *
+   * @param[in] function_name The name of the function that is ending.
+   * @param[in] thread_id The Pin id of the thread returning from the function.
+   */
+  virtual VOID OnFunctionEndInThread(const string &function_name,
+                                     const THREADID thread_id) {
+    OnFunctionEnd(function_name);
+  }
+
+  /**
+   * Returns whether the function callbacks must be called for every
+   * function, including functions without floating-point instructions. When
+   * this returns FALSE, NEAT may skip instrumenting those functions entirely.
+   */
+  virtual BOOL NeedsFunctionCallbacks() { return TRUE; }
+
   /**
    * Selects a floating-point arithmetic implementation to use for the supplied
-   * floating-point instruction.
+   * floating-point instruction. The thread performing the operation is
+   * operation.thread_id, which can index per-thread state in a ThreadLocal.
    *
    * @param[in] operation The floating-point instruction to be performed.
    * @return The floating-point implementation to use to calculate the result of
@@ -57,6 +116,89 @@ class FpSelector {
    */
   virtual FpImplementation *SelectFpImplementation(
       const FpOperation &operation) = 0;
+
+  /**
+   * Selects a floating-point arithmetic implementation to use for every
+   * execution of the supplied floating-point instruction. This is called once
+   * for every instruction, when it is instrumented, so that the instrumented
+   * application does not have to call SelectFpImplementation.
+   *
+   * @param[in] instruction The floating-point instruction being instrumented.
+   * @return The floating-point implementation to use for every execution of
+   *     the instruction, or NULL to call SelectFpImplementation every time the
+   *     instruction executes.
+   */
+  virtual FpImplementation *SelectStaticFpImplementation(
+      const FpInstruction &instruction) {
+    return NULL;
+  }
+
+  /**
+   * Selects a predicate on the operands of the supplied floating-point
+   * instruction, which is then only replaced when the predicate matches and
+   * otherwise executes natively. The predicate is evaluated by an analysis
+   * routine that Pin can inline, so operations it rejects stay cheap. This is
+   * called once for every instruction, when it is instrumented.
+   *
+   * @param[in] instruction The floating-point instruction being instrumented.
+   * @return The predicate deciding which executions of the instruction to
+   *     replace, or NULL to replace every execution.
+   */
+  virtual const FpOperandPredicate *SelectFpOperandPredicate(
+      const FpInstruction &instruction) {
+    return NULL;
+  }
+
+  /**
+   * Returns whether floating-point instructions currently execute natively.
+   * This is checked when code is instrumented. While it returns TRUE, NEAT
+   * neither replaces floating-point instructions nor calls the function
+   * callbacks, and only instruments the triggers that end the pass-through:
+   * GetPassThroughFpOpLimit and IsPassThroughTrigger. An FpSelector that starts
+   * passing through while the application runs must call
+   * PIN_RemoveInstrumentation so that code is instrumented again.
+   */
+  virtual BOOL IsPassThrough() { return FALSE; }
+
+  /**
+   * Returns the number of floating-point operations to execute while passing
+   * through before EndPassThrough is called, or 0 for no limit. The count is
+   * shared by every thread and may miss some operations executed concurrently.
+   */
+  virtual UINT64 GetPassThroughFpOpLimit() { return 0; }
+
+  /**
+   * Returns whether entering a function ends the pass-through, in which case
+   * EndPassThrough is called before the function runs.
+   *
+   * @param[in] function_name The name of the function being instrumented.
+   */
+  virtual BOOL IsPassThroughTrigger(const string &function_name) {
+    return FALSE;
+  }
+
+  /**
+   * Called when a trigger ends the pass-through. NEAT then instruments the
+   * application again and resumes it from the triggering instruction, so the
+   * FpSelector is consulted again through IsPassThrough.
+   *
+   * @param[in] thread_id The Pin id of the thread hitting the trigger.
+   */
+  virtual VOID EndPassThrough(const THREADID thread_id) {}
+
+  /**
+   * Selects a transform to apply to the result of the supplied floating-point
+   * instruction, which then executes natively instead of being replaced. This
+   * is called once for every instruction, when it is instrumented.
+   *
+   * @param[in] instruction The floating-point instruction being instrumented.
+   * @return The transform to apply to every result of the instruction, or NULL
+   *     to replace the instruction using SelectFpImplementation.
+   */
+  virtual FpResultTransform *SelectFpResultTransform(
+      const FpInstruction &instruction) {
+    return NULL;
+  }
 };
 
 }  // namespace NEAT
@@ -0,0 +1,41 @@
+#ifndef CLIENT_LIB_INTERFACES_MATH_IMPLEMENTATION_H_
+#define CLIENT_LIB_INTERFACES_MATH_IMPLEMENTATION_H_
+
+#include <pin.H>
+
+#include "client_lib/utils/math_call.h"
+#include "client_lib/utils/math_function.h"
+
+namespace NEAT {
+
+/**
+ * Implementation of the single-precision functions of the math library, such
+ * as expf, which replaces the application's math library as a whole instead
+ * of the individual floating-point instructions of its functions.
+ */
+class MathImplementation {
+ public:
+  /**
+   * Returns whether calls to a function of the math library are replaced by
+   * Evaluate. Functions that are not replaced run the application's math
+   * library. This is called once for every function, when the math library
+   * is loaded.
+   *
+   * @param[in] function The function of the math library.
+   */
+  virtual BOOL ReplacesMathFunction(const MathFunction function) {
+    return TRUE;
+  }
+
+  /**
+   * Evaluates a single call to a function of the math library.
+   *
+   * @param[in] call The call to evaluate.
+   * @return The result of the call.
+   */
+  virtual FLT32 Evaluate(const MathCall &call) = 0;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_INTERFACES_MATH_IMPLEMENTATION_H_
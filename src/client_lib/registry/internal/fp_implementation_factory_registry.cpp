@@ -0,0 +1,73 @@
+#include "client_lib/registry/internal/fp_implementation_factory_registry.h"
+
+#include <pin.H>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/utils/fp_implementation_parameters.h"
+
+namespace NEAT {
+namespace internal {
+
+/**
+ * Returns the global FpImplementation factory registry object. It is created
+ * on first use so that factories can be registered from the static
+ * initializers of any translation unit.
+ */
+FpImplementationFactoryRegistry *
+FpImplementationFactoryRegistry::GetFpImplementationFactoryRegistry() {
+  static FpImplementationFactoryRegistry factory_registry_obj;
+  return &factory_registry_obj;
+}
+
+VOID FpImplementationFactoryRegistry::RegisterFpImplementationFactory(
+    const FpImplementationFactory factory,
+    const string &fp_implementation_name) {
+  if (factory_map_.count(fp_implementation_name) > 0) {
+    cerr << "Overwriting FpImplementationFactoryRegistry entry at "
+         << fp_implementation_name << endl;
+  }
+  factory_map_[fp_implementation_name] = factory;
+}
+
+FpImplementation *FpImplementationFactoryRegistry::CreateFpImplementationOrDie(
+    const string &fp_implementation_name,
+    const FpImplementationParameters &parameters) const {
+  if (factory_map_.count(fp_implementation_name) == 0) {
+    cerr << "No FpImplementation factory registered at "
+         << fp_implementation_name << endl;
+    cerr << "Please make sure RegisterFpImplementationFactory is used to "
+            "register your FpImplementation."
+         << endl;
+    exit(1);
+  }
+  FpImplementation *fp_implementation =
+      factory_map_.find(fp_implementation_name)->second(parameters);
+  const vector<string> unused_names = parameters.GetUnusedNames();
+  if (!unused_names.empty()) {
+    for (const string &name : unused_names) {
+      cerr << "Unknown parameter " << name << " of FpImplementation "
+           << fp_implementation_name << endl;
+    }
+    exit(1);
+  }
+  return fp_implementation;
+}
+
+vector<string> FpImplementationFactoryRegistry::GetFpImplementationNames()
+    const {
+  vector<string> names;
+  for (const auto &entry : factory_map_) {
+    names.push_back(entry.first);
+  }
+  sort(names.begin(), names.end());
+  return names;
+}
+
+}  // namespace internal
+}  // namespace NEAT
@@ -0,0 +1,71 @@
+#ifndef CLIENT_LIB_REGISTRY_INTERNAL_FP_IMPLEMENTATION_FACTORY_REGISTRY_H_
+#define CLIENT_LIB_REGISTRY_INTERNAL_FP_IMPLEMENTATION_FACTORY_REGISTRY_H_
+
+#include <pin.H>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/utils/fp_implementation_parameters.h"
+
+namespace NEAT {
+
+/**
+ * Creates a new FpImplementation configured by the supplied parameters.
+ */
+typedef FpImplementation *(*FpImplementationFactory)(
+    const FpImplementationParameters &parameters);
+
+namespace internal {
+
+/**
+ * A registry mapping names to functions that create FpImplementation
+ * instances at runtime, used by FpSelectors that are configured without
+ * rebuilding the registry library.
+ */
+class FpImplementationFactoryRegistry {
+ public:
+  /**
+   * Returns the global registry for FpImplementation factories.
+   */
+  static FpImplementationFactoryRegistry *GetFpImplementationFactoryRegistry();
+
+  /**
+   * Creates a new mapping from a name to an FpImplementation factory in the
+   * registry.
+   *
+   * @param[in] factory The factory to register.
+   * @param[in] fp_implementation_name The name to register for the factory.
+   */
+  VOID RegisterFpImplementationFactory(const FpImplementationFactory factory,
+                                       const string &fp_implementation_name);
+
+  /**
+   * Creates a new FpImplementation with the factory mapped to the supplied
+   * name, or exits the application if no factory is mapped to that name or if
+   * the factory does not read every parameter.
+   *
+   * @param[in] fp_implementation_name The name to look up in the registry.
+   * @param[in] parameters The parameters to pass to the factory.
+   * @return The new FpImplementation instance.
+   */
+  FpImplementation *CreateFpImplementationOrDie(
+      const string &fp_implementation_name,
+      const FpImplementationParameters &parameters) const;
+
+  /**
+   * Returns the names of every registered FpImplementation factory, sorted.
+   */
+  vector<string> GetFpImplementationNames() const;
+
+ private:
+  /// Mapping from names to FpImplementation factories.
+  unordered_map<string, FpImplementationFactory> factory_map_;
+};
+
+}  // namespace internal
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_REGISTRY_INTERNAL_FP_IMPLEMENTATION_FACTORY_REGISTRY_H_
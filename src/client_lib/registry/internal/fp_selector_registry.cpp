@@ -2,9 +2,11 @@
 
 #include <pin.H>
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "client_lib/interfaces/fp_selector.h"
 
@@ -40,5 +42,14 @@ FpSelector *FpSelectorRegistry::GetFpSelectorOrDie(
   return fp_selector_map_.find(fp_selector_name)->second;
 }
 
+vector<string> FpSelectorRegistry::GetFpSelectorNames() const {
+  vector<string> names;
+  for (const auto &entry : fp_selector_map_) {
+    names.push_back(entry.first);
+  }
+  sort(names.begin(), names.end());
+  return names;
+}
+
 }  // namespace internal
 }  // namespace NEAT
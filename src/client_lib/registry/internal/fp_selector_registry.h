@@ -5,6 +5,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "client_lib/interfaces/fp_selector.h"
 
@@ -43,6 +44,11 @@ class FpSelectorRegistry {
    */
   FpSelector *GetFpSelectorOrDie(const string &fp_selector_name) const;
 
+  /**
+   * Returns the names of every registered FpSelector instance, sorted.
+   */
+  vector<string> GetFpSelectorNames() const;
+
  private:
   /// Mapping from names to FpSelector instances.
   unordered_map<string, FpSelector *> fp_selector_map_;
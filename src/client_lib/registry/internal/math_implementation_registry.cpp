@@ -0,0 +1,49 @@
+#include "client_lib/registry/internal/math_implementation_registry.h"
+
+#include <pin.H>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "client_lib/interfaces/math_implementation.h"
+
+namespace NEAT {
+namespace internal {
+
+/**
+ * Returns the global MathImplementation registry object. It is created on
+ * first use so that MathImplementations can be registered from the static
+ * initializers of any translation unit.
+ */
+MathImplementationRegistry *
+MathImplementationRegistry::GetMathImplementationRegistry() {
+  static MathImplementationRegistry math_implementation_registry_obj;
+  return &math_implementation_registry_obj;
+}
+
+VOID MathImplementationRegistry::RegisterMathImplementation(
+    MathImplementation *math_implementation,
+    const string &math_implementation_name) {
+  if (math_implementation_map_.count(math_implementation_name) > 0) {
+    cerr << "Overwriting MathImplementationRegistry entry at "
+         << math_implementation_name << endl;
+  }
+  math_implementation_map_[math_implementation_name] = math_implementation;
+}
+
+MathImplementation *MathImplementationRegistry::GetMathImplementationOrDie(
+    const string &math_implementation_name) const {
+  if (math_implementation_map_.count(math_implementation_name) == 0) {
+    cerr << "No MathImplementation registered at " << math_implementation_name
+         << endl;
+    cerr << "Please make sure RegisterMathImplementation is used to register "
+            "your MathImplementation."
+         << endl;
+    exit(1);
+  }
+  return math_implementation_map_.find(math_implementation_name)->second;
+}
+
+}  // namespace internal
+}  // namespace NEAT
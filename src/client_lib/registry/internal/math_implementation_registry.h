@@ -0,0 +1,57 @@
+#ifndef CLIENT_LIB_REGISTRY_INTERNAL_MATH_IMPLEMENTATION_REGISTRY_H_
+#define CLIENT_LIB_REGISTRY_INTERNAL_MATH_IMPLEMENTATION_REGISTRY_H_
+
+#include <pin.H>
+
+#include <string>
+#include <unordered_map>
+
+#include "client_lib/interfaces/math_implementation.h"
+
+namespace NEAT {
+namespace internal {
+
+/**
+ * Contains a mapping from names to MathImplementation instances. This is used
+ * to determine which MathImplementation instance replaces the math library of
+ * a program when the KnobMathImplementation flag is supplied on the command
+ * line.
+ */
+class MathImplementationRegistry {
+ public:
+  /**
+   * Returns the global registry for MathImplementation instances.
+   */
+  static MathImplementationRegistry *GetMathImplementationRegistry();
+
+  /**
+   * Creates a new mapping from a name to a MathImplementation instance in the
+   * registry.
+   *
+   * @param[in] math_implementation The MathImplementation instance to
+   *     register.
+   * @param[in] math_implementation_name The name to register for the
+   *     MathImplementation instance.
+   */
+  VOID RegisterMathImplementation(MathImplementation *math_implementation,
+                                  const string &math_implementation_name);
+
+  /**
+   * Returns the MathImplementation instance mapped to the supplied name, or
+   * exits the application if no instance is mapped to that name.
+   *
+   * @param[in] math_implementation_name The name to look up in the registry.
+   * @return The MathImplementation instance mapped to the supplied name.
+   */
+  MathImplementation *GetMathImplementationOrDie(
+      const string &math_implementation_name) const;
+
+ private:
+  /// Mapping from names to MathImplementation instances.
+  unordered_map<string, MathImplementation *> math_implementation_map_;
+};
+
+}  // namespace internal
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_REGISTRY_INTERNAL_MATH_IMPLEMENTATION_REGISTRY_H_
@@ -47,6 +47,8 @@ class CurrentFunctionFpSelector : public FpSelector {
     return default_fp_impl_;
   }
 
+  BOOL NeedsFunctionCallbacks() override { return FALSE; }
+
  private:
   unordered_map<string, FpImplementation *> function_name_map_;
   FpImplementation *default_fp_impl_;
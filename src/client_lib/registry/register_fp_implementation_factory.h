@@ -0,0 +1,47 @@
+#ifndef CLIENT_LIB_REGISTRY_REGISTER_FP_IMPLEMENTATION_FACTORY_H_
+#define CLIENT_LIB_REGISTRY_REGISTER_FP_IMPLEMENTATION_FACTORY_H_
+
+#include <pin.H>
+
+#include <string>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/registry/internal/fp_implementation_factory_registry.h"
+#include "client_lib/utils/fp_implementation_parameters.h"
+
+namespace NEAT {
+
+/**
+ * An FpImplementationFactory for FpImplementation classes that take no
+ * parameters.
+ *
+ * @tparam FpImpl The FpImplementation class to create.
+ */
+template <typename FpImpl>
+FpImplementation *CreateFpImplementation(
+    const FpImplementationParameters &parameters) {
+  return new FpImpl();
+}
+
+/**
+ * Registers an FpImplementationFactory in the global
+ * FpImplementationFactoryRegistry, so that FpSelectors configured at runtime
+ * can create FpImplementations by name.
+ */
+struct RegisterFpImplementationFactory {
+ public:
+  /**
+   * @param[in] factory The factory to register.
+   * @param[in] fp_implementation_name The name to register for the factory.
+   */
+  RegisterFpImplementationFactory(const FpImplementationFactory factory,
+                                  const string &fp_implementation_name) {
+    internal::FpImplementationFactoryRegistry::
+        GetFpImplementationFactoryRegistry()
+            ->RegisterFpImplementationFactory(factory, fp_implementation_name);
+  }
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_REGISTRY_REGISTER_FP_IMPLEMENTATION_FACTORY_H_
@@ -12,6 +12,7 @@
 #include "client_lib/interfaces/fp_selector.h"
 #include "client_lib/registry/register_initialized_fp_selector.h"
 #include "client_lib/utils/fp_operation.h"
+#include "client_lib/utils/thread_local.h"
 
 namespace NEAT {
 namespace internal {
@@ -21,7 +22,7 @@ namespace internal {
  * based on the functions in the instrumented application's call stack. The
  * FpImplementation instance associated with the function name most recent in
  * the call stack will be selected if one exists, otherwise a default
- * FpImplementation will be selected.
+ * FpImplementation will be selected. Every thread has its own call stack.
  */
 class FunctionStackFpSelector : public FpSelector {
  public:
@@ -42,32 +43,38 @@ class FunctionStackFpSelector : public FpSelector {
 
   FpImplementation *SelectFpImplementation(
       const FpOperation &operation) override {
-    if (fp_impl_stack_.empty()) {
+    const FpImplementationStack &fp_impl_stack =
+        fp_impl_stacks_.Get(operation.thread_id);
+    if (fp_impl_stack.empty()) {
       return default_fp_impl_;
     }
-    return fp_impl_stack_.top().second;
+    return fp_impl_stack.top().second;
   }
 
-  VOID OnFunctionStart(const string &function_name) override {
-    if (function_name_map_.count(function_name) > 0) {
-      fp_impl_stack_.push(
-          make_pair(function_name, function_name_map_[function_name]));
+  VOID OnFunctionStartInThread(const string &function_name,
+                               const THREADID thread_id) override {
+    const auto fp_impl = function_name_map_.find(function_name);
+    if (fp_impl != function_name_map_.end()) {
+      fp_impl_stacks_.Get(thread_id).push(*fp_impl);
     }
   }
 
-  VOID OnFunctionEnd(const string &function_name) override {
-    if (!fp_impl_stack_.empty() &&
-        fp_impl_stack_.top().first == function_name) {
-      fp_impl_stack_.pop();
+  VOID OnFunctionEndInThread(const string &function_name,
+                             const THREADID thread_id) override {
+    FpImplementationStack &fp_impl_stack = fp_impl_stacks_.Get(thread_id);
+    if (!fp_impl_stack.empty() && fp_impl_stack.top().first == function_name) {
+      fp_impl_stack.pop();
     }
   }
 
  private:
+  typedef stack<pair<const string, FpImplementation *>> FpImplementationStack;
+
   unordered_map<string, FpImplementation *> function_name_map_;
   FpImplementation *default_fp_impl_;
   /// Keeps track of the current FpImplementation to use based on the current
-  /// call stack of the instrumented application.
-  stack<pair<const string, FpImplementation *>> fp_impl_stack_;
+  /// call stack of each thread of the instrumented application.
+  ThreadLocal<FpImplementationStack> fp_impl_stacks_;
 };
 
 }  // namespace internal
@@ -0,0 +1,83 @@
+#ifndef CLIENT_LIB_REGISTRY_REGISTER_LOOKUP_TABLE_FP_SELECTOR_H_
+#define CLIENT_LIB_REGISTRY_REGISTER_LOOKUP_TABLE_FP_SELECTOR_H_
+
+#include <pin.H>
+
+#include <string>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/interfaces/fp_selector.h"
+#include "client_lib/registry/register_initialized_fp_selector.h"
+#include "client_lib/utils/fp_operation.h"
+#include "client_lib/utils/lookup_table_fp_implementation.h"
+
+namespace NEAT {
+namespace internal {
+
+/**
+ * Implementation of an FpSelector that always returns a
+ * LookupTableFpImplementation built from a single FpImplementation. The lookup
+ * tables are built when the instrumented application starts.
+ *
+ * @tparam FpImpl The FpImplementation class modeling an 8-bit format.
+ */
+template <typename FpImpl>
+class LookupTableFpSelector : public FpSelector {
+ public:
+  /**
+   * @param[in] exponent_bits Number of exponent bits of the format.
+   * @param[in] mantissa_bits Number of mantissa bits of the format.
+   * @param[in] has_infinity Whether the format can represent infinities.
+   */
+  LookupTableFpSelector(const UINT32 exponent_bits, const UINT32 mantissa_bits,
+                        const BOOL has_infinity)
+      : fp_impl_(&base_fp_impl_, exponent_bits, mantissa_bits, has_infinity) {}
+
+  VOID StartCallback() override { fp_impl_.Initialize(); }
+
+  FpImplementation *SelectFpImplementation(
+      const FpOperation &operation) override {
+    return &fp_impl_;
+  }
+
+  BOOL NeedsFunctionCallbacks() override { return FALSE; }
+
+ private:
+  FpImpl base_fp_impl_;
+  LookupTableFpImplementation fp_impl_;
+};
+
+}  // namespace internal
+
+/**
+ * Registers an FpSelector that always returns a lookup table implementation of
+ * an FpImplementation modeling an 8-bit format in the global
+ * FpSelectorRegistry.
+ *
+ * @tparam FpImpl The FpImplementation class modeling an 8-bit format.
+ */
+template <typename FpImpl>
+class RegisterLookupTableFpSelector {
+ public:
+  /**
+   * @param[in] exponent_bits Number of exponent bits of the format.
+   * @param[in] mantissa_bits Number of mantissa bits of the format.
+   * @param[in] has_infinity Whether the format can represent infinities.
+   * @param[in] fp_selector_name The name to register for the FpSelector
+   *     instance.
+   */
+  RegisterLookupTableFpSelector(const UINT32 exponent_bits,
+                                const UINT32 mantissa_bits,
+                                const BOOL has_infinity,
+                                const string &fp_selector_name)
+      : fp_selector_(exponent_bits, mantissa_bits, has_infinity),
+        register_fp_selector_(&fp_selector_, fp_selector_name) {}
+
+ private:
+  internal::LookupTableFpSelector<FpImpl> fp_selector_;
+  RegisterInitializedFpSelector register_fp_selector_;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_REGISTRY_REGISTER_LOOKUP_TABLE_FP_SELECTOR_H_
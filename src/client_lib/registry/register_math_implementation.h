@@ -0,0 +1,37 @@
+#ifndef CLIENT_LIB_REGISTRY_REGISTER_MATH_IMPLEMENTATION_H_
+#define CLIENT_LIB_REGISTRY_REGISTER_MATH_IMPLEMENTATION_H_
+
+#include <pin.H>
+
+#include <string>
+
+#include "client_lib/registry/internal/math_implementation_registry.h"
+
+namespace NEAT {
+
+/**
+ * Registers a MathImplementation instance in the global
+ * MathImplementationRegistry.
+ *
+ * @tparam MathImpl The MathImplementation class to register.
+ */
+template <typename MathImpl>
+struct RegisterMathImplementation {
+ public:
+  /**
+   * @param[in] math_implementation_name The name to register for the
+   *     MathImplementation instance.
+   */
+  explicit RegisterMathImplementation(const string &math_implementation_name) {
+    internal::MathImplementationRegistry::GetMathImplementationRegistry()
+        ->RegisterMathImplementation(&math_implementation,
+                                     math_implementation_name);
+  }
+
+ private:
+  MathImpl math_implementation;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_REGISTRY_REGISTER_MATH_IMPLEMENTATION_H_
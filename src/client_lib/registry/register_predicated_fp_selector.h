@@ -0,0 +1,87 @@
+#ifndef CLIENT_LIB_REGISTRY_REGISTER_PREDICATED_FP_SELECTOR_H_
+#define CLIENT_LIB_REGISTRY_REGISTER_PREDICATED_FP_SELECTOR_H_
+
+#include <pin.H>
+
+#include <string>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/interfaces/fp_selector.h"
+#include "client_lib/registry/register_initialized_fp_selector.h"
+#include "client_lib/utils/fp_instruction.h"
+#include "client_lib/utils/fp_operand_predicate.h"
+#include "client_lib/utils/fp_operation.h"
+
+namespace NEAT {
+namespace internal {
+
+/**
+ * Implementation of an FpSelector that replaces floating-point operations
+ * with the same FpImplementation only when their operands match a predicate.
+ * Other operations execute natively.
+ *
+ * @tparam FpImpl The FpImplementation class to return.
+ */
+template <typename FpImpl>
+class PredicatedFpSelector : public FpSelector {
+ public:
+  /**
+   * @param[in] fp_operand_predicate The predicate selecting the operations to
+   *     replace.
+   */
+  explicit PredicatedFpSelector(const FpOperandPredicate &fp_operand_predicate)
+      : fp_operand_predicate_(fp_operand_predicate) {}
+
+  FpImplementation *SelectFpImplementation(
+      const FpOperation &operation) override {
+    return &fp_impl_;
+  }
+
+  FpImplementation *SelectStaticFpImplementation(
+      const FpInstruction &instruction) override {
+    return &fp_impl_;
+  }
+
+  const FpOperandPredicate *SelectFpOperandPredicate(
+      const FpInstruction &instruction) override {
+    return &fp_operand_predicate_;
+  }
+
+  BOOL NeedsFunctionCallbacks() override { return FALSE; }
+
+ private:
+  FpImpl fp_impl_;
+  const FpOperandPredicate fp_operand_predicate_;
+};
+
+}  // namespace internal
+
+/**
+ * Registers an FpSelector that replaces floating-point operations with the
+ * same FpImplementation only when their operands match a predicate in the
+ * global FpSelectorRegistry.
+ *
+ * @tparam FpImpl The FpImplementation class to return.
+ */
+template <typename FpImpl>
+class RegisterPredicatedFpSelector {
+ public:
+  /**
+   * @param[in] fp_operand_predicate The predicate selecting the operations to
+   *     replace.
+   * @param[in] fp_selector_name The name to register for the FpSelector
+   *     instance.
+   */
+  RegisterPredicatedFpSelector(const FpOperandPredicate &fp_operand_predicate,
+                               const string &fp_selector_name)
+      : fp_selector_(fp_operand_predicate),
+        register_fp_selector_(&fp_selector_, fp_selector_name) {}
+
+ private:
+  internal::PredicatedFpSelector<FpImpl> fp_selector_;
+  RegisterInitializedFpSelector register_fp_selector_;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_REGISTRY_REGISTER_PREDICATED_FP_SELECTOR_H_
@@ -26,6 +26,8 @@ class SingleFpImplementationSelector : public FpSelector {
     return &fp_impl_;
   }
 
+  BOOL NeedsFunctionCallbacks() override { return FALSE; }
+
  private:
   FpImpl fp_impl_;
 };
@@ -0,0 +1,74 @@
+#ifndef CLIENT_LIB_REGISTRY_REGISTER_SINGLE_FP_RESULT_TRANSFORM_SELECTOR_H_
+#define CLIENT_LIB_REGISTRY_REGISTER_SINGLE_FP_RESULT_TRANSFORM_SELECTOR_H_
+
+#include <pin.H>
+
+#include <string>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/interfaces/fp_result_transform.h"
+#include "client_lib/interfaces/fp_selector.h"
+#include "client_lib/registry/register_fp_selector.h"
+#include "client_lib/utils/fp_instruction.h"
+#include "client_lib/utils/fp_operation.h"
+
+namespace NEAT {
+namespace internal {
+
+/**
+ * Implementation of an FpSelector that lets every floating-point instruction
+ * execute natively and always transforms its result with the same
+ * FpResultTransform.
+ *
+ * @tparam FpTransform The FpResultTransform class to use.
+ */
+template <typename FpTransform>
+class SingleFpResultTransformSelector : public FpSelector {
+ public:
+  /**
+   * Never called, since every instruction has its result transformed.
+   */
+  FpImplementation *SelectFpImplementation(
+      const FpOperation &operation) override {
+    return NULL;
+  }
+
+  FpResultTransform *SelectFpResultTransform(
+      const FpInstruction &instruction) override {
+    return &fp_transform_;
+  }
+
+  BOOL NeedsFunctionCallbacks() override { return FALSE; }
+
+ private:
+  FpTransform fp_transform_;
+};
+
+}  // namespace internal
+
+/**
+ * Registers an FpSelector that transforms the result of every floating-point
+ * instruction with a single FpResultTransform in the global
+ * FpSelectorRegistry.
+ *
+ * @tparam FpTransform The FpResultTransform class to use.
+ */
+template <typename FpTransform>
+class RegisterSingleFpResultTransformSelector {
+ public:
+  /**
+   * @param[in] fp_selector_name The name to register for the FpSelector
+   *     instance.
+   */
+  explicit RegisterSingleFpResultTransformSelector(
+      const string &fp_selector_name)
+      : fp_selector_(fp_selector_name) {}
+
+ private:
+  RegisterFpSelector<internal::SingleFpResultTransformSelector<FpTransform>>
+      fp_selector_;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_REGISTRY_REGISTER_SINGLE_FP_RESULT_TRANSFORM_SELECTOR_H_
@@ -0,0 +1,293 @@
+#include "client_lib/utils/cached_fp_implementation.h"
+
+#include <pin.H>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/utils/fp_operation.h"
+
+/**
+ * Reinterpret the bits of a FLT32 variable as a UINT32.
+ *
+ * @param[in] fp Variable to convert.
+ */
+#define FLT32_TO_BITS(fp) (*reinterpret_cast<const UINT32 *>(&(fp)))
+
+namespace NEAT {
+namespace {
+
+/// Identifies a NEAT floating-point result cache file.
+const char kCacheMagic[8] = {'N', 'E', 'A', 'T', 'F', 'R', 'C', '\0'};
+
+/// Version of the cache file format. Increment when the layout changes.
+const UINT32 kCacheFormatVersion = 1;
+
+/// States of a CachedFpImplementation::Slot.
+const UINT32 kEmptySlot = 0;
+const UINT32 kBusySlot = 1;
+const UINT32 kReadySlot = 2;
+
+/// Maximum number of slots examined before a lookup or insertion gives up.
+const UINT64 kMaxProbes = 32;
+
+/**
+ * Computes the 32-bit FNV-1a hash of a string.
+ */
+UINT32 HashName(const string &name) {
+  UINT32 hash = 2166136261u;
+  for (const char c : name) {
+    hash ^= static_cast<UINT8>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/**
+ * Converts an opcode to the value stored for it in the cache file. XED opcode
+ * values are not stable between Pin kits, so they are never written directly.
+ */
+UINT32 OpcodeToCacheOpcode(const UINT32 opcode) {
+  switch (opcode) {
+    case XED_ICLASS_ADDSS:
+      return 1;
+    case XED_ICLASS_SUBSS:
+      return 2;
+    case XED_ICLASS_MULSS:
+      return 3;
+    case XED_ICLASS_DIVSS:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * Computes the in-memory table hash of an operation.
+ */
+UINT64 HashOperation(const UINT32 opcode, const UINT32 operand1,
+                     const UINT32 operand2) {
+  UINT64 hash = (static_cast<UINT64>(operand1) << 32 | operand2) ^
+                (static_cast<UINT64>(opcode) * 0x9e3779b97f4a7c15ull);
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+/**
+ * Atomically creates a cache file containing only a header, unless a file
+ * already exists at that path. The header is written to a temporary file that
+ * is then hard-linked into place, so concurrent processes never observe a
+ * cache file without a header.
+ *
+ * @return Whether a cache file exists at the supplied path.
+ */
+BOOL CreateCacheFile(const string &cache_file_name) {
+  const string temp_file_name =
+      cache_file_name + ".tmp." + decstr(getpid());
+  const INT32 fd =
+      open(temp_file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return FALSE;
+  }
+  FpResultCacheHeader header;
+  memcpy(header.magic, kCacheMagic, sizeof(header.magic));
+  header.format_version = kCacheFormatVersion;
+  header.record_size = sizeof(FpResultCacheRecord);
+  const BOOL written = write(fd, &header, sizeof(header)) == sizeof(header);
+  close(fd);
+  const BOOL linked =
+      written && (link(temp_file_name.c_str(), cache_file_name.c_str()) == 0 ||
+                  errno == EEXIST);
+  unlink(temp_file_name.c_str());
+  return linked;
+}
+
+}  // namespace
+
+CachedFpImplementation::CachedFpImplementation(
+    FpImplementation *fp_implementation, const string &implementation_key,
+    const UINT32 implementation_version, const string &cache_file_name,
+    const UINT32 table_size_log2)
+    : fp_implementation_(fp_implementation),
+      implementation_id_(HashName(implementation_key)),
+      implementation_version_(implementation_version),
+      cache_file_name_(cache_file_name),
+      cache_fd_(-1),
+      slots_(new Slot[1ull << table_size_log2]),
+      slot_mask_((1ull << table_size_log2) - 1) {
+  for (UINT64 i = 0; i <= slot_mask_; i++) {
+    slots_[i].state.store(kEmptySlot, std::memory_order_relaxed);
+  }
+  OpenCacheFile();
+}
+
+CachedFpImplementation::~CachedFpImplementation() {
+  if (cache_fd_ >= 0) {
+    close(cache_fd_);
+  }
+  delete[] slots_;
+}
+
+FLT32 CachedFpImplementation::PerformOperation(const FpOperation &operation) {
+  const UINT32 operand1 = FLT32_TO_BITS(operation.operand1);
+  const UINT32 operand2 = FLT32_TO_BITS(operation.operand2);
+  const UINT32 opcode = OpcodeToCacheOpcode(operation.opcode);
+  UINT32 result_bits;
+  if (Lookup(opcode, operand1, operand2, &result_bits)) {
+    return *reinterpret_cast<FLT32 *>(&result_bits);
+  }
+
+  const FLT32 result = fp_implementation_->PerformOperation(operation);
+  result_bits = FLT32_TO_BITS(result);
+  // A result the table cannot hold would be appended again on every repeat
+  // of the operation, so it is only persisted once it is cached in memory.
+  if (Insert(opcode, operand1, operand2, result_bits)) {
+    Append(opcode, operand1, operand2, result_bits);
+  }
+  return result;
+}
+
+VOID CachedFpImplementation::OpenCacheFile() {
+  if (cache_file_name_.empty()) {
+    return;
+  }
+  if (!CreateCacheFile(cache_file_name_)) {
+    cerr << "Could not create FpImplementation result cache "
+         << cache_file_name_ << ", results will not be persisted" << endl;
+    return;
+  }
+
+  const INT32 fd = open(cache_file_name_.c_str(), O_RDONLY);
+  struct stat file_stat;
+  if (fd < 0 || fstat(fd, &file_stat) != 0 ||
+      static_cast<UINT64>(file_stat.st_size) < sizeof(FpResultCacheHeader)) {
+    cerr << "Could not read FpImplementation result cache " << cache_file_name_
+         << ", results will not be persisted" << endl;
+    if (fd >= 0) {
+      close(fd);
+    }
+    return;
+  }
+
+  const UINT64 file_size = file_stat.st_size;
+  VOID *mapping = mmap(NULL, file_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    cerr << "Could not map FpImplementation result cache " << cache_file_name_
+         << ", results will not be persisted" << endl;
+    return;
+  }
+
+  const FpResultCacheHeader *header =
+      static_cast<const FpResultCacheHeader *>(mapping);
+  if (memcmp(header->magic, kCacheMagic, sizeof(kCacheMagic)) != 0 ||
+      header->format_version != kCacheFormatVersion ||
+      header->record_size != sizeof(FpResultCacheRecord)) {
+    cerr << cache_file_name_
+         << " is not a valid FpImplementation result cache, results will not "
+            "be persisted"
+         << endl;
+    munmap(mapping, file_size);
+    return;
+  }
+
+  // A record that is still being appended by another process may be cut off
+  // at the end of the file, so only whole records are loaded.
+  const UINT64 num_records = (file_size - sizeof(FpResultCacheHeader)) /
+                             sizeof(FpResultCacheRecord);
+  const FpResultCacheRecord *records =
+      reinterpret_cast<const FpResultCacheRecord *>(header + 1);
+  for (UINT64 i = 0; i < num_records; i++) {
+    const FpResultCacheRecord &record = records[i];
+    if (record.implementation_id == implementation_id_ &&
+        record.implementation_version == implementation_version_) {
+      Insert(record.opcode, record.operand1, record.operand2, record.result);
+    }
+  }
+  munmap(mapping, file_size);
+
+  cache_fd_ = open(cache_file_name_.c_str(), O_WRONLY | O_APPEND);
+  if (cache_fd_ < 0) {
+    cerr << "Could not open FpImplementation result cache " << cache_file_name_
+         << " for writing, new results will not be persisted" << endl;
+  }
+}
+
+BOOL CachedFpImplementation::Lookup(const UINT32 opcode, const UINT32 operand1,
+                                    const UINT32 operand2,
+                                    UINT32 *result) const {
+  UINT64 index = HashOperation(opcode, operand1, operand2) & slot_mask_;
+  for (UINT64 probe = 0; probe < kMaxProbes; probe++) {
+    const Slot &slot = slots_[index];
+    const UINT32 state = slot.state.load(std::memory_order_acquire);
+    if (state == kEmptySlot) {
+      return FALSE;
+    }
+    if (state == kReadySlot && slot.opcode == opcode &&
+        slot.operand1 == operand1 && slot.operand2 == operand2) {
+      *result = slot.result;
+      return TRUE;
+    }
+    index = (index + 1) & slot_mask_;
+  }
+  return FALSE;
+}
+
+BOOL CachedFpImplementation::Insert(const UINT32 opcode, const UINT32 operand1,
+                                    const UINT32 operand2,
+                                    const UINT32 result) {
+  UINT64 index = HashOperation(opcode, operand1, operand2) & slot_mask_;
+  for (UINT64 probe = 0; probe < kMaxProbes; probe++) {
+    Slot &slot = slots_[index];
+    UINT32 state = slot.state.load(std::memory_order_acquire);
+    if (state == kEmptySlot &&
+        slot.state.compare_exchange_strong(state, kBusySlot,
+                                           std::memory_order_acquire)) {
+      slot.opcode = opcode;
+      slot.operand1 = operand1;
+      slot.operand2 = operand2;
+      slot.result = result;
+      slot.state.store(kReadySlot, std::memory_order_release);
+      return TRUE;
+    }
+    if (state == kReadySlot && slot.opcode == opcode &&
+        slot.operand1 == operand1 && slot.operand2 == operand2) {
+      return FALSE;
+    }
+    index = (index + 1) & slot_mask_;
+  }
+  return FALSE;
+}
+
+VOID CachedFpImplementation::Append(const UINT32 opcode, const UINT32 operand1,
+                                    const UINT32 operand2,
+                                    const UINT32 result) const {
+  if (cache_fd_ < 0) {
+    return;
+  }
+  FpResultCacheRecord record;
+  record.implementation_id = implementation_id_;
+  record.implementation_version = implementation_version_;
+  record.opcode = opcode;
+  record.operand1 = operand1;
+  record.operand2 = operand2;
+  record.result = result;
+  // A failed append only loses a cache entry, so the result is ignored.
+  if (write(cache_fd_, &record, sizeof(record)) != sizeof(record)) {
+    return;
+  }
+}
+
+}  // namespace NEAT
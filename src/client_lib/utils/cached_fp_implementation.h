@@ -0,0 +1,160 @@
+#ifndef CLIENT_LIB_UTILS_CACHED_FP_IMPLEMENTATION_H_
+#define CLIENT_LIB_UTILS_CACHED_FP_IMPLEMENTATION_H_
+
+#include <pin.H>
+
+#include <atomic>
+#include <string>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/utils/fp_operation.h"
+
+namespace NEAT {
+
+/**
+ * On-disk layout of a single cached floating-point result. The cache file is a
+ * FpResultCacheHeader followed by an append-only sequence of these records.
+ */
+struct FpResultCacheRecord {
+  /// Hash of the name and parameters of the FpImplementation that produced
+  /// the result.
+  UINT32 implementation_id;
+  /// Version of the FpImplementation that produced the result.
+  UINT32 implementation_version;
+  /// Stable encoding of the opcode: 1 for ADDSS, 2 for SUBSS, 3 for MULSS and
+  /// 4 for DIVSS.
+  UINT32 opcode;
+  /// Bit patterns of the operands and result of the operation.
+  UINT32 operand1;
+  UINT32 operand2;
+  UINT32 result;
+};
+
+/**
+ * On-disk header of a floating-point result cache file.
+ */
+struct FpResultCacheHeader {
+  char magic[8];
+  UINT32 format_version;
+  UINT32 record_size;
+};
+
+/**
+ * An FpImplementation that memoizes the results of a deterministic
+ * FpImplementation in a persistent file that can be shared between runs and
+ * between concurrently running NEAT processes.
+ *
+ * When constructed, every record in the cache file produced by the same
+ * implementation key and version is loaded from a read-only memory mapping of
+ * the file into a lock-free in-memory table. Each operation first consults the
+ * table, and only calls the wrapped FpImplementation on a miss. New results are
+ * inserted into the table and appended to the cache file with a single
+ * O_APPEND write, so no lock is taken on the hot path and records written by
+ * different processes are never interleaved.
+ *
+ * @note The wrapped FpImplementation must always return the same result for
+ *     the same opcode and operands. Bump implementation_version whenever its
+ *     behaviour changes so that stale results are ignored.
+ * @note Use tools/compact_fp_result_cache.py to remove duplicate and stale
+ *     records from a cache file.
+ */
+class CachedFpImplementation : public FpImplementation {
+ public:
+  /**
+   * @param[in] fp_implementation The deterministic FpImplementation to cache.
+   * @param[in] implementation_key The name and parameters identifying
+   *     fp_implementation in the cache file.
+   * @param[in] implementation_version The version of fp_implementation.
+   * @param[in] cache_file_name The path of the cache file, which is created if
+   *     it does not exist, or an empty string to only cache results in
+   *     memory.
+   * @param[in] table_size_log2 Log base 2 of the number of results that can be
+   *     held in memory.
+   */
+  CachedFpImplementation(FpImplementation *fp_implementation,
+                         const string &implementation_key,
+                         const UINT32 implementation_version,
+                         const string &cache_file_name,
+                         const UINT32 table_size_log2 = 20);
+
+  ~CachedFpImplementation();
+
+  FLT32 PerformOperation(const FpOperation &operation) override;
+
+ protected:
+  FLT32 FpAdd(const FpOperation &operation) override {
+    return PerformOperation(operation);
+  }
+
+  FLT32 FpSub(const FpOperation &operation) override {
+    return PerformOperation(operation);
+  }
+
+  FLT32 FpMul(const FpOperation &operation) override {
+    return PerformOperation(operation);
+  }
+
+  FLT32 FpDiv(const FpOperation &operation) override {
+    return PerformOperation(operation);
+  }
+
+ private:
+  /**
+   * A single entry of the in-memory result table.
+   */
+  struct Slot {
+    /// One of kEmptySlot, kBusySlot or kReadySlot. The remaining fields may
+    /// only be read once this is kReadySlot.
+    std::atomic<UINT32> state;
+    UINT32 opcode;
+    UINT32 operand1;
+    UINT32 operand2;
+    UINT32 result;
+  };
+
+  /**
+   * Loads every record produced by this implementation from the cache file
+   * into the in-memory table, creating the cache file if it does not exist.
+   * If no cache file is named, nothing is done. If the cache file cannot be
+   * used, a warning is printed and results are only cached in memory.
+   */
+  VOID OpenCacheFile();
+
+  /**
+   * Looks up a result in the in-memory table.
+   *
+   * @return Whether a result was found.
+   */
+  BOOL Lookup(const UINT32 opcode, const UINT32 operand1,
+              const UINT32 operand2, UINT32 *result) const;
+
+  /**
+   * Inserts a result into the in-memory table. The result is silently dropped
+   * if the table is too full to hold it.
+   *
+   * @return Whether the result was inserted, rather than dropped or already
+   *     held by the table.
+   */
+  BOOL Insert(const UINT32 opcode, const UINT32 operand1,
+              const UINT32 operand2, const UINT32 result);
+
+  /**
+   * Appends a result to the cache file.
+   */
+  VOID Append(const UINT32 opcode, const UINT32 operand1,
+              const UINT32 operand2, const UINT32 result) const;
+
+  FpImplementation *fp_implementation_;
+  const UINT32 implementation_id_;
+  const UINT32 implementation_version_;
+  const string cache_file_name_;
+  /// File descriptor the cache file is appended through, or -1 if results are
+  /// not persisted.
+  INT32 cache_fd_;
+  Slot *slots_;
+  const UINT64 slot_mask_;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_UTILS_CACHED_FP_IMPLEMENTATION_H_
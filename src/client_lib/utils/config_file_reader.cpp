@@ -0,0 +1,65 @@
+#include "client_lib/utils/config_file_reader.h"
+
+#include <pin.H>
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/registry/internal/fp_implementation_factory_registry.h"
+#include "client_lib/utils/fp_implementation_parameters.h"
+
+namespace NEAT {
+
+ConfigFileReader::ConfigFileReader(const string &config_file_name)
+    : config_file_name_(config_file_name),
+      config_file_(config_file_name.c_str()),
+      line_number_(0) {
+  if (!config_file_) {
+    cerr << "Could not open config file " << config_file_name << endl;
+    exit(1);
+  }
+}
+
+BOOL ConfigFileReader::NextLine(vector<string> *tokens) {
+  string line;
+  while (getline(config_file_, line)) {
+    line_number_++;
+    istringstream line_stream(line.substr(0, line.find('#')));
+    tokens->clear();
+    string token;
+    while (line_stream >> token) {
+      tokens->push_back(token);
+    }
+    if (!tokens->empty()) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+VOID ConfigFileReader::ErrorAndDie(const string &message) const {
+  cerr << config_file_name_ << ":" << line_number_ << ": " << message << endl;
+  exit(1);
+}
+
+FpImplementation *ConfigFileReader::CreateFpImplementationOrDie(
+    const vector<string> &tokens, const UINT32 name_token) const {
+  FpImplementationParameters parameters;
+  for (UINT32 i = name_token + 1; i < tokens.size(); i++) {
+    const size_t separator = tokens[i].find('=');
+    if (separator == string::npos || separator == 0) {
+      ErrorAndDie("expected <parameter>=<value>, not " + tokens[i]);
+    }
+    parameters.Set(tokens[i].substr(0, separator),
+                   tokens[i].substr(separator + 1));
+  }
+  return internal::FpImplementationFactoryRegistry::
+      GetFpImplementationFactoryRegistry()
+          ->CreateFpImplementationOrDie(tokens[name_token], parameters);
+}
+
+}  // namespace NEAT
@@ -0,0 +1,60 @@
+#ifndef CLIENT_LIB_UTILS_CONFIG_FILE_READER_H_
+#define CLIENT_LIB_UTILS_CONFIG_FILE_READER_H_
+
+#include <pin.H>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "client_lib/interfaces/fp_implementation.h"
+
+namespace NEAT {
+
+/**
+ * Reads a line-based config file of whitespace separated tokens, where text
+ * after a # is ignored, and reports errors with the offending line.
+ */
+class ConfigFileReader {
+ public:
+  /**
+   * Opens a config file, exiting the application if it cannot be opened.
+   *
+   * @param[in] config_file_name The name of the config file.
+   */
+  explicit ConfigFileReader(const string &config_file_name);
+
+  /**
+   * Reads the tokens of the next line that is not empty.
+   *
+   * @param[out] tokens The tokens of the line.
+   * @return Whether a line was read before the end of the file.
+   */
+  BOOL NextLine(vector<string> *tokens);
+
+  /**
+   * Reports an error on the last line read and exits the application.
+   */
+  VOID ErrorAndDie(const string &message) const;
+
+  /**
+   * Creates the FpImplementation named by a token of the last line read,
+   * configured by the <parameter>=<value> tokens that follow it, exiting the
+   * application on any error.
+   *
+   * @param[in] tokens The tokens of the last line read.
+   * @param[in] name_token The index of the token naming the implementation.
+   * @return The new FpImplementation instance.
+   */
+  FpImplementation *CreateFpImplementationOrDie(const vector<string> &tokens,
+                                                const UINT32 name_token) const;
+
+ private:
+  const string config_file_name_;
+  ifstream config_file_;
+  UINT32 line_number_;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_UTILS_CONFIG_FILE_READER_H_
@@ -0,0 +1,78 @@
+#include "client_lib/utils/fp_implementation_parameters.h"
+
+#include <pin.H>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace NEAT {
+
+string FpImplementationParameters::ToString() const {
+  vector<string> pairs;
+  for (const auto &value : values_) {
+    pairs.push_back(value.first + "=" + value.second);
+  }
+  sort(pairs.begin(), pairs.end());
+  string parameters;
+  for (const string &pair : pairs) {
+    parameters += (parameters.empty() ? "" : " ") + pair;
+  }
+  return parameters;
+}
+
+string FpImplementationParameters::GetString(
+    const string &name, const string &default_value) const {
+  used_names_.insert(name);
+  const auto value = values_.find(name);
+  return value == values_.end() ? default_value : value->second;
+}
+
+UINT32 FpImplementationParameters::GetUint32(
+    const string &name, const UINT32 default_value) const {
+  used_names_.insert(name);
+  const auto value = values_.find(name);
+  if (value == values_.end()) {
+    return default_value;
+  }
+  const char *begin = value->second.c_str();
+  char *end;
+  const unsigned long result = strtoul(begin, &end, 10);
+  if (value->second.empty() || *end != '\0' || begin[0] == '-' ||
+      result > 0xffffffffUL) {
+    cerr << "Parameter " << name << " must be an unsigned integer, not "
+         << value->second << endl;
+    exit(1);
+  }
+  return static_cast<UINT32>(result);
+}
+
+BOOL FpImplementationParameters::GetBool(const string &name,
+                                         const BOOL default_value) const {
+  used_names_.insert(name);
+  const auto value = values_.find(name);
+  if (value == values_.end()) {
+    return default_value;
+  }
+  if (value->second != "true" && value->second != "false") {
+    cerr << "Parameter " << name << " must be true or false, not "
+         << value->second << endl;
+    exit(1);
+  }
+  return value->second == "true";
+}
+
+vector<string> FpImplementationParameters::GetUnusedNames() const {
+  vector<string> unused_names;
+  for (const auto &value : values_) {
+    if (used_names_.count(value.first) == 0) {
+      unused_names.push_back(value.first);
+    }
+  }
+  sort(unused_names.begin(), unused_names.end());
+  return unused_names;
+}
+
+}  // namespace NEAT
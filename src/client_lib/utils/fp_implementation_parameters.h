@@ -0,0 +1,68 @@
+#ifndef CLIENT_LIB_UTILS_FP_IMPLEMENTATION_PARAMETERS_H_
+#define CLIENT_LIB_UTILS_FP_IMPLEMENTATION_PARAMETERS_H_
+
+#include <pin.H>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace NEAT {
+
+/**
+ * Named string parameters used to construct an FpImplementation at runtime,
+ * such as the mantissa width of an emulated format. The parameters read are
+ * recorded, so that misspelled ones can be reported.
+ */
+class FpImplementationParameters {
+ public:
+  /**
+   * Sets the value of a parameter, replacing any previous value.
+   */
+  VOID Set(const string &name, const string &value) { values_[name] = value; }
+
+  /**
+   * Removes a parameter if it was set.
+   */
+  VOID Erase(const string &name) { values_.erase(name); }
+
+  /**
+   * Returns every parameter as <name>=<value> pairs sorted by name and
+   * separated by spaces.
+   */
+  string ToString() const;
+
+  /**
+   * Returns the value of a parameter, or default_value if it was not set.
+   */
+  string GetString(const string &name, const string &default_value) const;
+
+  /**
+   * Returns the value of a parameter parsed as an unsigned integer, or
+   * default_value if it was not set. Exits the application if the value is
+   * not an unsigned integer.
+   */
+  UINT32 GetUint32(const string &name, const UINT32 default_value) const;
+
+  /**
+   * Returns the value of a parameter parsed as "true" or "false", or
+   * default_value if it was not set. Exits the application if the value is
+   * neither.
+   */
+  BOOL GetBool(const string &name, const BOOL default_value) const;
+
+  /**
+   * Returns the names of the parameters that were set but never read, sorted.
+   */
+  vector<string> GetUnusedNames() const;
+
+ private:
+  unordered_map<string, string> values_;
+  /// Names of the parameters read by a Get method.
+  mutable unordered_set<string> used_names_;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_UTILS_FP_IMPLEMENTATION_PARAMETERS_H_
@@ -0,0 +1,37 @@
+#ifndef CLIENT_LIB_UTILS_FP_INSTRUCTION_H_
+#define CLIENT_LIB_UTILS_FP_INSTRUCTION_H_
+
+#include <pin.H>
+
+#include <string>
+
+namespace NEAT {
+
+/**
+ * Contains the static information about a floating-point arithmetic
+ * instruction that is known when the instruction is instrumented.
+ */
+struct FpInstruction {
+  /**
+   * @param[in] opcode Opcode of the instruction.
+   * @param[in] function_name Name of the function containing the instruction.
+   * @param[in] image_name Name of the image containing the instruction.
+   * @param[in] image_offset Offset of the instruction from the address the
+   *     image was loaded at.
+   */
+  FpInstruction(const OPCODE opcode, const string &function_name,
+                const string &image_name, const ADDRINT image_offset)
+      : opcode(opcode),
+        function_name(function_name),
+        image_name(image_name),
+        image_offset(image_offset) {}
+
+  OPCODE opcode;
+  string function_name;
+  string image_name;
+  ADDRINT image_offset;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_UTILS_FP_INSTRUCTION_H_
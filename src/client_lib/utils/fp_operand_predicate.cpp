@@ -0,0 +1,70 @@
+#include "client_lib/utils/fp_operand_predicate.h"
+
+#include <pin.H>
+
+#include <cstring>
+
+namespace NEAT {
+namespace {
+
+/// Biased exponent of infinities and NaNs.
+const UINT32 kSpecialExponent = 0xff;
+/// Bias of FLT32 exponents.
+const INT32 kExponentBias = 127;
+
+}  // namespace
+
+FpOperandPredicate::FpOperandPredicate() { memset(table_, 0, sizeof(table_)); }
+
+FpOperandPredicate &FpOperandPredicate::MatchExponentRange(
+    const INT32 min_exponent, const INT32 max_exponent) {
+  for (UINT32 exponent = 1; exponent < kSpecialExponent; exponent++) {
+    const INT32 unbiased_exponent =
+        static_cast<INT32>(exponent) - kExponentBias;
+    if (unbiased_exponent >= min_exponent &&
+        unbiased_exponent <= max_exponent) {
+      MatchClass(exponent, 0);
+      MatchClass(exponent, 1);
+    }
+  }
+  return *this;
+}
+
+FpOperandPredicate &FpOperandPredicate::MatchExponentOutside(
+    const INT32 min_exponent, const INT32 max_exponent) {
+  MatchExponentRange(-kExponentBias, min_exponent - 1);
+  return MatchExponentRange(max_exponent + 1, kExponentBias + 1);
+}
+
+FpOperandPredicate &FpOperandPredicate::MatchZero() {
+  MatchClass(0, 0);
+  return *this;
+}
+
+FpOperandPredicate &FpOperandPredicate::MatchDenormal() {
+  MatchClass(0, 1);
+  return *this;
+}
+
+FpOperandPredicate &FpOperandPredicate::MatchInfinity() {
+  MatchClass(kSpecialExponent, 0);
+  return *this;
+}
+
+FpOperandPredicate &FpOperandPredicate::MatchNan() {
+  MatchClass(kSpecialExponent, 1);
+  return *this;
+}
+
+FpOperandPredicate &FpOperandPredicate::MatchNegative() {
+  memset(table_ + kNumClasses / 2, 1, kNumClasses / 2);
+  return *this;
+}
+
+VOID FpOperandPredicate::MatchClass(const UINT32 exponent,
+                                    const UINT32 nonzero_mantissa) {
+  table_[exponent << 1 | nonzero_mantissa] = 1;
+  table_[(1 << 8 | exponent) << 1 | nonzero_mantissa] = 1;
+}
+
+}  // namespace NEAT
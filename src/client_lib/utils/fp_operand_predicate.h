@@ -0,0 +1,87 @@
+#ifndef CLIENT_LIB_UTILS_FP_OPERAND_PREDICATE_H_
+#define CLIENT_LIB_UTILS_FP_OPERAND_PREDICATE_H_
+
+#include <pin.H>
+
+namespace NEAT {
+
+/**
+ * A condition on the operands of a floating-point instruction, built from a
+ * fixed menu of cheap checks on the class of each operand: its sign, its
+ * exponent and whether it is zero, denormal, infinite or NaN. An operation
+ * matches if either of its operands matches any of the checks.
+ *
+ * Every check is compiled into a table indexed by the sign, exponent and
+ * whether the mantissa is zero, so that Pin can inline the evaluation of the
+ * predicate before every instruction.
+ */
+class FpOperandPredicate {
+ public:
+  /// Number of classes of FLT32 values that checks distinguish.
+  static const UINT32 kNumClasses = 1 << 10;
+
+  /**
+   * Creates a predicate that matches no operand.
+   */
+  FpOperandPredicate();
+
+  /**
+   * Returns the class of a FLT32 value from its bit pattern: the sign and
+   * biased exponent followed by whether the mantissa is non-zero.
+   */
+  static UINT32 GetClass(const UINT32 bits) {
+    return (bits >> 23) << 1 | ((bits & 0x007fffff) != 0);
+  }
+
+  /**
+   * Matches normal operands whose unbiased exponent is between min_exponent
+   * and max_exponent, inclusive.
+   */
+  FpOperandPredicate &MatchExponentRange(const INT32 min_exponent,
+                                         const INT32 max_exponent);
+
+  /**
+   * Matches normal operands whose unbiased exponent is below min_exponent or
+   * above max_exponent.
+   */
+  FpOperandPredicate &MatchExponentOutside(const INT32 min_exponent,
+                                           const INT32 max_exponent);
+
+  /// Matches positive and negative zeros.
+  FpOperandPredicate &MatchZero();
+
+  /// Matches denormal operands.
+  FpOperandPredicate &MatchDenormal();
+
+  /// Matches infinite operands.
+  FpOperandPredicate &MatchInfinity();
+
+  /// Matches NaN operands.
+  FpOperandPredicate &MatchNan();
+
+  /// Matches operands with the sign bit set, including negative zero.
+  FpOperandPredicate &MatchNegative();
+
+  /**
+   * Returns whether a single operand matches.
+   */
+  BOOL Matches(const FLT32 operand) const {
+    return table_[GetClass(*reinterpret_cast<const UINT32 *>(&operand))];
+  }
+
+  /**
+   * Returns the table of the classes that match, used by analysis routines.
+   */
+  const UINT8 *GetTable() const { return table_; }
+
+ private:
+  /// Marks the classes of both signs with a biased exponent and non-zero
+  /// mantissa flag as matching.
+  VOID MatchClass(const UINT32 exponent, const UINT32 nonzero_mantissa);
+
+  UINT8 table_[kNumClasses];
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_UTILS_FP_OPERAND_PREDICATE_H_
@@ -17,18 +17,21 @@ struct FpOperation {
    * @param[in] operand1 First operand of the operation.
    * @param[in] operand2 Second operand of the operation.
    * @param[in] function_name Name of the function containing this operation.
+   * @param[in] thread_id Pin id of the thread performing this operation.
    */
   FpOperation(const OPCODE opcode, const FLT32 operand1, const FLT32 operand2,
-              const string function_name)
+              const string function_name, const THREADID thread_id)
       : opcode(opcode),
         operand1(operand1),
         operand2(operand2),
-        function_name(function_name) {}
+        function_name(function_name),
+        thread_id(thread_id) {}
 
   OPCODE opcode;
   FLT32 operand1;
   FLT32 operand2;
   string function_name;
+  THREADID thread_id;
 };
 
 }  // namespace NEAT
@@ -0,0 +1,179 @@
+#include "client_lib/utils/lookup_table_fp_implementation.h"
+
+#include <pin.H>
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/utils/fp_operation.h"
+#include "client_lib/utils/soft_float.h"
+
+namespace NEAT {
+namespace {
+
+/// Opcode of the operation stored in each result table.
+const OPCODE kTableOpcodes[] = {XED_ICLASS_ADDSS, XED_ICLASS_SUBSS,
+                                XED_ICLASS_MULSS, XED_ICLASS_DIVSS};
+
+/// How long to wait for an internal thread building a result table before
+/// the calling thread helps it, in milliseconds.
+const UINT32 kBuildTimeout = 60 * 1000;
+
+/// Thread id the thread calling Initialize builds result tables with.
+const THREADID kInitializingThreadId = PIN_MAX_THREADS - 1;
+
+/**
+ * Describes an 8-bit format, or exits the application if the widths do not
+ * add up to one. Invalid widths are rejected before MakeSoftFloatFormat
+ * shifts by them.
+ */
+SoftFloatFormat MakeEightBitFormatOrDie(const UINT32 exponent_bits,
+                                        const UINT32 mantissa_bits,
+                                        const BOOL has_infinity) {
+  if (exponent_bits < 2 || exponent_bits + mantissa_bits != 7) {
+    cerr << "Lookup tables can only be built for 8-bit formats, not a format "
+            "with "
+         << exponent_bits << " exponent bits and " << mantissa_bits
+         << " mantissa bits" << endl;
+    exit(1);
+  }
+  return MakeSoftFloatFormat(exponent_bits, mantissa_bits, has_infinity,
+                             kDenormalsPreserved);
+}
+
+}  // namespace
+
+LookupTableFpImplementation::LookupTableFpImplementation(
+    FpImplementation *fp_implementation, const UINT32 exponent_bits,
+    const UINT32 mantissa_bits, const BOOL has_infinity)
+    : fp_implementation_(fp_implementation),
+      exponent_bits_(exponent_bits),
+      mantissa_bits_(mantissa_bits),
+      format_(MakeEightBitFormatOrDie(exponent_bits, mantissa_bits,
+                                      has_infinity)) {
+  for (UINT32 code = 0; code < kNumValues; code++) {
+    const UINT32 sign = code >> 7;
+    const UINT32 max_exponent = (1 << exponent_bits) - 1;
+    const UINT32 max_mantissa = (1 << mantissa_bits) - 1;
+    const UINT32 exponent = (code >> mantissa_bits) & max_exponent;
+    const UINT32 mantissa = code & max_mantissa;
+    const INT32 bias = (1 << (exponent_bits - 1)) - 1;
+    FLT64 value;
+    if (has_infinity && exponent == max_exponent) {
+      value = internal::BitsToFlt64(mantissa == 0
+                                        ? internal::kFlt64ExponentMask
+                                        : internal::kFlt64QuietNanBits);
+    } else if (!has_infinity && exponent == max_exponent &&
+               mantissa == max_mantissa) {
+      value = internal::BitsToFlt64(internal::kFlt64QuietNanBits);
+    } else if (exponent == 0) {
+      value = ldexp(static_cast<FLT64>(mantissa),
+                    1 - bias - static_cast<INT32>(mantissa_bits));
+    } else {
+      value = ldexp(static_cast<FLT64>(mantissa | (1 << mantissa_bits)),
+                    static_cast<INT32>(exponent) - bias -
+                        static_cast<INT32>(mantissa_bits));
+    }
+    decode_table_[code] = static_cast<FLT32>(sign ? -value : value);
+  }
+
+  // Only the bits above the rounding position of a FLT32 decide how it is
+  // rounded to nearest even, as long as whether any lower bit is set is known.
+  for (UINT32 index = 0; index < (1 << 17); index++) {
+    const UINT32 bits = (index >> 1) << 16 | (index & 1);
+    const FLT32 value = *reinterpret_cast<const FLT32 *>(&bits);
+    encode_table_[index] =
+        EncodeExactly(RoundToFormat<kRoundNearestEven>(value, format_, 0));
+  }
+}
+
+VOID LookupTableFpImplementation::Initialize() {
+  PIN_THREAD_UID thread_uids[kNumTables];
+  BOOL spawned[kNumTables];
+  for (UINT32 table = 0; table < kNumTables; table++) {
+    BuildTask *task = &build_tasks_[table];
+    task->fp_implementation = this;
+    task->table = static_cast<ResultTable>(table);
+    task->thread_id = kInitializingThreadId - kNumTables + table;
+    task->next_row.store(0);
+    task->num_rows_built.store(0);
+    spawned[table] = PIN_SpawnInternalThread(BuildResultTableThread, task, 0,
+                                             &thread_uids[table]) !=
+                     INVALID_THREADID;
+    if (!spawned[table]) {
+      BuildResultRows(task, kInitializingThreadId);
+    }
+  }
+  for (UINT32 table = 0; table < kNumTables; table++) {
+    if (!spawned[table] ||
+        PIN_WaitForThreadTermination(thread_uids[table], kBuildTimeout,
+                                     NULL)) {
+      continue;
+    }
+    // Take over the rows the thread has not claimed yet, then wait for the
+    // ones it is still filling.
+    BuildTask *task = &build_tasks_[table];
+    BuildResultRows(task, kInitializingThreadId);
+    while (task->num_rows_built.load(std::memory_order_acquire) <
+           kNumValues) {
+      PIN_Yield();
+    }
+  }
+}
+
+UINT8 LookupTableFpImplementation::EncodeExactly(const FLT64 value) const {
+  const UINT64 bits = internal::Flt64ToBits(value);
+  const UINT32 sign = (bits & internal::kFlt64SignBit) ? 0x80 : 0;
+  const UINT64 magnitude = bits & ~internal::kFlt64SignBit;
+  const UINT32 max_exponent = (1 << exponent_bits_) - 1;
+  if (magnitude > internal::kFlt64ExponentMask) {
+    // Formats with infinities use the first NaN encoding, formats without use
+    // their only one.
+    return format_.has_infinity
+               ? sign | max_exponent << mantissa_bits_ |
+                     1 << (mantissa_bits_ - 1)
+               : sign | 0x7f;
+  }
+  if (magnitude == internal::kFlt64ExponentMask) {
+    return sign | max_exponent << mantissa_bits_;
+  }
+  if (magnitude < format_.min_normal_bits) {
+    const FLT64 min_denormal = ldexp(
+        1.0, format_.min_exponent - static_cast<INT32>(mantissa_bits_));
+    return sign | static_cast<UINT32>(fabs(value) / min_denormal);
+  }
+  const INT32 bias = (1 << (exponent_bits_ - 1)) - 1;
+  const UINT32 exponent =
+      static_cast<INT32>(magnitude >> internal::kFlt64MantissaBits) -
+      internal::kFlt64ExponentBias + bias;
+  const UINT32 mantissa = static_cast<UINT32>(
+      (magnitude & internal::kFlt64MantissaMask) >>
+      (internal::kFlt64MantissaBits - mantissa_bits_));
+  return sign | exponent << mantissa_bits_ | mantissa;
+}
+
+VOID LookupTableFpImplementation::BuildResultRows(BuildTask *task,
+                                                  const THREADID thread_id) {
+  const ResultTable table = task->table;
+  UINT32 operand1;
+  while ((operand1 = task->next_row.fetch_add(1)) < kNumValues) {
+    for (UINT32 operand2 = 0; operand2 < kNumValues; operand2++) {
+      const FpOperation operation(kTableOpcodes[table],
+                                  decode_table_[operand1],
+                                  decode_table_[operand2], "", thread_id);
+      result_tables_[table][operand1 << 8 | operand2] =
+          Encode(fp_implementation_->PerformOperation(operation));
+    }
+    task->num_rows_built.fetch_add(1, std::memory_order_release);
+  }
+}
+
+VOID LookupTableFpImplementation::BuildResultTableThread(VOID *arg) {
+  BuildTask *task = static_cast<BuildTask *>(arg);
+  task->fp_implementation->BuildResultRows(task, task->thread_id);
+}
+
+}  // namespace NEAT
@@ -0,0 +1,147 @@
+#ifndef CLIENT_LIB_UTILS_LOOKUP_TABLE_FP_IMPLEMENTATION_H_
+#define CLIENT_LIB_UTILS_LOOKUP_TABLE_FP_IMPLEMENTATION_H_
+
+#include <pin.H>
+
+#include <atomic>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/utils/fp_operation.h"
+#include "client_lib/utils/soft_float.h"
+
+namespace NEAT {
+
+/**
+ * An FpImplementation that replaces an FpImplementation modeling an 8-bit
+ * floating-point format with dense tables holding the result of every
+ * operation on every pair of values in the format.
+ *
+ * Each operation converts both operands to the format with a table indexed by
+ * the upper 16 bits of the operand, loads the result from the table of the
+ * operation, and converts it back to FLT32 with a 256 entry table.
+ *
+ * @note Operands are rounded to the format to nearest even, so the tables only
+ *     reproduce the wrapped FpImplementation exactly if it converts its
+ *     operands the same way.
+ * @note Initialize must be called before the first operation is performed.
+ * @note The tables are built with the thread ids PIN_MAX_THREADS -
+ *     kNumBuildThreadIds and above, so that building them does not draw from
+ *     the random number generators of application threads.
+ */
+class LookupTableFpImplementation : public FpImplementation {
+ public:
+  /**
+   * @param[in] fp_implementation The FpImplementation modeling the format. It
+   *     must be safe to call from multiple threads at once.
+   * @param[in] exponent_bits Number of exponent bits of the format. The
+   *     exponent and mantissa bits must add up to 7.
+   * @param[in] mantissa_bits Number of mantissa bits of the format.
+   * @param[in] has_infinity Whether the format can represent infinities.
+   */
+  LookupTableFpImplementation(FpImplementation *fp_implementation,
+                              const UINT32 exponent_bits,
+                              const UINT32 mantissa_bits,
+                              const BOOL has_infinity);
+
+  /**
+   * Builds the result tables in parallel on one internal Pin thread per
+   * operation. The calling thread finishes building the tables of threads
+   * that cannot be spawned or take too long.
+   */
+  VOID Initialize();
+
+  FLT32 FpAdd(const FpOperation &operation) override {
+    return LookupResult(kAddTable, operation);
+  }
+
+  FLT32 FpSub(const FpOperation &operation) override {
+    return LookupResult(kSubTable, operation);
+  }
+
+  FLT32 FpMul(const FpOperation &operation) override {
+    return LookupResult(kMulTable, operation);
+  }
+
+  FLT32 FpDiv(const FpOperation &operation) override {
+    return LookupResult(kDivTable, operation);
+  }
+
+ private:
+  /// Indices of the result table of each operation.
+  enum ResultTable { kAddTable, kSubTable, kMulTable, kDivTable, kNumTables };
+
+  /// Number of thread ids reserved for building the result tables: one per
+  /// table, and one for the thread calling Initialize.
+  static const UINT32 kNumBuildThreadIds = kNumTables + 1;
+
+  /// Number of values in an 8-bit format.
+  static const UINT32 kNumValues = 1 << 8;
+
+  /**
+   * Converts an operand to the format.
+   */
+  UINT32 Encode(const FLT32 value) const {
+    const UINT32 bits = *reinterpret_cast<const UINT32 *>(&value);
+    return encode_table_[(bits >> 16) << 1 | ((bits & 0xffff) != 0)];
+  }
+
+  FLT32 LookupResult(const ResultTable table, const FpOperation &operation) {
+    return decode_table_[result_tables_[table]
+                                       [Encode(operation.operand1) << 8 |
+                                        Encode(operation.operand2)]];
+  }
+
+  /**
+   * Describes the building of a single result table, whose rows are claimed
+   * one at a time by the internal Pin thread building it and, if that thread
+   * cannot be spawned or times out, by the thread calling Initialize.
+   */
+  struct BuildTask {
+    LookupTableFpImplementation *fp_implementation;
+    ResultTable table;
+    /// Thread id the internal Pin thread performs its operations with.
+    THREADID thread_id;
+    /// The first row that has not been claimed yet.
+    std::atomic<UINT32> next_row;
+    /// Number of rows that have been filled.
+    std::atomic<UINT32> num_rows_built;
+  };
+
+  /**
+   * Returns the encoding of a FLT64 value that is exactly representable in
+   * the format.
+   */
+  UINT8 EncodeExactly(const FLT64 value) const;
+
+  /**
+   * Fills the rows of a result table that have not been claimed yet by calling
+   * the wrapped FpImplementation on every pair of values.
+   *
+   * @param[in] task The table to build.
+   * @param[in] thread_id Thread id to perform the operations with.
+   */
+  VOID BuildResultRows(BuildTask *task, const THREADID thread_id);
+
+  /**
+   * Entry point of the internal Pin threads that build the result tables.
+   *
+   * @param[in] arg The BuildTask describing the table to build.
+   */
+  static VOID BuildResultTableThread(VOID *arg);
+
+  FpImplementation *fp_implementation_;
+  const UINT32 exponent_bits_;
+  const UINT32 mantissa_bits_;
+  const SoftFloatFormat format_;
+  /// Outlives Initialize, since a thread that timed out may still use it.
+  BuildTask build_tasks_[kNumTables];
+  /// Maps the upper 16 bits of a FLT32, followed by whether any of its lower
+  /// 16 bits are set, to its encoding in the format.
+  UINT8 encode_table_[1 << 17];
+  FLT32 decode_table_[kNumValues];
+  UINT8 result_tables_[kNumTables][kNumValues * kNumValues];
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_UTILS_LOOKUP_TABLE_FP_IMPLEMENTATION_H_
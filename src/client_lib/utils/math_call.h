@@ -0,0 +1,37 @@
+#ifndef CLIENT_LIB_UTILS_MATH_CALL_H_
+#define CLIENT_LIB_UTILS_MATH_CALL_H_
+
+#include <pin.H>
+
+#include "client_lib/utils/math_function.h"
+
+namespace NEAT {
+
+/**
+ * Contains all the contextual information for a single call to a function of
+ * the math library.
+ */
+struct MathCall {
+  /**
+   * @param[in] function The function called.
+   * @param[in] argument1 First argument of the call.
+   * @param[in] argument2 Second argument of the call, or 0 for functions of
+   *     one argument.
+   * @param[in] thread_id Pin id of the thread performing this call.
+   */
+  MathCall(const MathFunction function, const FLT32 argument1,
+           const FLT32 argument2, const THREADID thread_id)
+      : function(function),
+        argument1(argument1),
+        argument2(argument2),
+        thread_id(thread_id) {}
+
+  MathFunction function;
+  FLT32 argument1;
+  FLT32 argument2;
+  THREADID thread_id;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_UTILS_MATH_CALL_H_
@@ -0,0 +1,65 @@
+#include "client_lib/utils/math_function.h"
+
+#include <pin.H>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace NEAT {
+namespace {
+
+/// Describes a function of the math library.
+struct MathFunctionInfo {
+  const char *name;
+  UINT32 num_arguments;
+};
+
+/// Information about every MathFunction, in the order of the enum.
+const MathFunctionInfo kMathFunctionInfo[kNumMathFunctions] = {
+    {"sinf", 1},  {"cosf", 1},   {"tanf", 1},  {"expf", 1},
+    {"exp2f", 1}, {"logf", 1},   {"log2f", 1}, {"log10f", 1},
+    {"sqrtf", 1}, {"powf", 2},   {"atan2f", 2}};
+
+}  // namespace
+
+const char *GetMathFunctionName(const MathFunction function) {
+  return kMathFunctionInfo[function].name;
+}
+
+UINT32 GetMathFunctionNumArguments(const MathFunction function) {
+  return kMathFunctionInfo[function].num_arguments;
+}
+
+FLT64 EvaluateMathFunction(const MathFunction function, const FLT64 argument1,
+                           const FLT64 argument2) {
+  switch (function) {
+    case kSinf:
+      return sin(argument1);
+    case kCosf:
+      return cos(argument1);
+    case kTanf:
+      return tan(argument1);
+    case kExpf:
+      return exp(argument1);
+    case kExp2f:
+      return exp2(argument1);
+    case kLogf:
+      return log(argument1);
+    case kLog2f:
+      return log2(argument1);
+    case kLog10f:
+      return log10(argument1);
+    case kSqrtf:
+      return sqrt(argument1);
+    case kPowf:
+      return pow(argument1, argument2);
+    case kAtan2f:
+      return atan2(argument1, argument2);
+    default:
+      cerr << "Unexpected math function " << function << endl;
+      exit(1);
+  }
+}
+
+}  // namespace NEAT
@@ -0,0 +1,51 @@
+#ifndef CLIENT_LIB_UTILS_MATH_FUNCTION_H_
+#define CLIENT_LIB_UTILS_MATH_FUNCTION_H_
+
+#include <pin.H>
+
+namespace NEAT {
+
+/**
+ * The single-precision math library functions that NEAT can replace as a
+ * whole.
+ */
+enum MathFunction {
+  kSinf,
+  kCosf,
+  kTanf,
+  kExpf,
+  kExp2f,
+  kLogf,
+  kLog2f,
+  kLog10f,
+  kSqrtf,
+  kPowf,
+  kAtan2f,
+  kNumMathFunctions
+};
+
+/**
+ * Returns the name of the math library symbol of a function, such as "expf".
+ */
+const char *GetMathFunctionName(const MathFunction function);
+
+/**
+ * Returns the number of FLT32 arguments of a function, which is 1 or 2.
+ */
+UINT32 GetMathFunctionNumArguments(const MathFunction function);
+
+/**
+ * Evaluates a function in FLT64 with the math library of the tool.
+ *
+ * @param[in] function The function to evaluate.
+ * @param[in] argument1 First argument of the function.
+ * @param[in] argument2 Second argument of the function, ignored by functions
+ *     of one argument.
+ * @return The result of the function.
+ */
+FLT64 EvaluateMathFunction(const MathFunction function, const FLT64 argument1,
+                           const FLT64 argument2);
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_UTILS_MATH_FUNCTION_H_
@@ -0,0 +1,191 @@
+/**
+ * Contains conversions between posits and FLT64 values.
+ *
+ * A posit of Bits bits with ExponentBits exponent bits is stored in the low
+ * bits of a UINT32. Negative posits are the two's complement of their
+ * magnitude, and the pattern with only the sign bit set is NaR (not a real).
+ * Rounding follows the posit standard: values are rounded to nearest even on
+ * the posit bit string, never round to zero or NaR, and saturate at the
+ * largest and smallest positive posits.
+ */
+
+#ifndef CLIENT_LIB_UTILS_POSIT_H_
+#define CLIENT_LIB_UTILS_POSIT_H_
+
+#include <pin.H>
+
+#include <cmath>
+
+#include "client_lib/utils/soft_float.h"
+
+namespace NEAT {
+namespace internal {
+
+inline UINT32 CountLeadingZeros(const UINT64 value) {
+  return __builtin_clzll(value);
+}
+
+/**
+ * Returns the product of two FLT64 values rounded to odd. Unlike
+ * MultiplyExactly, the operands may have more than 26 significand bits.
+ */
+inline FLT64 MultiplyRoundedToOdd(const FLT64 a, const FLT64 b) {
+  const FLT64 product = a * b;
+  return RoundedToOdd(product, std::fma(a, b, -product));
+}
+
+/**
+ * Returns the quotient of two FLT64 values rounded to odd. Unlike
+ * DivideRoundedToOdd, the divisor may have more than 26 significand bits.
+ */
+inline FLT64 DivideWideRoundedToOdd(const FLT64 a, const FLT64 b) {
+  const FLT64 quotient = a / b;
+  const UINT64 quotient_magnitude = Flt64ToBits(quotient) & ~kFlt64SignBit;
+  if (quotient_magnitude == 0 || quotient_magnitude >= kFlt64ExponentMask) {
+    return quotient;
+  }
+  const FLT64 remainder = std::fma(-quotient, b, a);
+  return RoundedToOdd(quotient, b > 0.0 ? remainder : -remainder);
+}
+
+}  // namespace internal
+
+/**
+ * Converts between posits of a fixed configuration and FLT64 values.
+ *
+ * @tparam Bits Number of bits of the posit, between 3 and 32.
+ * @tparam ExponentBits Number of exponent bits of the posit, at most 4.
+ */
+template <UINT32 Bits, UINT32 ExponentBits>
+class Posit {
+ public:
+  static_assert(Bits >= 3 && Bits <= 32, "Posits must have 3 to 32 bits");
+  static_assert(ExponentBits <= 4, "Posits may have at most 4 exponent bits");
+
+  /// Mask of the bits used by the posit.
+  static const UINT32 kMask = static_cast<UINT32>((1ull << Bits) - 1);
+  /// The NaR pattern.
+  static const UINT32 kNaR = 1u << (Bits - 1);
+  /// The largest positive posit.
+  static const UINT32 kMaxPos = kNaR - 1;
+  /// Binary exponent of the largest positive posit.
+  static const INT32 kMaxScale = (Bits - 2) << ExponentBits;
+
+  /**
+   * Rounds a FLT64 value to the nearest posit. Infinities and NaNs become NaR.
+   */
+  static UINT32 FromFlt64(const FLT64 value) {
+    const UINT64 bits = internal::Flt64ToBits(value);
+    const UINT64 magnitude = bits & ~internal::kFlt64SignBit;
+    if (magnitude == 0) {
+      return 0;
+    }
+    if (magnitude >= internal::kFlt64ExponentMask) {
+      return kNaR;
+    }
+    const INT32 scale =
+        static_cast<INT32>(magnitude >> internal::kFlt64MantissaBits) -
+        internal::kFlt64ExponentBias;
+    UINT32 body;
+    if (scale >= kMaxScale) {
+      body = kMaxPos;
+    } else if (scale < -kMaxScale) {
+      // This also covers denormal FLT64 values.
+      body = 1;
+    } else {
+      const UINT32 exponent =
+          static_cast<UINT32>(scale) & ((1u << ExponentBits) - 1);
+      const INT32 regime =
+          (scale - static_cast<INT32>(exponent)) / (1 << ExponentBits);
+      // Lay out the regime, exponent and fraction left-aligned in 64 bits.
+      // The regime is at most Bits - 1 bits long, so at least 27 fraction
+      // bits fit and the rest only matter as sticky bits.
+      const UINT32 regime_length = regime >= 0 ? regime + 2 : 1 - regime;
+      const UINT64 regime_bits =
+          regime >= 0 ? ((1ull << (regime + 1)) - 1) << 1 : 1;
+      const UINT32 fraction_position = 64 - regime_length - ExponentBits;
+      const UINT64 fraction = magnitude & internal::kFlt64MantissaMask;
+      UINT64 string = regime_bits << (64 - regime_length) |
+                      static_cast<UINT64>(exponent) << fraction_position;
+      UINT64 sticky = 0;
+      if (fraction_position >= internal::kFlt64MantissaBits) {
+        string |= fraction
+                  << (fraction_position - internal::kFlt64MantissaBits);
+      } else {
+        const UINT32 shift = internal::kFlt64MantissaBits - fraction_position;
+        string |= fraction >> shift;
+        sticky = fraction & ((1ull << shift) - 1);
+      }
+      body = static_cast<UINT32>(string >> (65 - Bits));
+      const UINT64 rest = string << (Bits - 1);
+      sticky |= rest << 1;
+      body += static_cast<UINT32>(rest >> 63) & ((sticky != 0) | (body & 1));
+    }
+    return (bits & internal::kFlt64SignBit) ? (0u - body) & kMask : body;
+  }
+
+  /**
+   * Converts a posit to FLT64, which represents every posit exactly, by
+   * counting the leading bits of its regime. NaR becomes a quiet NaN.
+   */
+  static FLT64 ToFlt64(const UINT32 posit) {
+    if ((posit & kMask) == 0) {
+      return 0.0;
+    }
+    if ((posit & kMask) == kNaR) {
+      return internal::BitsToFlt64(internal::kFlt64QuietNanBits);
+    }
+    const BOOL negative = (posit & kNaR) != 0;
+    const UINT32 magnitude = (negative ? 0u - posit : posit) & kMask;
+    UINT64 string = static_cast<UINT64>(magnitude) << (65 - Bits);
+    const UINT64 first_bit = string >> 63;
+    const UINT32 run =
+        internal::CountLeadingZeros(first_bit ? ~string : string);
+    const INT32 regime =
+        first_bit ? static_cast<INT32>(run) - 1 : -static_cast<INT32>(run);
+    // The run is at most Bits - 1 bits long, so the shift is always defined.
+    string <<= run + 1;
+    const UINT32 exponent =
+        static_cast<UINT32>((string >> 1) >> (63 - ExponentBits));
+    string <<= ExponentBits;
+    const INT32 scale =
+        regime * (1 << ExponentBits) + static_cast<INT32>(exponent);
+    const FLT64 value = internal::BitsToFlt64(
+        internal::PowerOfTwoBits(scale) |
+        string >> (64 - internal::kFlt64MantissaBits));
+    return negative ? -value : value;
+  }
+};
+
+/**
+ * Decodes posits to FLT64 values. Posits of at most 16 bits are decoded with
+ * a table of every value, larger posits with Posit::ToFlt64.
+ */
+template <UINT32 Bits, UINT32 ExponentBits, BOOL UseTable = (Bits <= 16)>
+class PositDecoder {
+ public:
+  FLT64 Decode(const UINT32 posit) const {
+    return Posit<Bits, ExponentBits>::ToFlt64(posit);
+  }
+};
+
+template <UINT32 Bits, UINT32 ExponentBits>
+class PositDecoder<Bits, ExponentBits, TRUE> {
+ public:
+  PositDecoder() {
+    for (UINT32 posit = 0; posit < kNumValues; posit++) {
+      table_[posit] = Posit<Bits, ExponentBits>::ToFlt64(posit);
+    }
+  }
+
+  FLT64 Decode(const UINT32 posit) const { return table_[posit]; }
+
+ private:
+  static const UINT32 kNumValues = 1u << Bits;
+
+  FLT64 table_[kNumValues];
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_UTILS_POSIT_H_
@@ -0,0 +1,47 @@
+#include "client_lib/utils/random.h"
+
+#include <pin.H>
+
+namespace NEAT {
+namespace {
+
+/**
+ * The generator state of a single thread, padded to a cache line so that
+ * threads never share one.
+ */
+struct alignas(64) ThreadRandomState {
+  /// Number of blocks drawn so far.
+  UINT64 num_blocks;
+  /// The current block of random bits.
+  UINT64 block[2];
+  /// Number of words of the current block that have not been returned yet.
+  UINT32 words_left;
+};
+
+UINT32 random_key[2] = {0, 0};
+
+ThreadRandomState thread_random_states[PIN_MAX_THREADS];
+
+}  // namespace
+
+VOID SetRandomSeed(const UINT64 seed) {
+  random_key[0] = static_cast<UINT32>(seed);
+  random_key[1] = static_cast<UINT32>(seed >> 32);
+}
+
+UINT64 NextRandomBits(const THREADID thread_id) {
+  ThreadRandomState &state = thread_random_states[thread_id];
+  if (state.words_left == 0) {
+    UINT32 counter[4] = {static_cast<UINT32>(state.num_blocks),
+                         static_cast<UINT32>(state.num_blocks >> 32),
+                         static_cast<UINT32>(thread_id), 0};
+    internal::Philox4x32(counter, random_key);
+    state.block[0] = static_cast<UINT64>(counter[1]) << 32 | counter[0];
+    state.block[1] = static_cast<UINT64>(counter[3]) << 32 | counter[2];
+    state.num_blocks++;
+    state.words_left = 2;
+  }
+  return state.block[--state.words_left];
+}
+
+}  // namespace NEAT
@@ -0,0 +1,62 @@
+/**
+ * Contains a counter-based pseudorandom number generator with independent
+ * state for every application thread.
+ *
+ * Random bits are produced by the Philox4x32-10 block function keyed by a
+ * global seed and applied to a counter made of the thread id and the number of
+ * blocks the thread has drawn. A thread only touches its own cache line, so
+ * drawing bits never synchronizes threads, and every thread draws the same
+ * sequence in every run with the same seed.
+ */
+
+#ifndef CLIENT_LIB_UTILS_RANDOM_H_
+#define CLIENT_LIB_UTILS_RANDOM_H_
+
+#include <pin.H>
+
+namespace NEAT {
+namespace internal {
+
+/**
+ * Applies the Philox4x32-10 block function to a counter.
+ *
+ * @param[in,out] counter The 128-bit counter, replaced by the random block.
+ * @param[in] key The 64-bit key.
+ */
+inline VOID Philox4x32(UINT32 counter[4], const UINT32 key[2]) {
+  UINT32 key0 = key[0];
+  UINT32 key1 = key[1];
+  for (UINT32 round = 0; round < 10; round++) {
+    const UINT64 product0 = static_cast<UINT64>(0xd2511f53u) * counter[0];
+    const UINT64 product1 = static_cast<UINT64>(0xcd9e8d57u) * counter[2];
+    const UINT32 next0 =
+        static_cast<UINT32>(product1 >> 32) ^ counter[1] ^ key0;
+    const UINT32 next2 =
+        static_cast<UINT32>(product0 >> 32) ^ counter[3] ^ key1;
+    counter[1] = static_cast<UINT32>(product1);
+    counter[3] = static_cast<UINT32>(product0);
+    counter[0] = next0;
+    counter[2] = next2;
+    key0 += 0x9e3779b9u;
+    key1 += 0xbb67ae85u;
+  }
+}
+
+}  // namespace internal
+
+/**
+ * Sets the seed of every thread's generator. It must be called before the
+ * instrumented application starts.
+ */
+VOID SetRandomSeed(const UINT64 seed);
+
+/**
+ * Returns 64 random bits from the generator of a thread.
+ *
+ * @param[in] thread_id The Pin id of the calling thread.
+ */
+UINT64 NextRandomBits(const THREADID thread_id);
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_UTILS_RANDOM_H_
@@ -0,0 +1,25 @@
+#include "client_lib/utils/soft_float.h"
+
+#include <pin.H>
+
+namespace NEAT {
+
+FLT64 RoundToFormat(const FLT64 value, const SoftFloatFormat &format,
+                    const FpRoundingMode rounding_mode,
+                    const UINT64 random_bits) {
+  switch (rounding_mode) {
+    case kRoundNearestEven:
+      return RoundToFormat<kRoundNearestEven>(value, format, random_bits);
+    case kRoundTowardZero:
+      return RoundToFormat<kRoundTowardZero>(value, format, random_bits);
+    case kRoundUp:
+      return RoundToFormat<kRoundUp>(value, format, random_bits);
+    case kRoundDown:
+      return RoundToFormat<kRoundDown>(value, format, random_bits);
+    case kRoundStochastic:
+      return RoundToFormat<kRoundStochastic>(value, format, random_bits);
+  }
+  return value;
+}
+
+}  // namespace NEAT
@@ -0,0 +1,358 @@
+/**
+ * Contains a software floating-point engine that rounds values to binary
+ * floating-point formats with arbitrary exponent and mantissa widths.
+ *
+ * Arithmetic is carried out on FLT64 values. Sums and quotients are first
+ * rounded to odd, which keeps enough information about the exact result that a
+ * second rounding to any format with at most 24 significand bits is correctly
+ * rounded. Products of two FLT32 values are always exact in FLT64.
+ */
+
+#ifndef CLIENT_LIB_UTILS_SOFT_FLOAT_H_
+#define CLIENT_LIB_UTILS_SOFT_FLOAT_H_
+
+#include <pin.H>
+
+namespace NEAT {
+
+/**
+ * Rounding modes supported by the software floating-point engine.
+ */
+enum FpRoundingMode {
+  kRoundNearestEven,
+  kRoundTowardZero,
+  kRoundUp,
+  kRoundDown,
+  /// Rounds up with a probability proportional to the distance from the
+  /// value to the next representable value toward zero.
+  kRoundStochastic
+};
+
+/**
+ * How the software floating-point engine treats values too small to be
+ * represented as normal numbers.
+ */
+enum FpDenormalMode {
+  /// Values are rounded to denormal numbers as specified by IEEE 754.
+  kDenormalsPreserved,
+  /// Values smaller in magnitude than the smallest normal number are flushed
+  /// to a zero of the same sign.
+  kDenormalsFlushed
+};
+
+/**
+ * Precomputed constants describing a binary floating-point format. A format
+ * may have at most 8 exponent bits and 23 mantissa bits so that every value in
+ * it can be represented exactly as a FLT32.
+ */
+struct SoftFloatFormat {
+  /// Number of explicitly stored mantissa bits.
+  UINT32 mantissa_bits;
+  /// Bit pattern of the smallest normal number of the format, as a FLT64.
+  UINT64 min_normal_bits;
+  /// Bit pattern of the smallest FLT64 too large to be rounded as a normal
+  /// number of the format.
+  UINT64 normal_limit_bits;
+  /// Bit pattern of the largest finite number of the format, as a FLT64.
+  UINT64 max_finite_bits;
+  /// Unbiased exponent of the smallest normal number of the format.
+  INT32 min_exponent;
+  /// Whether the format can represent infinities. Formats without infinities
+  /// use the largest exponent for normal numbers, reserving only an all ones
+  /// mantissa for NaN, and overflow to NaN.
+  BOOL has_infinity;
+  BOOL flush_denormals;
+};
+
+namespace internal {
+
+const UINT64 kFlt64SignBit = 0x8000000000000000ull;
+const UINT64 kFlt64ExponentMask = 0x7ff0000000000000ull;
+const UINT64 kFlt64MantissaMask = 0x000fffffffffffffull;
+const UINT64 kFlt64QuietNanBits = 0x7ff8000000000000ull;
+const UINT32 kFlt64MantissaBits = 52;
+const INT32 kFlt64ExponentBias = 1023;
+
+inline UINT64 Flt64ToBits(const FLT64 value) {
+  return *reinterpret_cast<const UINT64 *>(&value);
+}
+
+inline FLT64 BitsToFlt64(const UINT64 bits) {
+  return *reinterpret_cast<const FLT64 *>(&bits);
+}
+
+/**
+ * Returns the bit pattern of 2^exponent as a normal FLT64.
+ */
+constexpr UINT64 PowerOfTwoBits(const INT32 exponent) {
+  return static_cast<UINT64>(exponent + kFlt64ExponentBias)
+         << kFlt64MantissaBits;
+}
+
+/**
+ * Returns the largest unbiased exponent used by normal numbers of a format.
+ */
+constexpr INT32 MaxExponent(const UINT32 exponent_bits,
+                            const BOOL has_infinity) {
+  return (1 << (exponent_bits - 1)) - (has_infinity ? 1 : 0);
+}
+
+/**
+ * Returns the largest mantissa of a normal number with the largest exponent of
+ * a format, aligned to the FLT64 mantissa.
+ */
+constexpr UINT64 MaxMantissaBits(const UINT32 mantissa_bits,
+                                 const BOOL has_infinity) {
+  return ((1ull << mantissa_bits) - (has_infinity ? 1 : 2))
+         << (kFlt64MantissaBits - mantissa_bits);
+}
+
+/**
+ * Adjusts a FLT64 that was rounded to nearest so that it is instead rounded to
+ * odd, given the sign of the rounding error.
+ *
+ * @param[in] rounded The value rounded to nearest.
+ * @param[in] error The exact value minus rounded. Only its sign is used.
+ * @return The exact value rounded to odd: rounded if it was exact or has an
+ *     odd mantissa, otherwise its neighbour in the direction of the exact
+ *     value.
+ */
+inline FLT64 RoundedToOdd(const FLT64 rounded, const FLT64 error) {
+  const UINT64 bits = Flt64ToBits(rounded);
+  // The error is NaN when the rounded value is infinite, which must be
+  // treated as exact.
+  const UINT64 inexact_and_even = ((error < 0.0) | (error > 0.0)) & ~bits & 1;
+  // Adding one to the bit pattern moves away from zero, subtracting moves
+  // toward zero.
+  const UINT64 away = (error > 0.0) == (rounded > 0.0);
+  return BitsToFlt64(bits + (inexact_and_even & away) -
+                     (inexact_and_even & !away));
+}
+
+/**
+ * Rounds a significand, shifted right by some number of bits, to an integer.
+ *
+ * @param[in] significand The integer significand.
+ * @param[in] shift The number of low bits of significand to round away.
+ * @param[in] negative Whether the value being rounded is negative.
+ * @param[in] random_bits Random bits used for stochastic rounding.
+ * @return The rounded value of significand / 2^shift.
+ */
+template <FpRoundingMode RoundingMode>
+inline UINT64 RoundShiftedSignificand(UINT64 significand, UINT32 shift,
+                                      const BOOL negative,
+                                      const UINT64 random_bits) {
+  if (shift > 63) {
+    // Only whether any bits are set matters when every bit is rounded away.
+    significand = significand != 0;
+    shift = 63;
+  }
+  const UINT64 mask = (1ull << shift) - 1;
+  const UINT64 kept = significand >> shift;
+  const UINT64 remainder = significand & mask;
+  const UINT64 half = 1ull << (shift - 1);
+  switch (RoundingMode) {
+    case kRoundNearestEven:
+      return kept + (remainder > half || (remainder == half && (kept & 1)));
+    case kRoundTowardZero:
+      return kept;
+    case kRoundUp:
+      return kept + (!negative && remainder != 0);
+    case kRoundDown:
+      return kept + (negative && remainder != 0);
+    case kRoundStochastic:
+      return kept + ((random_bits & mask) < remainder);
+  }
+  return kept;
+}
+
+/**
+ * Returns the value a finite number too large for a format rounds to.
+ */
+template <FpRoundingMode RoundingMode>
+inline FLT64 Overflow(const UINT64 sign, const SoftFloatFormat &format) {
+  const BOOL to_infinity =
+      RoundingMode == kRoundNearestEven || RoundingMode == kRoundStochastic ||
+      (RoundingMode == kRoundUp && !sign) ||
+      (RoundingMode == kRoundDown && sign);
+  if (!to_infinity) {
+    return BitsToFlt64(sign | format.max_finite_bits);
+  }
+  if (!format.has_infinity) {
+    return BitsToFlt64(sign | kFlt64QuietNanBits);
+  }
+  return BitsToFlt64(sign | kFlt64ExponentMask);
+}
+
+/**
+ * Rounds values that are not within the normal range of a format: zeroes,
+ * denormals, overflows, infinities and NaNs.
+ */
+template <FpRoundingMode RoundingMode>
+FLT64 RoundToFormatSlow(const FLT64 value, const SoftFloatFormat &format,
+                        const UINT64 random_bits) {
+  const UINT64 bits = Flt64ToBits(value);
+  const UINT64 sign = bits & kFlt64SignBit;
+  const UINT64 magnitude = bits ^ sign;
+
+  if (magnitude > kFlt64ExponentMask) {
+    return value;  // NaN
+  }
+  if (magnitude == kFlt64ExponentMask) {
+    return format.has_infinity ? value
+                               : BitsToFlt64(sign | kFlt64QuietNanBits);
+  }
+  if (magnitude >= format.normal_limit_bits) {
+    return Overflow<RoundingMode>(sign, format);
+  }
+  if (magnitude == 0) {
+    return value;
+  }
+  if (format.flush_denormals) {
+    return BitsToFlt64(sign);
+  }
+
+  // Round to a multiple of the smallest denormal of the format.
+  const INT32 biased_exponent = static_cast<INT32>(magnitude >> 52);
+  const UINT64 significand =
+      (magnitude & kFlt64MantissaMask) |
+      (biased_exponent != 0 ? kFlt64MantissaMask + 1 : 0);
+  const UINT32 shift = kFlt64MantissaBits - format.mantissa_bits +
+                       (format.min_exponent + kFlt64ExponentBias) -
+                       (biased_exponent != 0 ? biased_exponent : 1);
+  const UINT64 multiple = RoundShiftedSignificand<RoundingMode>(
+      significand, shift, sign != 0, random_bits);
+  const FLT64 min_denormal = BitsToFlt64(PowerOfTwoBits(
+      format.min_exponent - static_cast<INT32>(format.mantissa_bits)));
+  return BitsToFlt64(Flt64ToBits(multiple * min_denormal) | sign);
+}
+
+}  // namespace internal
+
+/**
+ * Creates the constants describing a binary floating-point format.
+ *
+ * @param[in] exponent_bits Number of exponent bits, between 2 and 8.
+ * @param[in] mantissa_bits Number of explicitly stored mantissa bits, between
+ *     1 and 23.
+ * @param[in] has_infinity Whether the format can represent infinities.
+ * @param[in] denormal_mode How values too small to be normal are treated.
+ */
+constexpr SoftFloatFormat MakeSoftFloatFormat(
+    const UINT32 exponent_bits, const UINT32 mantissa_bits,
+    const BOOL has_infinity, const FpDenormalMode denormal_mode) {
+  return SoftFloatFormat{
+      mantissa_bits,
+      internal::PowerOfTwoBits(2 - (1 << (exponent_bits - 1))),
+      internal::PowerOfTwoBits(
+          internal::MaxExponent(exponent_bits, has_infinity) + 1),
+      internal::PowerOfTwoBits(
+          internal::MaxExponent(exponent_bits, has_infinity)) |
+          internal::MaxMantissaBits(mantissa_bits, has_infinity),
+      2 - (1 << (exponent_bits - 1)),
+      has_infinity,
+      denormal_mode == kDenormalsFlushed};
+}
+
+/**
+ * Rounds a FLT64 to a floating-point format.
+ * Values within the normal range of the format are rounded without branching
+ * by adding a rounding increment to the bit pattern of the value and then
+ * truncating it; any carry out of the mantissa correctly increments the
+ * exponent.
+ *
+ * @tparam RoundingMode The rounding mode to use.
+ * @param[in] value The value to round. For a correctly rounded result, this
+ *     must either be exact or rounded to odd.
+ * @param[in] format The format to round to.
+ * @param[in] random_bits Random bits used when RoundingMode is
+ *     kRoundStochastic.
+ * @return The rounded value, which is exactly representable in the format.
+ */
+template <FpRoundingMode RoundingMode>
+inline FLT64 RoundToFormat(const FLT64 value, const SoftFloatFormat &format,
+                           const UINT64 random_bits) {
+  using namespace internal;
+  const UINT64 bits = Flt64ToBits(value);
+  const UINT64 sign = bits & kFlt64SignBit;
+  UINT64 magnitude = bits ^ sign;
+  if (magnitude - format.min_normal_bits >=
+      format.normal_limit_bits - format.min_normal_bits) {
+    return RoundToFormatSlow<RoundingMode>(value, format, random_bits);
+  }
+
+  const UINT32 shift = kFlt64MantissaBits - format.mantissa_bits;
+  const UINT64 mask = (1ull << shift) - 1;
+  switch (RoundingMode) {
+    case kRoundNearestEven:
+      magnitude += (mask >> 1) + ((magnitude >> shift) & 1);
+      break;
+    case kRoundTowardZero:
+      break;
+    case kRoundUp:
+      magnitude += mask & (static_cast<UINT64>(sign != 0) - 1);
+      break;
+    case kRoundDown:
+      magnitude += mask & (0 - static_cast<UINT64>(sign != 0));
+      break;
+    case kRoundStochastic:
+      magnitude += random_bits & mask;
+      break;
+  }
+  magnitude &= ~mask;
+  if (magnitude > format.max_finite_bits) {
+    return Overflow<RoundingMode>(sign, format);
+  }
+  return BitsToFlt64(magnitude | sign);
+}
+
+/**
+ * Rounds a FLT64 to a floating-point format with a rounding mode chosen at
+ * runtime.
+ *
+ * @see RoundToFormat
+ */
+FLT64 RoundToFormat(const FLT64 value, const SoftFloatFormat &format,
+                    const FpRoundingMode rounding_mode,
+                    const UINT64 random_bits);
+
+/**
+ * Returns the sum of two FLT64 values rounded to odd.
+ */
+inline FLT64 AddRoundedToOdd(const FLT64 a, const FLT64 b) {
+  const FLT64 sum = a + b;
+  // Knuth's TwoSum computes the exact rounding error of the sum.
+  const FLT64 b_virtual = sum - a;
+  const FLT64 a_virtual = sum - b_virtual;
+  const FLT64 error = (a - a_virtual) + (b - b_virtual);
+  return internal::RoundedToOdd(sum, error);
+}
+
+/**
+ * Returns the product of two FLT32 values, which is exact in FLT64.
+ */
+inline FLT64 MultiplyExactly(const FLT64 a, const FLT64 b) { return a * b; }
+
+/**
+ * Returns the quotient of two FLT32 values rounded to odd.
+ */
+inline FLT64 DivideRoundedToOdd(const FLT64 a, const FLT64 b) {
+  const FLT64 quotient = a / b;
+  const UINT64 quotient_magnitude =
+      internal::Flt64ToBits(quotient) & ~internal::kFlt64SignBit;
+  if (quotient_magnitude == 0 ||
+      quotient_magnitude >= internal::kFlt64ExponentMask) {
+    return quotient;
+  }
+  // Split the quotient into two halves whose products with the 24 bit divisor
+  // are exact, then compute the exact remainder a - quotient * b.
+  const FLT64 split = 134217729.0 * quotient;
+  const FLT64 quotient_high = split - (split - quotient);
+  const FLT64 quotient_low = quotient - quotient_high;
+  const FLT64 remainder = (a - quotient_high * b) - quotient_low * b;
+  return internal::RoundedToOdd(quotient, b > 0.0 ? remainder : -remainder);
+}
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_UTILS_SOFT_FLOAT_H_
@@ -0,0 +1,74 @@
+#ifndef CLIENT_LIB_UTILS_THREAD_LOCAL_H_
+#define CLIENT_LIB_UTILS_THREAD_LOCAL_H_
+
+#include <pin.H>
+
+#include <atomic>
+
+namespace NEAT {
+
+/**
+ * A separate instance of T for every thread of the instrumented application,
+ * stored in Pin's thread local storage. Each thread only ever accesses its own
+ * instance, so FpSelectors can keep per-thread state without locks.
+ *
+ * The instance of a thread is default constructed the first time the thread
+ * accesses it, and deleted after every FpSelector::OnThreadFini callback of
+ * the thread has run.
+ *
+ * @tparam T The type of the per-thread state.
+ */
+template <typename T>
+class ThreadLocal {
+ public:
+  ThreadLocal() : key_(INVALID_TLS_KEY) {}
+
+  /**
+   * Returns the instance of a thread, creating it if needed.
+   *
+   * @param[in] thread_id The Pin id of the calling thread.
+   */
+  T &Get(const THREADID thread_id) {
+    const TLS_KEY key = GetKey();
+    T *value = static_cast<T *>(PIN_GetThreadData(key, thread_id));
+    if (value == NULL) {
+      value = new T();
+      PIN_SetThreadData(key, value, thread_id);
+    }
+    return *value;
+  }
+
+ private:
+  /// Marks a key that another thread is creating.
+  static const TLS_KEY kCreatingKey = INVALID_TLS_KEY - 1;
+
+  /**
+   * Returns the Pin TLS key of this object. The key is created on first use
+   * rather than in the constructor, since ThreadLocal objects may be
+   * constructed statically before Pin is initialized.
+   */
+  TLS_KEY GetKey() {
+    TLS_KEY key = key_.load(memory_order_acquire);
+    if (key >= 0) {
+      return key;
+    }
+    TLS_KEY expected = INVALID_TLS_KEY;
+    if (key_.compare_exchange_strong(expected, kCreatingKey)) {
+      key = PIN_CreateThreadDataKey(DeleteValue);
+      key_.store(key, memory_order_release);
+      return key;
+    }
+    while ((key = key_.load(memory_order_acquire)) < 0) {
+      PIN_Yield();
+    }
+    return key;
+  }
+
+  static VOID DeleteValue(VOID *value) { delete static_cast<T *>(value); }
+
+  atomic<TLS_KEY> key_;
+};
+
+}  // namespace NEAT
+
+#endif  // CLIENT_LIB_UTILS_THREAD_LOCAL_H_
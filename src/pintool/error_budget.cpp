@@ -0,0 +1,344 @@
+#include "pintool/error_budget.h"
+
+#include <pin.H>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "client_lib/default_fp_selectors/normal_fp_implementation.h"
+#include "client_lib/utils/fp_operation.h"
+#include "pintool/overhead_report.h"
+#include "pintool/process_outputs.h"
+
+namespace NEAT {
+
+struct FunctionErrorBudget {
+  explicit FunctionErrorBudget(const string &function_name)
+      : function_name(function_name), error(0), executing_natively(FALSE) {}
+
+  const string function_name;
+  /// Sum of the relative errors of the replaced operations of the function,
+  /// estimated from the checked operations. Each thread adds its errors to it
+  /// in batches, see ThreadErrorBudget.
+  FLT64 error;
+  /// Whether the operations of the function execute natively.
+  volatile BOOL executing_natively;
+};
+
+namespace {
+
+/// Exit code of the application when it is stopped at a violation.
+const INT32 kViolationExitCode = 1;
+
+/// Fraction of the total budget whose worth of errors a thread keeps before
+/// adding them to the errors shared by every thread.
+const FLT64 kThreadErrorBudgetFraction = 1.0 / 16;
+
+/**
+ * The state of a thread, padded to a cache line so that threads never share
+ * one.
+ */
+struct alignas(64) ThreadErrorBudget {
+  /// The operations left before the next one the thread checks.
+  UINT64 fp_ops_until_check;
+  /// The errors of the operations the thread checked, by function, that are
+  /// not yet added to the errors of the functions. They are added under
+  /// error_budget_lock once they reach kThreadErrorBudgetFraction of the
+  /// total budget, at a violation and when the application exits, so that
+  /// threads rarely take the lock.
+  unordered_map<FunctionErrorBudget *, FLT64> function_errors;
+  /// Sum of function_errors.
+  FLT64 error;
+};
+
+/// The state of every thread.
+ThreadErrorBudget thread_error_budgets[PIN_MAX_THREADS];
+
+/// Whether the error budget is monitored.
+BOOL monitoring_error_budget = FALSE;
+
+/// The budgets, as given to MonitorErrorBudget.
+FLT64 max_op_error_budget = 0;
+FLT64 max_total_error_budget = 0;
+BOOL per_function_error_budget = FALSE;
+UINT64 check_period = 1;
+BOOL stop_at_violation = FALSE;
+
+/// Sum of the relative errors of every replaced operation, estimated from the
+/// checked operations. Each thread adds its errors to it in batches, see
+/// ThreadErrorBudget.
+FLT64 total_error = 0;
+
+/// Whether every function executes natively.
+volatile BOOL executing_all_natively = FALSE;
+
+/// The error budget of every function instrumented.
+map<string, FunctionErrorBudget *> function_error_budgets;
+
+/// The file violations and errors are logged to.
+ofstream *error_budget_log = NULL;
+
+/**
+ * Lock to protect the accumulated errors, and to ensure that only one thread
+ * handles a violation at a time, so that each function falls back to native
+ * execution once.
+ */
+PIN_MUTEX error_budget_lock;
+
+/// Computes the native results of operations.
+NormalFpImplementation native_fp_implementation;
+
+/**
+ * Returns the relative error of a replaced result. A result that differs from
+ * a native zero has its absolute error, and a result that differs from a
+ * native NaN or infinity, or that is a NaN when the native result is not, has
+ * an infinite error.
+ */
+FLT64 GetRelativeError(const FLT32 result, const FLT32 native_result) {
+  if (result == native_result ||
+      (std::isnan(result) && std::isnan(native_result))) {
+    return 0;
+  }
+  if (std::isnan(result) || std::isnan(native_result) ||
+      std::isinf(native_result)) {
+    return numeric_limits<FLT64>::infinity();
+  }
+  if (native_result == 0) {
+    return fabs(result);
+  }
+  return fabs(static_cast<FLT64>(result) - native_result) /
+         fabs(static_cast<FLT64>(native_result));
+}
+
+/**
+ * Adds the errors a thread kept to the errors of the functions and of the
+ * run. The lock of the errors must be held.
+ */
+VOID ReduceThreadErrors(ThreadErrorBudget *thread_error_budget) {
+  // The entries are kept, since the thread is likely to check operations of
+  // the same functions again.
+  for (auto &function_error : thread_error_budget->function_errors) {
+    function_error.first->error += function_error.second;
+    total_error += function_error.second;
+    function_error.second = 0;
+  }
+  thread_error_budget->error = 0;
+}
+
+/**
+ * Writes the description of the budgets and of the violation lines to the
+ * log.
+ */
+VOID WriteLogHeader(ofstream *log) {
+  *log << "# max_op_error " << max_op_error_budget << " max_total_error "
+       << max_total_error_budget << " per "
+       << (per_function_error_budget ? "function" : "run")
+       << ", checking 1 of every " << check_period << " replaced operations"
+       << endl;
+  *log << "# violation\treason\tfunction\tthread\topcode\toperand1\toperand2"
+          "\tresult\tnative_result\top_error\ttotal_error\taction"
+       << endl;
+}
+
+/**
+ * Logs a violation of the error budget and makes the offending function, or
+ * every function, execute natively from then on, or stops the application.
+ * Only the first violation of each function, or of the run, is handled.
+ *
+ * @param[in,out] error_budget The error budget of the offending function.
+ * @param[in] reason The budget exceeded, op_error or total_error.
+ * @param[in] operation The operation exceeding the budget.
+ * @param[in] result The replaced result of the operation.
+ * @param[in] native_result The native result of the operation.
+ * @param[in] op_error The relative error of the operation.
+ * @param[in] accumulated_error The error accumulated by the function or by
+ *     the run, leaving out the errors other threads still keep.
+ */
+VOID HandleViolation(FunctionErrorBudget *error_budget, const char *reason,
+                     const FpOperation &operation, const FLT32 result,
+                     const FLT32 native_result, const FLT64 op_error,
+                     const FLT64 accumulated_error) {
+  LockMutex(&error_budget_lock, kErrorBudgetMutex);
+  volatile BOOL &executing_natively = per_function_error_budget
+                                          ? error_budget->executing_natively
+                                          : executing_all_natively;
+  if (!executing_natively) {
+    const char *action = stop_at_violation ? "stop"
+                         : per_function_error_budget ? "native_function"
+                                                     : "native_run";
+    *error_budget_log << "violation\t" << reason << "\t"
+                      << error_budget->function_name << "\t"
+                      << operation.thread_id << "\t"
+                      << OPCODE_StringShort(operation.opcode) << "\t"
+                      << operation.operand1 << "\t" << operation.operand2
+                      << "\t" << result << "\t" << native_result << "\t"
+                      << op_error << "\t" << accumulated_error << "\t"
+                      << action << endl;
+    if (stop_at_violation) {
+      PIN_MutexUnlock(&error_budget_lock);
+      PIN_ExitApplication(kViolationExitCode);
+    }
+    // Code instrumented before the violation keeps checking whether the
+    // function executes natively until it is instrumented again.
+    executing_natively = TRUE;
+    PIN_RemoveInstrumentation();
+  }
+  PIN_MutexUnlock(&error_budget_lock);
+}
+
+}  // namespace
+
+namespace callbacks {
+namespace {
+
+/**
+ * Prints the error accumulated by every function, largest first, and by the
+ * whole run to the log and closes it.
+ * This function is called immediately before the instrumented application
+ * exits if the KnobErrorBudgetLog flag is supplied on the command line.
+ *
+ * @param[in] code Exit code of the pintool.
+ * @param[in,out] log The log to use.
+ */
+VOID PrintToFile(const INT32 code, ofstream *log) {
+  PIN_MutexLock(&error_budget_lock);
+  for (ThreadErrorBudget &thread_error_budget : thread_error_budgets) {
+    ReduceThreadErrors(&thread_error_budget);
+  }
+  PIN_MutexUnlock(&error_budget_lock);
+  vector<const FunctionErrorBudget *> error_budgets;
+  for (const auto &error_budget : function_error_budgets) {
+    error_budgets.push_back(error_budget.second);
+  }
+  stable_sort(error_budgets.begin(), error_budgets.end(),
+              [](const FunctionErrorBudget *a, const FunctionErrorBudget *b) {
+                return a->error > b->error;
+              });
+  *log << "# function\tname\ttotal_error\texecution" << endl;
+  for (const FunctionErrorBudget *error_budget : error_budgets) {
+    *log << "function\t" << error_budget->function_name << "\t"
+         << error_budget->error << "\t"
+         << (IsExecutingNatively(error_budget) ? "native" : "replaced")
+         << endl;
+  }
+  *log << "total\t" << total_error << "\t"
+       << (executing_all_natively ? "native" : "replaced") << endl;
+  log->close();
+  delete log;
+  PIN_MutexFini(&error_budget_lock);
+}
+
+/**
+ * Makes the forked process accumulate only the errors of the operations it
+ * executes, and starts its log anew. The functions executing natively keep
+ * doing so.
+ * This function is called in the child process after every fork if the
+ * KnobErrorBudgetLog flag is supplied on the command line.
+ *
+ * @param[in,out] log The log of the forked process.
+ */
+VOID ResetAfterFork(ofstream *log) {
+  total_error = 0;
+  for (const auto &error_budget : function_error_budgets) {
+    error_budget.second->error = 0;
+  }
+  for (ThreadErrorBudget &thread_error_budget : thread_error_budgets) {
+    thread_error_budget.function_errors.clear();
+    thread_error_budget.error = 0;
+  }
+  WriteLogHeader(log);
+}
+
+}  // namespace
+}  // namespace callbacks
+
+VOID MonitorErrorBudget(ofstream *log, const FLT64 max_op_error,
+                        const FLT64 max_total_error, const BOOL per_function,
+                        const UINT64 sample_period, const BOOL stop) {
+  PIN_MutexInit(&error_budget_lock);
+  monitoring_error_budget = TRUE;
+  max_op_error_budget = max_op_error;
+  max_total_error_budget = max_total_error;
+  per_function_error_budget = per_function;
+  check_period = sample_period;
+  stop_at_violation = stop;
+  error_budget_log = log;
+  // Print values precisely enough to tell every single-precision value apart.
+  log->precision(9);
+  WriteLogHeader(log);
+
+  PIN_AddFiniFunction(reinterpret_cast<FINI_CALLBACK>(callbacks::PrintToFile),
+                      log);
+  RegisterProcessOutput(log, &error_budget_lock, callbacks::ResetAfterFork);
+}
+
+FunctionErrorBudget *GetFunctionErrorBudget(const string &function_name) {
+  if (!monitoring_error_budget) {
+    return NULL;
+  }
+  FunctionErrorBudget *&error_budget = function_error_budgets[function_name];
+  if (error_budget == NULL) {
+    error_budget = new FunctionErrorBudget(function_name);
+  }
+  return error_budget;
+}
+
+BOOL IsExecutingNatively(const FunctionErrorBudget *error_budget) {
+  return error_budget != NULL &&
+         (executing_all_natively || error_budget->executing_natively);
+}
+
+FLT32 GetNativeFpResult(const FpOperation &operation) {
+  return native_fp_implementation.PerformOperation(operation);
+}
+
+FLT32 CheckFpResult(FunctionErrorBudget *error_budget,
+                    const FpOperation &operation, const FLT32 result) {
+  ThreadErrorBudget &thread_error_budget =
+      thread_error_budgets[operation.thread_id];
+  if (thread_error_budget.fp_ops_until_check > 0) {
+    thread_error_budget.fp_ops_until_check--;
+    return result;
+  }
+  thread_error_budget.fp_ops_until_check = check_period - 1;
+
+  const FLT32 native_result = GetNativeFpResult(operation);
+  const FLT64 op_error = GetRelativeError(result, native_result);
+  // Every checked operation stands for check_period replaced operations.
+  const FLT64 error = op_error * check_period;
+  thread_error_budget.function_errors[error_budget] += error;
+  thread_error_budget.error += error;
+  const BOOL exceeds_op_budget =
+      max_op_error_budget > 0 && op_error > max_op_error_budget;
+  if (!exceeds_op_budget &&
+      !(max_total_error_budget > 0 &&
+        thread_error_budget.error >=
+            max_total_error_budget * kThreadErrorBudgetFraction)) {
+    return result;
+  }
+
+  LockMutex(&error_budget_lock, kErrorBudgetMutex);
+  ReduceThreadErrors(&thread_error_budget);
+  const FLT64 accumulated_error =
+      per_function_error_budget ? error_budget->error : total_error;
+  PIN_MutexUnlock(&error_budget_lock);
+  if (exceeds_op_budget) {
+    HandleViolation(error_budget, "op_error", operation, result, native_result,
+                    op_error, accumulated_error);
+    return native_result;
+  }
+  if (accumulated_error > max_total_error_budget) {
+    HandleViolation(error_budget, "total_error", operation, result,
+                    native_result, op_error, accumulated_error);
+    return native_result;
+  }
+  return result;
+}
+
+}  // namespace NEAT
@@ -0,0 +1,78 @@
+#ifndef PINTOOL_ERROR_BUDGET_H_
+#define PINTOOL_ERROR_BUDGET_H_
+
+#include <pin.H>
+
+#include <fstream>
+#include <string>
+
+#include "client_lib/utils/fp_operation.h"
+
+namespace NEAT {
+
+/// The error accumulated by the replaced operations of a function.
+struct FunctionErrorBudget;
+
+/**
+ * Makes the replacement of floating-point operations compare the replaced
+ * results of sampled operations to their native results. When the relative
+ * error of an operation or the error accumulated by a function or by the
+ * whole run exceeds its budget, the violation is logged and the offending
+ * function, or every function, executes natively from then on, or the
+ * application exits. It must be called before the application starts.
+ *
+ * @param[in] log The file to log violations and the accumulated errors to.
+ * @param[in] max_op_error Largest relative error of a single operation, or 0
+ *     for no limit.
+ * @param[in] max_total_error Largest sum of the relative errors of the
+ *     operations, estimated from the sampled operations, or 0 for no limit.
+ * @param[in] per_function Whether the sum is limited per function and only
+ *     the offending function falls back to native execution, instead of the
+ *     whole run.
+ * @param[in] sample_period Number of replaced operations of every thread for
+ *     every operation that is checked, at least 1.
+ * @param[in] stop Whether the application exits at the first violation
+ *     instead of falling back to native execution.
+ */
+VOID MonitorErrorBudget(ofstream *log, const FLT64 max_op_error,
+                        const FLT64 max_total_error, const BOOL per_function,
+                        const UINT64 sample_period, const BOOL stop);
+
+/**
+ * Returns the error budget of a function, which stays valid until the
+ * application exits, or NULL if the error budget is not monitored. It must be
+ * called from instrumentation callbacks.
+ */
+FunctionErrorBudget *GetFunctionErrorBudget(const string &function_name);
+
+/**
+ * Returns whether the floating-point operations of a function execute
+ * natively because an error budget was exceeded.
+ *
+ * @param[in] error_budget The error budget of the function, or NULL.
+ */
+BOOL IsExecutingNatively(const FunctionErrorBudget *error_budget);
+
+/**
+ * Returns the native result of a floating-point operation.
+ */
+FLT32 GetNativeFpResult(const FpOperation &operation);
+
+/**
+ * Checks the result of a replaced floating-point operation against the error
+ * budget if the operation is sampled, and returns the result the application
+ * must see: the native result if a budget was exceeded, the replaced result
+ * otherwise. This function never returns if the application is stopped.
+ *
+ * @param[in,out] error_budget The error budget of the function containing the
+ *     operation.
+ * @param[in] operation The floating-point operation.
+ * @param[in] result The result of the operation computed by an
+ *     FpImplementation.
+ */
+FLT32 CheckFpResult(FunctionErrorBudget *error_budget,
+                    const FpOperation &operation, const FLT32 result);
+
+}  // namespace NEAT
+
+#endif  // PINTOOL_ERROR_BUDGET_H_
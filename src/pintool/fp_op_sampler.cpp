@@ -0,0 +1,80 @@
+#include "pintool/fp_op_sampler.h"
+
+#include <pin.H>
+
+#include <cmath>
+#include <sstream>
+#include <string>
+
+namespace NEAT {
+
+FpOpSampler::FpOpSampler() : period_(1), burst_(1), thread_states_() {}
+
+VOID FpOpSampler::SetSampling(const UINT64 period, const UINT64 burst) {
+  period_ = period;
+  burst_ = burst;
+  // Sample the first operations of every thread.
+  for (UINT32 thread_id = 0; thread_id < PIN_MAX_THREADS; thread_id++) {
+    thread_states_[thread_id].position = period - 1;
+  }
+}
+
+VOID FpOpSampler::InsertCall(const INS ins, const IPOINT ipoint,
+                             const CALL_ORDER order, const BOOL new_fp_op,
+                             const AFUNPTR function, const IARGLIST args) {
+  if (!IsSampling()) {
+    // clang-format off
+    INS_InsertCall(
+        ins, ipoint, function,
+        IARG_IARGLIST, args,
+        IARG_CALL_ORDER, order,
+        IARG_END);
+    // clang-format on
+    return;
+  }
+
+  // clang-format off
+  INS_InsertIfCall(
+      ins, ipoint,
+      reinterpret_cast<AFUNPTR>(new_fp_op ? SampleFpOp : IsFpOpSampled),
+      IARG_PTR, this,
+      IARG_THREAD_ID,
+      IARG_CALL_ORDER, order,
+      IARG_END);
+  INS_InsertThenCall(
+      ins, ipoint, function,
+      IARG_IARGLIST, args,
+      IARG_CALL_ORDER, order,
+      IARG_END);
+  // clang-format on
+}
+
+FLT64 FpOpSampler::GetConfidenceInterval(const FLT64 sum_of_squares) const {
+  const FLT64 fraction = static_cast<FLT64>(burst_) / period_;
+  return 1.96 * sqrt((1.0 - fraction) * sum_of_squares) / fraction;
+}
+
+string FpOpSampler::GetDescription() const {
+  ostringstream description;
+  description << "# sampled " << burst_ << " of every " << period_
+              << " floating-point operations, scaling factor "
+              << GetScalingFactor();
+  return description.str();
+}
+
+ADDRINT FpOpSampler::SampleFpOp(FpOpSampler *sampler,
+                                const THREADID thread_id) {
+  // Avoid branches so that Pin can inline this function.
+  ThreadState &state = sampler->thread_states_[thread_id];
+  const UINT64 position = state.position + 1;
+  state.position = position * (position < sampler->period_);
+  state.sampled = state.position < sampler->burst_;
+  return state.sampled;
+}
+
+ADDRINT FpOpSampler::IsFpOpSampled(FpOpSampler *sampler,
+                                   const THREADID thread_id) {
+  return sampler->thread_states_[thread_id].sampled;
+}
+
+}  // namespace NEAT
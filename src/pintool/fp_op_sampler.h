@@ -0,0 +1,114 @@
+#ifndef PINTOOL_FP_OP_SAMPLER_H_
+#define PINTOOL_FP_OP_SAMPLER_H_
+
+#include <pin.H>
+
+#include <string>
+
+namespace NEAT {
+
+/**
+ * Decides which floating-point operations a tracing or profiling feature
+ * records: bursts of consecutive operations at the start of every period of
+ * operations, counted separately by every thread. Recording 1 in N operations
+ * is a burst of 1 every N. Whether an operation is sampled is decided by an
+ * analysis routine that Pin inlines, so operations that are not sampled only
+ * pay for a decrement and a branch.
+ *
+ * Instances should have static storage duration so that the state of every
+ * thread is aligned to its own cache line.
+ */
+class FpOpSampler {
+ public:
+  /**
+   * Creates a sampler that samples every operation.
+   */
+  FpOpSampler();
+
+  /**
+   * Changes which operations are sampled. It must be called before the
+   * instrumented application starts.
+   *
+   * @param[in] period Number of operations in every sampling period, at least
+   *     1.
+   * @param[in] burst Number of operations sampled in every period, between 1
+   *     and period. Every operation is sampled if it equals period.
+   */
+  VOID SetSampling(const UINT64 period, const UINT64 burst);
+
+  /**
+   * Returns whether only some operations are sampled.
+   */
+  BOOL IsSampling() const { return burst_ < period_; }
+
+  /**
+   * Inserts a call to an analysis routine for a floating-point instruction
+   * that only runs when the operation is sampled.
+   *
+   * @param[in] ins The floating-point instruction.
+   * @param[in] ipoint Where to insert the call.
+   * @param[in] order Order of the call relative to other analysis routines.
+   * @param[in] new_fp_op Whether this is the first call inserted for each
+   *     operation of the instruction, which decides whether the operation is
+   *     sampled. Later calls reuse the decision.
+   * @param[in] function The analysis routine.
+   * @param[in] args The arguments of the analysis routine.
+   */
+  VOID InsertCall(const INS ins, const IPOINT ipoint, const CALL_ORDER order,
+                  const BOOL new_fp_op, const AFUNPTR function,
+                  const IARGLIST args);
+
+  /**
+   * Returns the factor scaling sampled totals into estimated totals.
+   */
+  FLT64 GetScalingFactor() const {
+    return static_cast<FLT64>(period_) / burst_;
+  }
+
+  /**
+   * Returns the half-width of the 95% confidence interval of an estimated
+   * total, treating the operations as sampled independently.
+   *
+   * @param[in] sum_of_squares The sum of the squares of the sampled values,
+   *     which is the number of samples when counting operations.
+   */
+  FLT64 GetConfidenceInterval(const FLT64 sum_of_squares) const;
+
+  /**
+   * Returns a comment line describing the sampling, to write at the start of
+   * outputs.
+   */
+  string GetDescription() const;
+
+ private:
+  /**
+   * The sampling state of a single thread, padded to a cache line so that
+   * threads never share one.
+   */
+  struct alignas(64) ThreadState {
+    /// Position of the last operation in the current period.
+    UINT64 position;
+    /// Whether the last operation was sampled.
+    ADDRINT sampled;
+  };
+
+  /**
+   * Moves a thread on to its next operation and returns whether it is
+   * sampled.
+   */
+  static ADDRINT SampleFpOp(FpOpSampler *sampler, const THREADID thread_id);
+
+  /**
+   * Returns whether the current operation of a thread is sampled.
+   */
+  static ADDRINT IsFpOpSampled(FpOpSampler *sampler,
+                               const THREADID thread_id);
+
+  UINT64 period_;
+  UINT64 burst_;
+  ThreadState thread_states_[PIN_MAX_THREADS];
+};
+
+}  // namespace NEAT
+
+#endif  // PINTOOL_FP_OP_SAMPLER_H_
@@ -0,0 +1,247 @@
+#include "pintool/fp_routine_index.h"
+
+#include <pin.H>
+
+#include <elf.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "pintool/utils.h"
+
+namespace NEAT {
+namespace {
+
+/// The first line of every index file.
+const char kIndexFileHeader[] = "NEAT fp routine index 1";
+
+/// Whether FpRoutineIndex was called.
+BOOL index_enabled = FALSE;
+
+/// The directory storing the index of each image.
+string index_cache_directory;
+
+/// The offsets from the start of their image of the routines containing
+/// floating-point arithmetic instructions, for every loaded image by id.
+unordered_map<UINT32, unordered_set<ADDRINT>> fp_routine_offsets;
+
+/**
+ * Reads the GNU build ID note of an ELF file whose headers have the supplied
+ * types, returning an empty string if it has none.
+ */
+template <typename ElfHeader, typename SectionHeader, typename NoteHeader>
+string ReadBuildId(ifstream &input) {
+  ElfHeader header;
+  if (!input.seekg(0) ||
+      !input.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+    return "";
+  }
+  for (UINT32 i = 0; i < header.e_shnum; i++) {
+    SectionHeader section;
+    if (!input.seekg(header.e_shoff + i * header.e_shentsize) ||
+        !input.read(reinterpret_cast<char *>(&section), sizeof(section))) {
+      return "";
+    }
+    if (section.sh_type != SHT_NOTE) {
+      continue;
+    }
+    NoteHeader note;
+    if (!input.seekg(section.sh_offset) ||
+        !input.read(reinterpret_cast<char *>(&note), sizeof(note))) {
+      return "";
+    }
+    if (note.n_type != NT_GNU_BUILD_ID || note.n_descsz == 0) {
+      continue;
+    }
+    // The name of the note is padded to 4 bytes.
+    string description(note.n_descsz, '\0');
+    if (!input.seekg((note.n_namesz + 3) & ~3u, ios::cur) ||
+        !input.read(&description[0], description.size())) {
+      return "";
+    }
+    string build_id;
+    for (const char byte : description) {
+      build_id += StringHex(static_cast<UINT8>(byte), 2, FALSE);
+    }
+    return build_id;
+  }
+  return "";
+}
+
+/**
+ * Returns a key identifying the contents of an image file: its GNU build ID,
+ * or its size and modification time if it has none. Returns an empty string
+ * if the file cannot be read, such as for the vDSO.
+ *
+ * @param[in] image_path The path of the image.
+ */
+string GetImageKey(const string &image_path) {
+  struct stat status;
+  if (stat(image_path.c_str(), &status) != 0) {
+    return "";
+  }
+  ifstream input(image_path.c_str(), ios::binary);
+  unsigned char ident[EI_NIDENT];
+  string build_id;
+  if (input.read(reinterpret_cast<char *>(ident), sizeof(ident))) {
+    if (ident[EI_CLASS] == ELFCLASS64) {
+      build_id = ReadBuildId<Elf64_Ehdr, Elf64_Shdr, Elf64_Nhdr>(input);
+    } else if (ident[EI_CLASS] == ELFCLASS32) {
+      build_id = ReadBuildId<Elf32_Ehdr, Elf32_Shdr, Elf32_Nhdr>(input);
+    }
+  }
+  if (!build_id.empty()) {
+    return build_id;
+  }
+  return decstr(static_cast<UINT64>(status.st_size)) + "-" +
+         decstr(static_cast<UINT64>(status.st_mtime));
+}
+
+/**
+ * Returns the path of the index file of an image in the cache directory, or
+ * an empty string if the image cannot be cached.
+ *
+ * @param[in] image_path The path of the image.
+ */
+string GetIndexFileName(const string &image_path) {
+  if (index_cache_directory.empty()) {
+    return "";
+  }
+  const string image_key = GetImageKey(image_path);
+  if (image_key.empty()) {
+    return "";
+  }
+  const string image_name = image_path.substr(image_path.rfind('/') + 1);
+  return index_cache_directory + "/" + image_name + "-" +
+         StringHex(hash<string>()(image_path), 16, FALSE) +
+         "-" + image_key + ".fp_routines";
+}
+
+/**
+ * Loads the index of an image from its index file.
+ *
+ * @param[in] index_file_name The index file of the image.
+ * @param[out] offsets The offsets of the routines containing floating-point
+ *     arithmetic instructions.
+ * @return Whether a valid index was loaded.
+ */
+BOOL LoadIndex(const string &index_file_name,
+               unordered_set<ADDRINT> *offsets) {
+  ifstream input(index_file_name.c_str());
+  string line;
+  if (!getline(input, line) || line != kIndexFileHeader) {
+    return FALSE;
+  }
+  while (getline(input, line)) {
+    offsets->insert(Uint64FromString(line));
+  }
+  return TRUE;
+}
+
+/**
+ * Saves the index of an image to its index file. The index is first written
+ * to a temporary file so that concurrently starting processes never load a
+ * partially written index.
+ *
+ * @param[in] index_file_name The index file of the image.
+ * @param[in] offsets The offsets of the routines containing floating-point
+ *     arithmetic instructions.
+ */
+VOID SaveIndex(const string &index_file_name,
+               const unordered_set<ADDRINT> &offsets) {
+  const string temp_file_name = index_file_name + ".tmp." + decstr(getpid());
+  ofstream output(temp_file_name.c_str());
+  output << kIndexFileHeader << endl;
+  for (const ADDRINT offset : offsets) {
+    output << hexstr(offset) << endl;
+  }
+  output.close();
+  if (!output || rename(temp_file_name.c_str(), index_file_name.c_str()) != 0) {
+    cerr << "Could not save the floating-point routine index to "
+         << index_file_name << endl;
+    remove(temp_file_name.c_str());
+  }
+}
+
+/**
+ * Opens every routine of an image to find those containing floating-point
+ * arithmetic instructions.
+ *
+ * @param[in] img The image to scan.
+ * @param[out] offsets The offsets of the routines containing floating-point
+ *     arithmetic instructions.
+ */
+VOID ScanImage(const IMG img, unordered_set<ADDRINT> *offsets) {
+  for (SEC sec = IMG_SecHead(img); SEC_Valid(sec); sec = SEC_Next(sec)) {
+    for (RTN rtn = SEC_RtnHead(sec); RTN_Valid(rtn); rtn = RTN_Next(rtn)) {
+      RTN_Open(rtn);
+      for (INS ins = RTN_InsHead(rtn); INS_Valid(ins); ins = INS_Next(ins)) {
+        if (IsFpInstruction(ins)) {
+          offsets->insert(RTN_Address(rtn) - IMG_LowAddress(img));
+          break;
+        }
+      }
+      RTN_Close(rtn);
+    }
+  }
+}
+
+}  // namespace
+
+namespace callbacks {
+namespace {
+
+/**
+ * Discards the index of an image.
+ * This function is called every time an image is unloaded if the
+ * KnobFpRoutineCache flag is supplied on the command line.
+ *
+ * @param[in] img The image being unloaded.
+ * @param[in] v Unused.
+ */
+VOID UnloadImage(const IMG img, VOID *v) {
+  fp_routine_offsets.erase(IMG_Id(img));
+}
+
+}  // namespace
+}  // namespace callbacks
+
+VOID FpRoutineIndex(const string &cache_directory) {
+  index_enabled = TRUE;
+  index_cache_directory = cache_directory;
+  IMG_AddUnloadFunction(callbacks::UnloadImage, NULL);
+}
+
+BOOL MayContainFpInstructions(const RTN rtn) {
+  if (!index_enabled) {
+    return TRUE;
+  }
+  const IMG img = SEC_Img(RTN_Sec(rtn));
+  if (!IMG_Valid(img)) {
+    return TRUE;
+  }
+
+  // Index each image the first time one of its routines is instrumented.
+  if (fp_routine_offsets.count(IMG_Id(img)) == 0) {
+    unordered_set<ADDRINT> &offsets = fp_routine_offsets[IMG_Id(img)];
+    const string index_file_name = GetIndexFileName(IMG_Name(img));
+    if (index_file_name.empty() || !LoadIndex(index_file_name, &offsets)) {
+      offsets.clear();
+      ScanImage(img, &offsets);
+      if (!index_file_name.empty()) {
+        SaveIndex(index_file_name, offsets);
+      }
+    }
+  }
+  return fp_routine_offsets[IMG_Id(img)].count(RTN_Address(rtn) -
+                                                IMG_LowAddress(img)) > 0;
+}
+
+}  // namespace NEAT
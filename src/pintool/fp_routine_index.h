@@ -0,0 +1,33 @@
+#ifndef PINTOOL_FP_ROUTINE_INDEX_H_
+#define PINTOOL_FP_ROUTINE_INDEX_H_
+
+#include <pin.H>
+
+#include <string>
+
+namespace NEAT {
+
+/**
+ * Records which routines of every loaded image contain floating-point
+ * arithmetic instructions, so that instrumentation callbacks can skip the
+ * others without opening them. Each image is scanned once, and the result is
+ * stored in a cache directory keyed by the path and build ID of the image, so
+ * later runs scan no image that has not changed.
+ *
+ * @param[in] cache_directory The directory storing the index of each image.
+ */
+VOID FpRoutineIndex(const string &cache_directory);
+
+/**
+ * Returns whether a routine may contain floating-point arithmetic
+ * instructions, which is always the case if FpRoutineIndex was not called.
+ * This must be called from an instrumentation callback while no routine is
+ * open.
+ *
+ * @param[in] rtn The routine to look up.
+ */
+BOOL MayContainFpInstructions(const RTN rtn);
+
+}  // namespace NEAT
+
+#endif  // PINTOOL_FP_ROUTINE_INDEX_H_
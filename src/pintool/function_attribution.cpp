@@ -0,0 +1,101 @@
+#include "pintool/function_attribution.h"
+
+#include <pin.H>
+
+#include <map>
+#include <string>
+#include <unordered_set>
+
+namespace NEAT {
+
+const char kUnknownFunctionName[] = "unknown";
+
+namespace {
+
+/// The address range of a routine.
+struct FunctionRange {
+  /// The first address after the routine.
+  ADDRINT end;
+  /// The name of the routine.
+  const string *name;
+};
+
+/// Whether InitFunctionAttribution was called.
+BOOL function_attribution_initialized = FALSE;
+
+/// The ranges of every routine looked up so far, by start address.
+map<ADDRINT, FunctionRange> function_ranges;
+
+/// Every function name returned so far. Names are never removed, because
+/// analysis routines may still refer to them after their image is unloaded.
+unordered_set<string> function_names = {kUnknownFunctionName};
+
+}  // namespace
+
+namespace callbacks {
+namespace {
+
+/**
+ * Forgets the ranges looked up within the addresses of an image, which belong
+ * to code outside any image before it is loaded, and may be reused by images
+ * loaded after it is unloaded.
+ * This function is called every time an image is loaded or unloaded if trace
+ * instrumentation is used.
+ *
+ * @param[in] img The image being loaded or unloaded.
+ * @param[in] v Unused.
+ */
+VOID ForgetImageRanges(const IMG img, VOID *v) {
+  function_ranges.erase(function_ranges.lower_bound(IMG_LowAddress(img)),
+                        function_ranges.upper_bound(IMG_HighAddress(img)));
+}
+
+}  // namespace
+}  // namespace callbacks
+
+VOID InitFunctionAttribution() {
+  if (function_attribution_initialized) {
+    return;
+  }
+  function_attribution_initialized = TRUE;
+  IMG_AddInstrumentFunction(callbacks::ForgetImageRanges, NULL);
+  IMG_AddUnloadFunction(callbacks::ForgetImageRanges, NULL);
+}
+
+const string &GetFunctionName(const ADDRINT address) {
+  map<ADDRINT, FunctionRange>::const_iterator range =
+      function_ranges.upper_bound(address);
+  if (range != function_ranges.begin()) {
+    --range;
+    if (address < range->second.end) {
+      return *range->second.name;
+    }
+  }
+
+  const RTN rtn = RTN_FindByAddress(address);
+  if (!RTN_Valid(rtn)) {
+    // Cache the miss too, as traces of code outside any routine are
+    // instrumented again whenever Pin's code cache drops them.
+    const string &name = *function_names.find(kUnknownFunctionName);
+    function_ranges[address] = {address + 1, &name};
+    return name;
+  }
+  const string &name = *function_names.insert(RTN_Name(rtn)).first;
+  // A routine of unknown size extends up to the next routine of its section,
+  // which is where Pin stops attributing addresses to it.
+  const ADDRINT start = RTN_Address(rtn);
+  ADDRINT end = start + RTN_Size(rtn);
+  if (RTN_Size(rtn) == 0) {
+    const RTN next_rtn = RTN_Next(rtn);
+    const SEC sec = RTN_Sec(rtn);
+    end = RTN_Valid(next_rtn) ? RTN_Address(next_rtn)
+                              : SEC_Address(sec) + SEC_Size(sec);
+    if (end <= address) {
+      end = address + 1;
+    }
+  }
+  function_ranges[start] = {end, &name};
+  return name;
+}
+
+}  // namespace NEAT
@@ -0,0 +1,36 @@
+#ifndef PINTOOL_FUNCTION_ATTRIBUTION_H_
+#define PINTOOL_FUNCTION_ATTRIBUTION_H_
+
+#include <pin.H>
+
+#include <string>
+
+namespace NEAT {
+
+/**
+ * The function name of code that belongs to no known routine, such as code
+ * generated at runtime or stripped code.
+ */
+extern const char kUnknownFunctionName[];
+
+/**
+ * Prepares GetFunctionName for use by trace instrumentation. This may be
+ * called any number of times before the application starts.
+ */
+VOID InitFunctionAttribution();
+
+/**
+ * Returns the name of the routine containing an instruction, or
+ * kUnknownFunctionName if no routine contains it. The address range of each
+ * routine, and each address outside any routine, is cached when it is first
+ * looked up, so that they do not query Pin's symbols again. This must be
+ * called from an instrumentation callback.
+ *
+ * @param[in] address The address of the instruction.
+ * @return The name of the routine, which stays valid until the tool exits.
+ */
+const string &GetFunctionName(const ADDRINT address);
+
+}  // namespace NEAT
+
+#endif  // PINTOOL_FUNCTION_ATTRIBUTION_H_
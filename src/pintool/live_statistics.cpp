@@ -0,0 +1,300 @@
+#include "pintool/live_statistics.h"
+
+#include <pin.H>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pintool/overhead_report.h"
+#include "pintool/print_fp_bits_manipulated.h"
+#include "pintool/print_function_num_fp_ops.h"
+#include "pintool/region_of_interest.h"
+#include "pintool/utils.h"
+
+namespace NEAT {
+namespace {
+
+/// Identifies a NEAT live statistics segment.
+const char kLiveStatisticsMagic[8] = {'N', 'E', 'A', 'T', 'L', 'I', 'V', '\0'};
+
+/// Version of the segment layout. Increment when the layout changes.
+const UINT32 kLiveStatisticsFormatVersion = 1;
+
+/// Longest time the publishing thread sleeps before checking for exit.
+const UINT32 kMaxSleepMs = 100;
+
+/// Time to wait for the publishing thread to finish when the application
+/// exits.
+const UINT32 kPublishThreadTimeoutMs = 10000;
+
+/**
+ * The statistics counted on a single thread, padded to a cache line so that
+ * threads never share one.
+ */
+struct alignas(64) ThreadLiveStatistics {
+  UINT64 opcode_fp_ops[kNumLiveStatisticsOpcodes];
+  UINT64 replaced_fp_ops;
+  UINT64 replaced_math_calls;
+};
+
+/// The statistics counted on every thread.
+ThreadLiveStatistics thread_statistics[PIN_MAX_THREADS];
+
+/// Whether the live statistics are published.
+BOOL publishing = FALSE;
+
+/// The shared memory segment holding the live statistics.
+LiveStatisticsSegment *segment = NULL;
+
+/// Time between updates of the segment in milliseconds.
+UINT32 publish_interval_ms = 0;
+
+/// The internal thread publishing the statistics.
+PIN_THREAD_UID publish_thread_uid;
+
+/**
+ * Returns the index of an opcode in the per-opcode counts.
+ */
+UINT32 GetOpcodeIndex(const UINT32 opcode) {
+  switch (opcode) {
+    case XED_ICLASS_ADDSS:
+      return 0;
+    case XED_ICLASS_SUBSS:
+      return 1;
+    case XED_ICLASS_MULSS:
+      return 2;
+    default:
+      return 3;
+  }
+}
+
+/**
+ * Sums the statistics of every thread and of the other features, and writes
+ * them to the segment. Only one thread may call this function at a time.
+ *
+ * @param[in] exited Whether the application has exited.
+ */
+VOID Publish(const BOOL exited) {
+  ThreadLiveStatistics total = {};
+  for (UINT32 thread_id = 0; thread_id < PIN_MAX_THREADS; thread_id++) {
+    const ThreadLiveStatistics &statistics = thread_statistics[thread_id];
+    for (UINT32 i = 0; i < kNumLiveStatisticsOpcodes; i++) {
+      total.opcode_fp_ops[i] += statistics.opcode_fp_ops[i];
+    }
+    total.replaced_fp_ops += statistics.replaced_fp_ops;
+    total.replaced_math_calls += statistics.replaced_math_calls;
+  }
+  UINT64 fp_bits_manipulated = 0;
+  const BOOL has_fp_bits_manipulated =
+      GetFpBitsManipulated(&fp_bits_manipulated);
+  vector<pair<string, UINT64>> function_fp_ops;
+  const BOOL has_function_fp_ops =
+      GetTopFunctionNumFpOps(kMaxLiveStatisticsFunctions, &function_fp_ops);
+  const UINT64 update_time_ns =
+      chrono::duration_cast<chrono::nanoseconds>(
+          chrono::system_clock::now().time_since_epoch())
+          .count();
+
+  // Readers retry while the sequence is odd, so it must be odd before any
+  // statistic changes and even only after all of them have.
+  const UINT64 sequence = segment->sequence;
+  segment->sequence = sequence + 1;
+  atomic_thread_fence(memory_order_release);
+  segment->exited = exited;
+  segment->num_updates++;
+  segment->update_time_ns = update_time_ns;
+  segment->fp_ops = 0;
+  for (UINT32 i = 0; i < kNumLiveStatisticsOpcodes; i++) {
+    segment->opcode_fp_ops[i] = total.opcode_fp_ops[i];
+    segment->fp_ops += total.opcode_fp_ops[i];
+  }
+  segment->replaced_fp_ops = total.replaced_fp_ops;
+  segment->replaced_math_calls = total.replaced_math_calls;
+  segment->has_fp_bits_manipulated = has_fp_bits_manipulated;
+  segment->fp_bits_manipulated = fp_bits_manipulated;
+  segment->has_function_fp_ops = has_function_fp_ops;
+  segment->num_functions = function_fp_ops.size();
+  for (UINT32 i = 0; i < function_fp_ops.size(); i++) {
+    LiveStatisticsFunction &function = segment->functions[i];
+    strncpy(function.name, function_fp_ops[i].first.c_str(),
+            sizeof(function.name) - 1);
+    function.name[sizeof(function.name) - 1] = '\0';
+    function.fp_ops = function_fp_ops[i].second;
+  }
+  atomic_thread_fence(memory_order_release);
+  segment->sequence = sequence + 2;
+}
+
+}  // namespace
+
+namespace analysis {
+namespace {
+
+/**
+ * Counts a floating-point arithmetic operation. This function is simple enough
+ * for Pin to inline it.
+ * This function is called for every floating-point arithmetic instruction if
+ * the KnobLiveStats flag is supplied on the command line.
+ *
+ * @param[in] thread_id Pin id of the thread executing the operation.
+ * @param[in] opcode_index Index of the opcode of the operation.
+ */
+VOID CountFpOperation(const THREADID thread_id, const UINT32 opcode_index) {
+  thread_statistics[thread_id].opcode_fp_ops[opcode_index]++;
+}
+
+}  // namespace
+}  // namespace analysis
+
+namespace callbacks {
+namespace {
+
+/**
+ * Schedules a call to an analysis routine to count a floating-point arithmetic
+ * instruction.
+ * This function is called every time a new instruction is encountered if the
+ * KnobLiveStats flag is supplied on the command line.
+ *
+ * @param[in] ins Instruction to be instrumented.
+ * @param[in] v Unused.
+ */
+VOID InstrumentationCallback(const INS ins, VOID *v) {
+  const OverheadCallbackTimer timer(kLiveStatisticsCallback);
+  if (!IsInRegionOfInterest() || !IsFpInstruction(ins)) {
+    return;
+  }
+
+  // clang-format off
+  INS_InsertCall(
+      ins, IPOINT_BEFORE,
+      reinterpret_cast<AFUNPTR>(analysis::CountFpOperation),
+      IARG_THREAD_ID,
+      IARG_UINT32, GetOpcodeIndex(INS_Opcode(ins)),
+      IARG_END);
+  // clang-format on
+  CountAnalysisCalls(ins, kLiveStatisticsFeature, 1);
+}
+
+/**
+ * Publishes the statistics every publish_interval_ms milliseconds until the
+ * application exits.
+ * This function runs on an internal thread if the KnobLiveStats flag is
+ * supplied on the command line.
+ *
+ * @param[in] arg Unused.
+ */
+VOID PublishThread(VOID *arg) {
+  while (!PIN_IsProcessExiting()) {
+    Publish(FALSE);
+    for (UINT32 slept_ms = 0;
+         slept_ms < publish_interval_ms && !PIN_IsProcessExiting();
+         slept_ms += kMaxSleepMs) {
+      PIN_Sleep(min(publish_interval_ms - slept_ms, kMaxSleepMs));
+    }
+  }
+}
+
+/**
+ * Stops the publishing thread and publishes the final statistics, before the
+ * features whose counts are published print them.
+ * This function is called when the application is about to exit if the
+ * KnobLiveStats flag is supplied on the command line.
+ *
+ * @param[in] code OS specific termination code for the application.
+ * @param[in] v Unused.
+ */
+VOID PublishFinalStatistics(const INT32 code, VOID *v) {
+  if (!publishing) {
+    return;
+  }
+  if (!PIN_WaitForThreadTermination(publish_thread_uid,
+                                    kPublishThreadTimeoutMs, NULL)) {
+    cerr << "Timed out waiting for the live statistics thread" << endl;
+    return;
+  }
+  Publish(TRUE);
+}
+
+/**
+ * Stops publishing in the forked process, which has no publishing thread and
+ * must not overwrite the statistics of its parent.
+ * This function is called in the child process after every fork if the
+ * KnobLiveStats flag is supplied on the command line.
+ *
+ * @param[in] thread_id Pin id of the forking thread.
+ * @param[in] ctxt Unused.
+ * @param[in] v Unused.
+ */
+VOID AfterForkInChild(const THREADID thread_id, const CONTEXT *ctxt,
+                      VOID *v) {
+  publishing = FALSE;
+}
+
+}  // namespace
+}  // namespace callbacks
+
+VOID PublishLiveStatistics(const string &segment_name,
+                           const UINT32 interval_ms) {
+  // POSIX shared memory objects are named with a single leading slash.
+  const string name =
+      segment_name[0] == '/' ? segment_name : "/" + segment_name;
+  const INT32 fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+  if (fd < 0 || ftruncate(fd, sizeof(LiveStatisticsSegment)) != 0) {
+    cerr << "Could not create the live statistics segment " << name << endl;
+    exit(1);
+  }
+  VOID *mapping = mmap(NULL, sizeof(LiveStatisticsSegment),
+                       PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    cerr << "Could not map the live statistics segment " << name << endl;
+    exit(1);
+  }
+
+  // The segment may be left over from an earlier run, whose statistics must
+  // not be mistaken for these, so it is cleared before it is identified.
+  segment = static_cast<LiveStatisticsSegment *>(mapping);
+  memset(mapping, 0, sizeof(LiveStatisticsSegment));
+  segment->format_version = kLiveStatisticsFormatVersion;
+  segment->max_functions = kMaxLiveStatisticsFunctions;
+  segment->pid = PIN_GetPid();
+  atomic_thread_fence(memory_order_release);
+  memcpy(segment->magic, kLiveStatisticsMagic, sizeof(kLiveStatisticsMagic));
+
+  publishing = TRUE;
+  publish_interval_ms = interval_ms;
+  if (PIN_SpawnInternalThread(callbacks::PublishThread, NULL, 0,
+                              &publish_thread_uid) == INVALID_THREADID) {
+    cerr << "Could not start the live statistics thread" << endl;
+    exit(1);
+  }
+  PIN_AddPrepareForFiniFunction(callbacks::PublishFinalStatistics, NULL);
+  PIN_AddForkFunction(FPOINT_AFTER_IN_CHILD, callbacks::AfterForkInChild,
+                      NULL);
+  INS_AddInstrumentFunction(callbacks::InstrumentationCallback, NULL);
+}
+
+VOID CountReplacedFpOperation(const THREADID thread_id) {
+  if (publishing) {
+    thread_statistics[thread_id].replaced_fp_ops++;
+  }
+}
+
+VOID CountReplacedMathCall(const THREADID thread_id) {
+  if (publishing) {
+    thread_statistics[thread_id].replaced_math_calls++;
+  }
+}
+
+}  // namespace NEAT
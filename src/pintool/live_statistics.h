@@ -0,0 +1,89 @@
+#ifndef PINTOOL_LIVE_STATISTICS_H_
+#define PINTOOL_LIVE_STATISTICS_H_
+
+#include <pin.H>
+
+#include <string>
+
+namespace NEAT {
+
+/// Maximum number of functions whose counts are published.
+const UINT32 kMaxLiveStatisticsFunctions = 256;
+
+/// Opcodes counted apart in the live statistics, in this order.
+const UINT32 kNumLiveStatisticsOpcodes = 4;
+
+/**
+ * Floating-point arithmetic operations executed by a function, as published in
+ * the live statistics segment.
+ */
+struct LiveStatisticsFunction {
+  /// Name of the function, truncated and terminated by a null character.
+  char name[120];
+  UINT64 fp_ops;
+};
+
+/**
+ * Layout of the shared memory segment holding the live statistics. The
+ * segment is written under a sequence lock: sequence is odd while the
+ * statistics are being updated, so readers copy the segment and retry until
+ * sequence is even and unchanged by the copy.
+ */
+struct LiveStatisticsSegment {
+  char magic[8];
+  UINT32 format_version;
+  UINT32 max_functions;
+  volatile UINT64 sequence;
+  UINT64 pid;
+  /// Whether the application has exited, so the statistics are final.
+  UINT64 exited;
+  /// Number of times the statistics were published.
+  UINT64 num_updates;
+  /// Time of the last update in nanoseconds since the epoch.
+  UINT64 update_time_ns;
+  /// Floating-point arithmetic operations executed, in total and per opcode
+  /// (ADDSS, SUBSS, MULSS and DIVSS).
+  UINT64 fp_ops;
+  UINT64 opcode_fp_ops[kNumLiveStatisticsOpcodes];
+  /// Floating-point operations replaced by an FpImplementation.
+  UINT64 replaced_fp_ops;
+  /// Calls of the math library replaced by a MathImplementation.
+  UINT64 replaced_math_calls;
+  /// Whether fp_bits_manipulated and the function counts are published, which
+  /// requires -print_fp_bits_manipulated and -print_function_num_fp_ops.
+  UINT64 has_fp_bits_manipulated;
+  UINT64 has_function_fp_ops;
+  UINT64 fp_bits_manipulated;
+  UINT64 num_functions;
+  LiveStatisticsFunction functions[kMaxLiveStatisticsFunctions];
+};
+
+/**
+ * Instruments an application to count its floating-point arithmetic
+ * operations per thread, and publishes them with the counts of the other
+ * features into a POSIX shared memory segment while the application runs. The
+ * counters of every thread are summed and published by an internal thread, so
+ * the application never waits for the segment. The segment is left in place
+ * when the application exits, holding the final statistics.
+ *
+ * @param[in] segment_name Name of the shared memory segment.
+ * @param[in] interval_ms Time between updates of the segment in milliseconds.
+ */
+VOID PublishLiveStatistics(const string &segment_name,
+                           const UINT32 interval_ms);
+
+/**
+ * Counts a floating-point operation replaced by an FpImplementation on a
+ * thread, if the live statistics are published.
+ */
+VOID CountReplacedFpOperation(const THREADID thread_id);
+
+/**
+ * Counts a call of the math library replaced by a MathImplementation on a
+ * thread, if the live statistics are published.
+ */
+VOID CountReplacedMathCall(const THREADID thread_id);
+
+}  // namespace NEAT
+
+#endif  // PINTOOL_LIVE_STATISTICS_H_
@@ -14,25 +14,83 @@
 #include <iostream>
 #include <string>
 
+#include "client_lib/default_fp_selectors/address_range_fp_selector.h"
+#include "client_lib/default_fp_selectors/config_file_fp_selector.h"
+#include "client_lib/default_fp_selectors/phase_fp_selector.h"
 #include "client_lib/interfaces/fp_selector.h"
+#include "client_lib/interfaces/math_implementation.h"
 #include "client_lib/registry/internal/fp_selector_registry.h"
+#include "client_lib/registry/internal/math_implementation_registry.h"
+#include "client_lib/utils/random.h"
+#include "pintool/error_budget.h"
+#include "pintool/fp_routine_index.h"
+#include "pintool/live_statistics.h"
+#include "pintool/overhead_report.h"
 #include "pintool/print_fp_bits_manipulated.h"
+#include "pintool/print_fp_instruction_addresses.h"
 #include "pintool/print_fp_operations.h"
 #include "pintool/print_function_num_fp_ops.h"
+#include "pintool/process_outputs.h"
+#include "pintool/profile_fp_values.h"
+#include "pintool/profile_snapshots.h"
+#include "pintool/region_of_interest.h"
 #include "pintool/replace_fp_operations.h"
+#include "pintool/replace_math_functions.h"
 
+using NEAT::AddressRangeFpSelector;
+using NEAT::ConfigFileFpSelector;
+using NEAT::FpRoutineIndex;
 using NEAT::FpSelector;
+using NEAT::MathImplementation;
+using NEAT::MonitorErrorBudget;
+using NEAT::OpenProcessOutput;
+using NEAT::PhaseFpSelector;
 using NEAT::PrintFpBitsManipulated;
+using NEAT::PrintFpInstructionAddresses;
 using NEAT::PrintFpOperations;
 using NEAT::PrintFunctionNumFpOps;
+using NEAT::ProfileFpValues;
+using NEAT::PublishLiveStatistics;
+using NEAT::RegionOfInterest;
 using NEAT::ReplaceFpOperations;
+using NEAT::ReplaceMathFunctions;
+using NEAT::ReportOverhead;
+using NEAT::SetRandomSeed;
+using NEAT::SnapshotProfiles;
+using NEAT::UsePerProcessOutputs;
 using NEAT::internal::FpSelectorRegistry;
+using NEAT::internal::MathImplementationRegistry;
 
 KNOB<string> KnobFpSelectorName(KNOB_MODE_OVERWRITE, "pintool",
                                 "fp_selector_name", "",
                                 "specify the name of the FpSelector to use "
                                 "when instrumenting an application");
 
+KNOB<string> KnobFpSelectorConfig(
+    KNOB_MODE_OVERWRITE, "pintool", "fp_selector_config", "",
+    "specify a file mapping the functions of the instrumented application to "
+    "FpImplementations, instead of the name of an FpSelector");
+
+KNOB<string> KnobFpSelectorAddressMap(
+    KNOB_MODE_OVERWRITE, "pintool", "fp_selector_address_map", "",
+    "specify a file mapping address ranges of the images of the instrumented "
+    "application to FpImplementations, instead of the name of an FpSelector");
+
+KNOB<string> KnobFpSelectorPhases(
+    KNOB_MODE_OVERWRITE, "pintool", "fp_selector_phases", "",
+    "specify a file listing phases of the instrumented application, each "
+    "executing natively or with one FpImplementation, instead of the name of "
+    "an FpSelector");
+
+KNOB<string> KnobMathImplementation(
+    KNOB_MODE_OVERWRITE, "pintool", "math_implementation", "",
+    "specify the name of the MathImplementation replacing the single-precision "
+    "functions of the math library, such as expf");
+
+KNOB<UINT64> KnobRandomSeed(KNOB_MODE_OVERWRITE, "pintool", "random_seed", "0",
+                            "specify the seed of the per-thread random number "
+                            "generators used by FpImplementations");
+
 KNOB<string> KnobPrintFpOps(
     KNOB_MODE_OVERWRITE, "pintool", "print_fp_ops", "",
     "print the value of every floating point operation in the instrumented "
@@ -52,6 +110,140 @@ KNOB<string> KnobPrintFunctionNumFpOps(
     "instrumented application to the "
     "specified log file");
 
+KNOB<string> KnobPrintFpInsAddresses(
+    KNOB_MODE_OVERWRITE, "pintool", "print_fp_ins_addresses", "",
+    "print the image offset, function, source line and disassembly of every "
+    "floating point instruction in the instrumented application to the "
+    "specified log file");
+
+KNOB<string> KnobProfileFpValues(
+    KNOB_MODE_OVERWRITE, "pintool", "profile_fp_values", "",
+    "print how often every floating point instruction in the instrumented "
+    "application repeats its operands and results, and its hottest operand "
+    "pairs and results, to the specified log file");
+
+KNOB<UINT32> KnobProfileFpValuesTop(
+    KNOB_MODE_OVERWRITE, "pintool", "profile_fp_values_top", "8",
+    "specify the number of hottest operand pairs and results printed for "
+    "every instruction by -profile_fp_values");
+
+KNOB<UINT64> KnobSamplePeriod(
+    KNOB_MODE_OVERWRITE, "pintool", "sample_period", "1",
+    "only print or count -sample_burst of every -sample_period floating point "
+    "operations of every thread, and scale the counts into estimates");
+
+KNOB<UINT64> KnobSampleBurst(
+    KNOB_MODE_OVERWRITE, "pintool", "sample_burst", "1",
+    "specify the number of consecutive floating point operations sampled in "
+    "every sampling period");
+
+KNOB<BOOL> KnobTraceInstrumentation(
+    KNOB_MODE_OVERWRITE, "pintool", "trace_instrumentation", "0",
+    "instrument traces instead of routines to replace and count floating-point "
+    "operations, including those in code without routine symbols");
+
+KNOB<string> KnobFpRoutineCache(
+    KNOB_MODE_OVERWRITE, "pintool", "fp_routine_cache", "",
+    "specify a directory caching which routines of each image contain "
+    "floating-point instructions, so that instrumentation skips the others");
+
+KNOB<string> KnobRoiStartFunction(
+    KNOB_MODE_OVERWRITE, "pintool", "roi_start_function", "",
+    "only instrument the region of interest of the application, starting "
+    "whenever the specified function is entered");
+
+KNOB<string> KnobRoiEndFunction(
+    KNOB_MODE_OVERWRITE, "pintool", "roi_end_function", "",
+    "end the region of interest whenever the specified function is entered");
+
+KNOB<BOOL> KnobRoiMarkers(
+    KNOB_MODE_OVERWRITE, "pintool", "roi_markers", "0",
+    "only instrument the region of interest of the application, delimited by "
+    "calls to NEAT_RoiBegin and NEAT_RoiEnd from include/neat_roi.h");
+
+KNOB<UINT64> KnobRoiStartIcount(
+    KNOB_MODE_OVERWRITE, "pintool", "roi_start_icount", "0",
+    "only instrument the region of interest of the application, starting "
+    "once the specified number of instructions have executed");
+
+KNOB<UINT64> KnobRoiEndIcount(
+    KNOB_MODE_OVERWRITE, "pintool", "roi_end_icount", "0",
+    "end the region of interest once the specified number of instructions "
+    "have executed");
+
+KNOB<string> KnobOverheadReport(
+    KNOB_MODE_OVERWRITE, "pintool", "overhead_report", "",
+    "print the time spent in instrumentation callbacks, FpImplementations and "
+    "locks, the number of analysis calls of every feature and statistics of "
+    "the code cache to the specified log file when the application exits");
+
+KNOB<UINT64> KnobOverheadProfilePeriod(
+    KNOB_MODE_OVERWRITE, "pintool", "overhead_profile_period", "1000",
+    "time 1 of every -overhead_profile_period replaced floating point "
+    "operations of every thread for the overhead report");
+
+KNOB<string> KnobLiveStats(
+    KNOB_MODE_OVERWRITE, "pintool", "live_stats", "",
+    "publish the floating point operation counts of the instrumented "
+    "application and of the other features to the specified POSIX shared "
+    "memory segment while it runs");
+
+KNOB<UINT32> KnobLiveStatsInterval(
+    KNOB_MODE_OVERWRITE, "pintool", "live_stats_interval", "1000",
+    "specify the time between updates of the -live_stats segment in "
+    "milliseconds");
+
+KNOB<string> KnobSnapshotPrefix(
+    KNOB_MODE_OVERWRITE, "pintool", "snapshot_prefix", "",
+    "periodically write what -print_fp_bits_manipulated and "
+    "-print_function_num_fp_ops counted since the previous snapshot to files "
+    "starting with the specified prefix");
+
+KNOB<UINT32> KnobSnapshotInterval(
+    KNOB_MODE_OVERWRITE, "pintool", "snapshot_interval", "60000",
+    "specify the time between profile snapshots in milliseconds");
+
+KNOB<UINT32> KnobSnapshotsPerFile(
+    KNOB_MODE_OVERWRITE, "pintool", "snapshots_per_file", "60",
+    "specify the number of profile snapshots written to each file");
+
+KNOB<string> KnobErrorBudgetLog(
+    KNOB_MODE_OVERWRITE, "pintool", "error_budget_log", "",
+    "compare sampled replaced floating point operations to their native "
+    "results, fall back to native execution when an error budget is exceeded "
+    "and log the violations and accumulated errors to the specified file");
+
+KNOB<FLT64> KnobErrorBudgetOp(
+    KNOB_MODE_OVERWRITE, "pintool", "error_budget_op", "0",
+    "specify the largest relative error of a single replaced floating point "
+    "operation, or 0 for no limit");
+
+KNOB<FLT64> KnobErrorBudgetTotal(
+    KNOB_MODE_OVERWRITE, "pintool", "error_budget_total", "0",
+    "specify the largest sum of the relative errors of the replaced floating "
+    "point operations, or 0 for no limit");
+
+KNOB<BOOL> KnobErrorBudgetPerFunction(
+    KNOB_MODE_OVERWRITE, "pintool", "error_budget_per_function", "0",
+    "limit the sum of the relative errors per function and only make the "
+    "offending function execute natively");
+
+KNOB<UINT64> KnobErrorBudgetSamplePeriod(
+    KNOB_MODE_OVERWRITE, "pintool", "error_budget_sample_period", "1",
+    "check 1 of every -error_budget_sample_period replaced floating point "
+    "operations of every thread against its native result");
+
+KNOB<BOOL> KnobErrorBudgetStop(
+    KNOB_MODE_OVERWRITE, "pintool", "error_budget_stop", "0",
+    "stop the application at the first violation of an error budget instead "
+    "of falling back to native execution");
+
+KNOB<BOOL> KnobPerProcessOutputs(
+    KNOB_MODE_OVERWRITE, "pintool", "per_process_outputs", "0",
+    "append a dot and the process id to the names of the output files of "
+    "every process, including those that Pin follows across exec with "
+    "-follow_execv; processes forked by the application always do so");
+
 /**
  *  Prints out a help message.
  *
@@ -85,16 +277,185 @@ int main(int argc, char *argv[]) {
     return Usage();
   }
 
+  // If the KnobPerProcessOutputs flag is specified on the command line, every
+  // process writes its own outputs. This must come before any output is
+  // opened.
+  if (KnobPerProcessOutputs.Value()) {
+    UsePerProcessOutputs();
+  }
+
+  // If the KnobOverheadReport flag is specified on the command line, measure
+  // the overhead of NEAT itself. This must come first so that every feature
+  // knows whether to count its analysis calls when it is set up.
+  const string &overhead_report_file_name = KnobOverheadReport.Value();
+  if (!overhead_report_file_name.empty()) {
+    const UINT64 overhead_profile_period = KnobOverheadProfilePeriod.Value();
+    if (overhead_profile_period == 0) {
+      cerr << "-overhead_profile_period must be at least 1" << endl;
+      return Usage();
+    }
+    ofstream *overhead_report_output =
+        OpenProcessOutput(overhead_report_file_name);
+    ReportOverhead(overhead_report_output, overhead_profile_period);
+  }
+
+  // If any of the region of interest flags are specified on the command line,
+  // restrict the instrumentation of every feature to the region of interest.
+  string roi_start_function = KnobRoiStartFunction.Value();
+  string roi_end_function = KnobRoiEndFunction.Value();
+  const UINT64 roi_start_icount = KnobRoiStartIcount.Value();
+  const UINT64 roi_end_icount = KnobRoiEndIcount.Value();
+  if (KnobRoiMarkers.Value()) {
+    if (!roi_start_function.empty() || !roi_end_function.empty()) {
+      cerr << "-roi_markers may not be specified with -roi_start_function or "
+              "-roi_end_function"
+           << endl;
+      return Usage();
+    }
+    roi_start_function = "NEAT_RoiBegin";
+    roi_end_function = "NEAT_RoiEnd";
+  }
+  const BOOL roi_functions =
+      !roi_start_function.empty() || !roi_end_function.empty();
+  const BOOL roi_icounts = roi_start_icount > 0 || roi_end_icount > 0;
+  if (roi_functions && roi_icounts) {
+    cerr << "A region of interest may not be delimited by both functions and "
+            "instruction counts"
+         << endl;
+    return Usage();
+  }
+  if (roi_functions && roi_start_function == roi_end_function) {
+    cerr << "The region of interest must start and end in different functions"
+         << endl;
+    return Usage();
+  }
+  if (roi_end_icount > 0 && roi_end_icount <= roi_start_icount) {
+    cerr << "The region of interest must end after it starts" << endl;
+    return Usage();
+  }
+  if (roi_functions || roi_icounts) {
+    RegionOfInterest(roi_start_function, roi_end_function, roi_start_icount,
+                     roi_end_icount);
+  }
+
+  // If the KnobFpRoutineCache flag is specified on the command line, index
+  // the routines of every image containing floating-point instructions once
+  // and reuse the index in later runs, so that routines without any are never
+  // opened.
+  const string &fp_routine_cache_directory = KnobFpRoutineCache.Value();
+  if (!fp_routine_cache_directory.empty()) {
+    FpRoutineIndex(fp_routine_cache_directory);
+  }
+
+  // If the KnobErrorBudgetLog flag is specified on the command line, check
+  // the replaced floating-point operations against their native results and
+  // fall back to native execution when they exceed the error budgets.
+  const string &error_budget_log_file_name = KnobErrorBudgetLog.Value();
+  const FLT64 max_op_error = KnobErrorBudgetOp.Value();
+  const FLT64 max_total_error = KnobErrorBudgetTotal.Value();
+  if (!(max_op_error >= 0) || !(max_total_error >= 0)) {
+    cerr << "-error_budget_op and -error_budget_total must not be negative"
+         << endl;
+    return Usage();
+  }
+  if (KnobErrorBudgetSamplePeriod.Value() == 0) {
+    cerr << "-error_budget_sample_period must be at least 1" << endl;
+    return Usage();
+  }
+  if (error_budget_log_file_name.empty() &&
+      (max_op_error > 0 || max_total_error > 0)) {
+    cerr << "-error_budget_op and -error_budget_total require "
+            "-error_budget_log"
+         << endl;
+    return Usage();
+  }
+  if (!error_budget_log_file_name.empty()) {
+    MonitorErrorBudget(OpenProcessOutput(error_budget_log_file_name),
+                       max_op_error, max_total_error,
+                       KnobErrorBudgetPerFunction.Value(),
+                       KnobErrorBudgetSamplePeriod.Value(),
+                       KnobErrorBudgetStop.Value());
+  }
+
+  // Seed the per-thread random number generators before any FpImplementation
+  // can draw from them.
+  SetRandomSeed(KnobRandomSeed.Value());
+
+  // If the KnobTraceInstrumentation flag is specified on the command line,
+  // replace and count floating-point operations per trace instead of per
+  // routine.
+  const BOOL use_traces = KnobTraceInstrumentation.Value();
+
   // If the KnobFpSelectorName flag is specified on the command line, attempt to
   // look up the FpSelector from the registry and use it to instrument the
   // application program with a user-defined FP implementation if it is found.
   const FpSelectorRegistry *fp_selector_registry =
       FpSelectorRegistry::GetFpSelectorRegistry();
   const string &fp_selector_name = KnobFpSelectorName.Value();
+  const string &fp_selector_config_file_name = KnobFpSelectorConfig.Value();
+  const string &fp_selector_address_map_file_name =
+      KnobFpSelectorAddressMap.Value();
+  const string &fp_selector_phases_file_name = KnobFpSelectorPhases.Value();
+  if (!fp_selector_name.empty() + !fp_selector_config_file_name.empty() +
+          !fp_selector_address_map_file_name.empty() +
+          !fp_selector_phases_file_name.empty() >
+      1) {
+    cerr << "Only one of -fp_selector_name, -fp_selector_config, "
+            "-fp_selector_address_map and -fp_selector_phases may be specified"
+         << endl;
+    return Usage();
+  }
   if (!fp_selector_name.empty()) {
     FpSelector *fp_selector =
         fp_selector_registry->GetFpSelectorOrDie(fp_selector_name);
-    ReplaceFpOperations(fp_selector);
+    ReplaceFpOperations(fp_selector, use_traces);
+  }
+
+  // If the KnobFpSelectorConfig flag is specified on the command line,
+  // instrument the application program with the FpImplementations that the
+  // config file maps to each function.
+  if (!fp_selector_config_file_name.empty()) {
+    ReplaceFpOperations(new ConfigFileFpSelector(fp_selector_config_file_name),
+                        use_traces);
+  }
+
+  // If the KnobFpSelectorAddressMap flag is specified on the command line,
+  // instrument the application program with the FpImplementations that the
+  // config file maps to each range of instruction addresses.
+  if (!fp_selector_address_map_file_name.empty()) {
+    ReplaceFpOperations(
+        new AddressRangeFpSelector(fp_selector_address_map_file_name),
+        use_traces);
+  }
+
+  // If the KnobFpSelectorPhases flag is specified on the command line,
+  // instrument the application program to switch between the
+  // FpImplementations of each phase, executing natively where none is used.
+  if (!fp_selector_phases_file_name.empty()) {
+    ReplaceFpOperations(new PhaseFpSelector(fp_selector_phases_file_name),
+                        use_traces);
+  }
+
+  // If the KnobMathImplementation flag is specified on the command line,
+  // replace whole functions of the math library with the MathImplementation
+  // registered under that name.
+  const string &math_implementation_name = KnobMathImplementation.Value();
+  if (!math_implementation_name.empty()) {
+    MathImplementation *math_implementation =
+        MathImplementationRegistry::GetMathImplementationRegistry()
+            ->GetMathImplementationOrDie(math_implementation_name);
+    ReplaceMathFunctions(math_implementation);
+  }
+
+  // Each tracing or profiling feature samples floating-point operations
+  // independently, which records every operation unless KnobSamplePeriod is
+  // specified on the command line.
+  const UINT64 sample_period = KnobSamplePeriod.Value();
+  const UINT64 sample_burst = KnobSampleBurst.Value();
+  if (sample_period == 0 || sample_burst == 0 ||
+      sample_burst > sample_period) {
+    cerr << "-sample_burst must be between 1 and -sample_period" << endl;
+    return Usage();
   }
 
   // If the KnobPrintFpOps flag is specified on the command line, instrument the
@@ -102,9 +463,8 @@ int main(int argc, char *argv[]) {
   // formatted as 8 digit hex numbers padded with 0's to a file.
   const string &print_fp_ops_file_name = KnobPrintFpOps.Value();
   if (!print_fp_ops_file_name.empty()) {
-    ofstream *print_fp_ops_output =
-        new ofstream(print_fp_ops_file_name.c_str());
-    PrintFpOperations(print_fp_ops_output);
+    ofstream *print_fp_ops_output = OpenProcessOutput(print_fp_ops_file_name);
+    PrintFpOperations(print_fp_ops_output, sample_period, sample_burst);
   }
 
   // If the KnobPrintFpBitsManipulated flag is specified on the command line,
@@ -112,9 +472,8 @@ int main(int argc, char *argv[]) {
   // manipulated in every floating-point operation.
   const string &print_fp_bits_file_name = KnobPrintFpBitsManipulated.Value();
   if (!print_fp_bits_file_name.empty()) {
-    ofstream *print_fp_bits_output =
-        new ofstream(print_fp_bits_file_name.c_str());
-    PrintFpBitsManipulated(print_fp_bits_output);
+    ofstream *print_fp_bits_output = OpenProcessOutput(print_fp_bits_file_name);
+    PrintFpBitsManipulated(print_fp_bits_output, sample_period, sample_burst);
   }
 
   // If the KnobPrintFunctionNumFpOps flag is specified on the command line,
@@ -124,8 +483,64 @@ int main(int argc, char *argv[]) {
       KnobPrintFunctionNumFpOps.Value();
   if (!print_function_num_fp_ops_file_name.empty()) {
     ofstream *print_function_num_fp_ops_output =
-        new ofstream(print_function_num_fp_ops_file_name.c_str());
-    PrintFunctionNumFpOps(print_function_num_fp_ops_output);
+        OpenProcessOutput(print_function_num_fp_ops_file_name);
+    PrintFunctionNumFpOps(print_function_num_fp_ops_output, sample_period,
+                          sample_burst, use_traces);
+  }
+
+  // If the KnobPrintFpInsAddresses flag is specified on the command line, print
+  // where every floating-point instruction of the application program is, to
+  // help write config files for -fp_selector_address_map.
+  const string &print_fp_ins_addresses_file_name =
+      KnobPrintFpInsAddresses.Value();
+  if (!print_fp_ins_addresses_file_name.empty()) {
+    ofstream *print_fp_ins_addresses_output =
+        OpenProcessOutput(print_fp_ins_addresses_file_name);
+    PrintFpInstructionAddresses(print_fp_ins_addresses_output);
+  }
+
+  // If the KnobProfileFpValues flag is specified on the command line,
+  // instrument the application program to profile the operand and result
+  // values of every floating-point instruction, to find where memoization
+  // would pay off.
+  const string &profile_fp_values_file_name = KnobProfileFpValues.Value();
+  if (!profile_fp_values_file_name.empty()) {
+    if (KnobProfileFpValuesTop.Value() == 0) {
+      cerr << "-profile_fp_values_top must be at least 1" << endl;
+      return Usage();
+    }
+    ofstream *profile_fp_values_output =
+        OpenProcessOutput(profile_fp_values_file_name);
+    ProfileFpValues(profile_fp_values_output, KnobProfileFpValuesTop.Value(),
+                    sample_period, sample_burst);
+  }
+
+  // If the KnobLiveStats flag is specified on the command line, count the
+  // floating-point operations of the application and publish them with the
+  // counts of the features above while it runs.
+  const string &live_stats_segment_name = KnobLiveStats.Value();
+  if (!live_stats_segment_name.empty()) {
+    if (KnobLiveStatsInterval.Value() == 0) {
+      cerr << "-live_stats_interval must be at least 1" << endl;
+      return Usage();
+    }
+    PublishLiveStatistics(live_stats_segment_name,
+                          KnobLiveStatsInterval.Value());
+  }
+
+  // If the KnobSnapshotPrefix flag is specified on the command line,
+  // periodically save the profiles counted so far, so that they survive the
+  // application crashing or being killed.
+  const string &snapshot_prefix = KnobSnapshotPrefix.Value();
+  if (!snapshot_prefix.empty()) {
+    if (KnobSnapshotInterval.Value() == 0 ||
+        KnobSnapshotsPerFile.Value() == 0) {
+      cerr << "-snapshot_interval and -snapshots_per_file must be at least 1"
+           << endl;
+      return Usage();
+    }
+    SnapshotProfiles(snapshot_prefix, KnobSnapshotInterval.Value(),
+                     KnobSnapshotsPerFile.Value());
   }
 
   // Start the program, never returns.
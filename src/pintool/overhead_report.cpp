@@ -0,0 +1,397 @@
+#include "pintool/overhead_report.h"
+
+#include <pin.H>
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/interfaces/fp_selector.h"
+#include "client_lib/utils/fp_operation.h"
+#include "pintool/process_outputs.h"
+
+namespace NEAT {
+namespace {
+
+/// Names of the instrumentation callbacks, indexed by OverheadCallback.
+const char *const kCallbackNames[kNumOverheadCallbacks] = {
+    "replace_fp_ops routine",
+    "replace_fp_ops trace",
+    "math_implementation image",
+    "print_fp_ops instruction",
+    "print_fp_bits_manipulated instruction",
+    "print_function_num_fp_ops routine",
+    "print_function_num_fp_ops trace",
+    "print_fp_ins_addresses routine",
+    "region_of_interest trace",
+    "live_stats instruction",
+    "profile_fp_values instruction"};
+
+/// Names of the features, indexed by OverheadFeature.
+const char *const kFeatureNames[kNumOverheadFeatures] = {
+    "replace_fp_ops",
+    "math_implementation",
+    "print_fp_ops",
+    "print_fp_bits_manipulated",
+    "print_function_num_fp_ops",
+    "region_of_interest",
+    "live_stats",
+    "profile_fp_values"};
+
+/// Names of the mutexes, indexed by OverheadMutex.
+const char *const kMutexNames[kNumOverheadMutexes] = {
+    "pass_through",
+    "print_fp_ops",
+    "print_fp_bits_manipulated",
+    "print_function_num_fp_ops",
+    "region_of_interest",
+    "error_budget"};
+
+/// Number of FpImplementations whose operations each thread profiles apart.
+const UINT32 kMaxProfiledFpImplementations = 8;
+
+/// Time spent on the profiled operations of an FpImplementation.
+struct FpImplementationProfile {
+  /// The FpImplementation, or NULL for all FpImplementations not profiled
+  /// apart.
+  FpImplementation *fp_implementation;
+  UINT64 num_operations;
+  /// Number of the operations whose FpImplementation was selected by the
+  /// FpSelector, rather than once when the instruction was instrumented.
+  UINT64 num_selections;
+  UINT64 select_ns;
+  UINT64 perform_ns;
+};
+
+/**
+ * The overhead measured on a single thread, padded to a cache line so that
+ * threads never share one.
+ */
+struct alignas(64) ThreadOverhead {
+  UINT64 callback_calls[kNumOverheadCallbacks];
+  UINT64 callback_ns[kNumOverheadCallbacks];
+  UINT64 analysis_calls[kNumOverheadFeatures];
+  UINT64 mutex_contentions[kNumOverheadMutexes];
+  UINT64 mutex_wait_ns[kNumOverheadMutexes];
+  /// Number of replaced operations left before the next profiled one.
+  UINT64 fp_ops_until_profile;
+  FpImplementationProfile fp_implementation_profiles
+      [kMaxProfiledFpImplementations];
+  FpImplementationProfile other_fp_implementations_profile;
+};
+
+/// The overhead measured on every thread.
+ThreadOverhead thread_overheads[PIN_MAX_THREADS];
+
+/// Whether the overhead is measured.
+BOOL overhead_report_enabled = FALSE;
+
+/// Number of replaced operations of each thread for every profiled one.
+UINT64 profile_period = 1;
+
+/**
+ * Number of traces inserted into and flushes of the code cache. Pin runs the
+ * code cache callbacks while holding its own lock, so they are not counted per
+ * thread.
+ */
+UINT64 code_cache_traces_inserted = 0;
+UINT64 code_cache_flushes = 0;
+
+/**
+ * Returns the time of a monotonic clock in nanoseconds.
+ */
+UINT64 NowNs() {
+  return chrono::duration_cast<chrono::nanoseconds>(
+             chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * Returns the overhead measured on a thread. Callbacks running outside of any
+ * application thread are accounted to the first one, which is safe since
+ * instrumentation callbacks never run concurrently.
+ */
+ThreadOverhead &GetThreadOverhead(const THREADID thread_id) {
+  return thread_overheads[thread_id == INVALID_THREADID ? 0 : thread_id];
+}
+
+/**
+ * Returns the profile of an FpImplementation on a thread.
+ */
+FpImplementationProfile &GetFpImplementationProfile(
+    ThreadOverhead &overhead, FpImplementation *fp_implementation) {
+  for (UINT32 i = 0; i < kMaxProfiledFpImplementations; i++) {
+    FpImplementationProfile &profile = overhead.fp_implementation_profiles[i];
+    if (profile.fp_implementation == fp_implementation) {
+      return profile;
+    }
+    if (profile.fp_implementation == NULL) {
+      profile.fp_implementation = fp_implementation;
+      return profile;
+    }
+  }
+  return overhead.other_fp_implementations_profile;
+}
+
+/**
+ * Adds a profile to the totals of its FpImplementation.
+ */
+VOID AddFpImplementationProfile(
+    const FpImplementationProfile &profile,
+    map<FpImplementation *, FpImplementationProfile> *totals) {
+  if (profile.num_operations == 0) {
+    return;
+  }
+  FpImplementationProfile &total = (*totals)[profile.fp_implementation];
+  total.fp_implementation = profile.fp_implementation;
+  total.num_operations += profile.num_operations;
+  total.num_selections += profile.num_selections;
+  total.select_ns += profile.select_ns;
+  total.perform_ns += profile.perform_ns;
+}
+
+}  // namespace
+
+namespace analysis {
+namespace {
+
+/**
+ * Counts analysis calls of a feature. This function is simple enough for Pin
+ * to inline it.
+ * This function is called before every instruction instrumented by a feature
+ * while the overhead report is enabled.
+ *
+ * @param[in] thread_id Pin id of the thread executing the instruction.
+ * @param[in] feature The feature that instrumented the instruction.
+ * @param[in] num_calls Number of analysis calls made for the instruction.
+ */
+VOID CountFeatureAnalysisCalls(const THREADID thread_id, const UINT32 feature,
+                               const UINT32 num_calls) {
+  thread_overheads[thread_id].analysis_calls[feature] += num_calls;
+}
+
+}  // namespace
+}  // namespace analysis
+
+namespace callbacks {
+namespace {
+
+/**
+ * Counts a trace inserted into the code cache.
+ * This function is called every time Pin inserts a trace into the code cache.
+ *
+ * @param[in] trace The inserted trace.
+ * @param[in] v Unused.
+ */
+VOID CountInsertedTrace(const TRACE trace, VOID *v) {
+  code_cache_traces_inserted++;
+}
+
+/**
+ * Counts a flush of the code cache.
+ * This function is called every time Pin flushes the code cache.
+ */
+VOID CountCodeCacheFlush() { code_cache_flushes++; }
+
+/**
+ * Sums the overhead measured on every thread and writes the report.
+ * This function is called when the application exits.
+ *
+ * @param[in] code OS specific termination code for the application.
+ * @param[in,out] output The file to write the report to.
+ */
+VOID PrintReport(const INT32 code, ofstream *output) {
+  ThreadOverhead total = {};
+  map<FpImplementation *, FpImplementationProfile> fp_implementation_totals;
+  for (UINT32 thread_id = 0; thread_id < PIN_MAX_THREADS; thread_id++) {
+    const ThreadOverhead &overhead = thread_overheads[thread_id];
+    for (UINT32 i = 0; i < kNumOverheadCallbacks; i++) {
+      total.callback_calls[i] += overhead.callback_calls[i];
+      total.callback_ns[i] += overhead.callback_ns[i];
+    }
+    for (UINT32 i = 0; i < kNumOverheadFeatures; i++) {
+      total.analysis_calls[i] += overhead.analysis_calls[i];
+    }
+    for (UINT32 i = 0; i < kNumOverheadMutexes; i++) {
+      total.mutex_contentions[i] += overhead.mutex_contentions[i];
+      total.mutex_wait_ns[i] += overhead.mutex_wait_ns[i];
+    }
+    for (const FpImplementationProfile &profile :
+         overhead.fp_implementation_profiles) {
+      AddFpImplementationProfile(profile, &fp_implementation_totals);
+    }
+    AddFpImplementationProfile(overhead.other_fp_implementations_profile,
+                               &fp_implementation_totals);
+  }
+
+  *output << fixed << setprecision(3);
+  *output << "# instrumentation callbacks: name, calls, milliseconds" << endl;
+  for (UINT32 i = 0; i < kNumOverheadCallbacks; i++) {
+    if (total.callback_calls[i] > 0) {
+      *output << kCallbackNames[i] << ", " << total.callback_calls[i] << ", "
+              << total.callback_ns[i] / 1e6 << endl;
+    }
+  }
+  *output << "# analysis calls: feature, calls" << endl;
+  for (UINT32 i = 0; i < kNumOverheadFeatures; i++) {
+    if (total.analysis_calls[i] > 0) {
+      *output << kFeatureNames[i] << ", " << total.analysis_calls[i] << endl;
+    }
+  }
+  *output << "# FpImplementations, 1 in " << profile_period
+          << " replaced operations timed: FpImplementation, timed "
+             "operations, mean select ns, mean perform ns"
+          << endl;
+  for (const auto &entry : fp_implementation_totals) {
+    const FpImplementationProfile &profile = entry.second;
+    *output << (profile.fp_implementation == NULL
+                    ? string("other")
+                    : hexstr(reinterpret_cast<ADDRINT>(
+                          profile.fp_implementation)))
+            << ", " << profile.num_operations << ", "
+            << (profile.num_selections == 0
+                    ? 0.0
+                    : static_cast<FLT64>(profile.select_ns) /
+                          profile.num_selections)
+            << ", "
+            << static_cast<FLT64>(profile.perform_ns) / profile.num_operations
+            << endl;
+  }
+  *output << "# mutex waits: mutex, contended acquisitions, milliseconds"
+          << endl;
+  for (UINT32 i = 0; i < kNumOverheadMutexes; i++) {
+    if (total.mutex_contentions[i] > 0) {
+      *output << kMutexNames[i] << ", " << total.mutex_contentions[i] << ", "
+              << total.mutex_wait_ns[i] / 1e6 << endl;
+    }
+  }
+  *output << "# code cache" << endl;
+  *output << "traces inserted, " << code_cache_traces_inserted << endl;
+  *output << "flushes, " << code_cache_flushes << endl;
+  *output << "traces in cache, " << CODECACHE_NumTracesInCache() << endl;
+  *output << "bytes used, " << CODECACHE_CodeMemUsed() << endl;
+  *output << "bytes reserved, " << CODECACHE_CodeMemReserved() << endl;
+  *output << "size limit, " << CODECACHE_CacheSizeLimit() << endl;
+  output->close();
+  delete output;
+}
+
+/**
+ * Makes the forked process report only its own overhead.
+ * This function is called in the child process after every fork if the
+ * KnobOverheadReport flag is supplied on the command line.
+ *
+ * @param[in] output Unused.
+ */
+VOID ResetAfterFork(ofstream *output) {
+  for (ThreadOverhead &overhead : thread_overheads) {
+    overhead = ThreadOverhead();
+  }
+  code_cache_traces_inserted = 0;
+  code_cache_flushes = 0;
+}
+
+}  // namespace
+}  // namespace callbacks
+
+VOID ReportOverhead(ofstream *output, const UINT64 fp_op_profile_period) {
+  overhead_report_enabled = TRUE;
+  profile_period = fp_op_profile_period;
+  CODECACHE_AddTraceInsertedFunction(callbacks::CountInsertedTrace, NULL);
+  CODECACHE_AddCacheFlushedFunction(callbacks::CountCodeCacheFlush, NULL);
+  PIN_AddFiniFunction(
+      reinterpret_cast<FINI_CALLBACK>(callbacks::PrintReport), output);
+  RegisterProcessOutput(output, NULL, callbacks::ResetAfterFork);
+}
+
+BOOL IsOverheadReportEnabled() { return overhead_report_enabled; }
+
+OverheadCallbackTimer::OverheadCallbackTimer(const OverheadCallback callback)
+    : callback_(callback), start_ns_(overhead_report_enabled ? NowNs() : 0) {}
+
+OverheadCallbackTimer::~OverheadCallbackTimer() {
+  if (start_ns_ == 0) {
+    return;
+  }
+  ThreadOverhead &overhead = GetThreadOverhead(PIN_ThreadId());
+  overhead.callback_calls[callback_]++;
+  overhead.callback_ns[callback_] += NowNs() - start_ns_;
+}
+
+VOID CountAnalysisCalls(const INS ins, const OverheadFeature feature,
+                        const UINT32 num_calls) {
+  if (!overhead_report_enabled) {
+    return;
+  }
+  // clang-format off
+  INS_InsertCall(
+      ins, IPOINT_BEFORE,
+      reinterpret_cast<AFUNPTR>(analysis::CountFeatureAnalysisCalls),
+      IARG_THREAD_ID,
+      IARG_UINT32, feature,
+      IARG_UINT32, num_calls,
+      IARG_CALL_ORDER, CALL_ORDER_FIRST,
+      IARG_END);
+  // clang-format on
+}
+
+VOID CountAnalysisCall(const THREADID thread_id,
+                       const OverheadFeature feature) {
+  if (overhead_report_enabled) {
+    thread_overheads[thread_id].analysis_calls[feature]++;
+  }
+}
+
+VOID LockMutex(PIN_MUTEX *mutex, const OverheadMutex overhead_mutex) {
+  if (!overhead_report_enabled) {
+    PIN_MutexLock(mutex);
+    return;
+  }
+  // Uncontended acquisitions cost no more than without the report.
+  if (PIN_MutexTryLock(mutex)) {
+    return;
+  }
+  const UINT64 start_ns = NowNs();
+  PIN_MutexLock(mutex);
+  ThreadOverhead &overhead = GetThreadOverhead(PIN_ThreadId());
+  overhead.mutex_contentions[overhead_mutex]++;
+  overhead.mutex_wait_ns[overhead_mutex] += NowNs() - start_ns;
+}
+
+BOOL ProfileNextFpOperation(const THREADID thread_id) {
+  UINT64 &fp_ops_until_profile =
+      thread_overheads[thread_id].fp_ops_until_profile;
+  if (fp_ops_until_profile > 0) {
+    fp_ops_until_profile--;
+    return FALSE;
+  }
+  fp_ops_until_profile = profile_period - 1;
+  return TRUE;
+}
+
+FLT32 PerformProfiledFpOperation(const FpOperation &operation,
+                                 FpSelector *fp_selector,
+                                 FpImplementation *fp_implementation) {
+  const UINT64 select_start_ns = NowNs();
+  const BOOL selected = fp_implementation == NULL;
+  if (selected) {
+    fp_implementation = fp_selector->SelectFpImplementation(operation);
+  }
+  const UINT64 perform_start_ns = NowNs();
+  const FLT32 result = fp_implementation->PerformOperation(operation);
+  const UINT64 end_ns = NowNs();
+
+  FpImplementationProfile &profile = GetFpImplementationProfile(
+      thread_overheads[operation.thread_id], fp_implementation);
+  profile.num_operations++;
+  profile.perform_ns += end_ns - perform_start_ns;
+  if (selected) {
+    profile.num_selections++;
+    profile.select_ns += perform_start_ns - select_start_ns;
+  }
+  return result;
+}
+
+}  // namespace NEAT
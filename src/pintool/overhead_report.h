@@ -0,0 +1,142 @@
+#ifndef PINTOOL_OVERHEAD_REPORT_H_
+#define PINTOOL_OVERHEAD_REPORT_H_
+
+#include <pin.H>
+
+#include <fstream>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/interfaces/fp_selector.h"
+#include "client_lib/utils/fp_operation.h"
+
+namespace NEAT {
+
+/// Instrumentation callbacks whose time is reported.
+enum OverheadCallback {
+  kReplaceRoutineCallback,
+  kReplaceTraceCallback,
+  kReplaceMathImageCallback,
+  kPrintFpOpsCallback,
+  kPrintFpBitsCallback,
+  kPrintFunctionFpOpsRoutineCallback,
+  kPrintFunctionFpOpsTraceCallback,
+  kPrintFpInsAddressesCallback,
+  kRegionOfInterestCallback,
+  kLiveStatisticsCallback,
+  kProfileFpValuesCallback,
+  kNumOverheadCallbacks
+};
+
+/// Features whose analysis calls are counted.
+enum OverheadFeature {
+  kReplaceFpOpsFeature,
+  kReplaceMathFunctionsFeature,
+  kPrintFpOpsFeature,
+  kPrintFpBitsFeature,
+  kPrintFunctionFpOpsFeature,
+  kRegionOfInterestFeature,
+  kLiveStatisticsFeature,
+  kProfileFpValuesFeature,
+  kNumOverheadFeatures
+};
+
+/// Mutexes whose wait time is reported.
+enum OverheadMutex {
+  kPassThroughMutex,
+  kPrintFpOpsMutex,
+  kPrintFpBitsMutex,
+  kPrintFunctionFpOpsMutex,
+  kRegionOfInterestMutex,
+  kErrorBudgetMutex,
+  kNumOverheadMutexes
+};
+
+/**
+ * Makes NEAT report its own overhead to a file when the application exits:
+ * the time spent in each instrumentation callback, the number of analysis
+ * calls of each feature, the time spent selecting and performing sampled
+ * floating-point operations per FpImplementation, the time spent waiting for
+ * each mutex and statistics of the Pin code cache. Every measurement is
+ * accumulated per thread, and nothing is measured unless this function is
+ * called before the application starts.
+ *
+ * @param[in] output The file to write the report to.
+ * @param[in] fp_op_profile_period Number of replaced floating-point operations
+ *     of each thread for every operation that is timed, at least 1.
+ */
+VOID ReportOverhead(ofstream *output, const UINT64 fp_op_profile_period);
+
+/**
+ * Returns whether NEAT reports its overhead. Features must check it before
+ * the application starts, and only count analysis calls or profile
+ * operations if it is set.
+ */
+BOOL IsOverheadReportEnabled();
+
+/**
+ * Times an instrumentation callback for the overhead report from its
+ * construction to its destruction.
+ */
+class OverheadCallbackTimer {
+ public:
+  explicit OverheadCallbackTimer(const OverheadCallback callback);
+
+  ~OverheadCallbackTimer();
+
+ private:
+  OverheadCallback callback_;
+  /// Time at construction in nanoseconds, or 0 if the report is disabled.
+  UINT64 start_ns_;
+};
+
+/**
+ * Inserts an analysis routine that Pin inlines before an instruction to count
+ * the analysis calls a feature inserted for it. Does nothing if the overhead
+ * report is disabled.
+ *
+ * @param[in] ins The instrumented instruction.
+ * @param[in] feature The feature that instrumented the instruction.
+ * @param[in] num_calls Number of analysis routines the feature inserted that
+ *     run on every execution of the instruction.
+ */
+VOID CountAnalysisCalls(const INS ins, const OverheadFeature feature,
+                        const UINT32 num_calls);
+
+/**
+ * Counts an analysis call of a feature made by a thread, from an analysis
+ * routine that cannot have another one inserted before it.
+ */
+VOID CountAnalysisCall(const THREADID thread_id,
+                       const OverheadFeature feature);
+
+/**
+ * Locks a mutex, recording how long the calling thread waited for it if the
+ * overhead report is enabled.
+ */
+VOID LockMutex(PIN_MUTEX *mutex, const OverheadMutex overhead_mutex);
+
+/**
+ * Moves a thread on to its next replaced floating-point operation and returns
+ * whether the operation should be profiled with PerformProfiledFpOperation.
+ * The overhead report must be enabled.
+ */
+BOOL ProfileNextFpOperation(const THREADID thread_id);
+
+/**
+ * Returns the result of a floating-point operation computed by an
+ * FpImplementation, timing its selection and its execution.
+ *
+ * @param[in] operation The floating-point operation.
+ * @param[in,out] fp_selector Floating-point selector which selects the
+ *     floating-point implementation to use.
+ * @param[in,out] fp_implementation Floating-point implementation selected for
+ *     every execution of the instruction, or NULL to select one with
+ *     fp_selector.
+ */
+FLT32 PerformProfiledFpOperation(const FpOperation &operation,
+                                 FpSelector *fp_selector,
+                                 FpImplementation *fp_implementation);
+
+}  // namespace NEAT
+
+#endif  // PINTOOL_OVERHEAD_REPORT_H_
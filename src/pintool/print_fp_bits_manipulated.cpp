@@ -4,8 +4,13 @@
 
 #include <strings.h>
 
+#include <cmath>
 #include <fstream>
 
+#include "pintool/fp_op_sampler.h"
+#include "pintool/overhead_report.h"
+#include "pintool/process_outputs.h"
+#include "pintool/region_of_interest.h"
 #include "pintool/utils.h"
 
 namespace NEAT {
@@ -25,6 +30,18 @@ UINT64 fp_bits_manipulated = 0;
  */
 PIN_MUTEX fp_bits_manipulated_lock;
 
+/**
+ * Sum of the squares of the numbers of bits counted for every floating-point
+ * value, used to estimate the precision of the total when sampling.
+ */
+UINT64 fp_bits_manipulated_squares = 0;
+
+/// Decides which floating-point operations are counted.
+FpOpSampler fp_op_sampler;
+
+/// Whether the bits manipulated are counted and not yet printed.
+BOOL counting_fp_bits_manipulated = FALSE;
+
 /**
  * Counts the number of bits used in the matissa of the supplied floating-point
  * number and adds the number to a running total.
@@ -41,8 +58,10 @@ VOID CountFpMantissaBits(FLT32 flt) {
   // mantissa, and we need to subtract this number from 24 because it is
   // 1-indexed.
   if (bits != 0) {
-    PIN_MutexLock(&fp_bits_manipulated_lock);
-    fp_bits_manipulated += 24 - ffs(bits);
+    LockMutex(&fp_bits_manipulated_lock, kPrintFpBitsMutex);
+    const UINT64 num_bits = 24 - ffs(bits);
+    fp_bits_manipulated += num_bits;
+    fp_bits_manipulated_squares += num_bits * num_bits;
     PIN_MutexUnlock(&fp_bits_manipulated_lock);
   }
 }
@@ -119,7 +138,20 @@ namespace {
  * @param[in,out] output The output file to use.
  */
 VOID PrintToFile(const INT32 code, ofstream *output) {
-  *output << fp_bits_manipulated << endl;
+  counting_fp_bits_manipulated = FALSE;
+  if (fp_op_sampler.IsSampling()) {
+    // Print the estimated total and the half-width of its 95% confidence
+    // interval.
+    *output << fp_op_sampler.GetDescription() << endl;
+    *output << static_cast<UINT64>(llround(fp_bits_manipulated *
+                                           fp_op_sampler.GetScalingFactor()))
+            << " "
+            << static_cast<UINT64>(llround(fp_op_sampler.GetConfidenceInterval(
+                   fp_bits_manipulated_squares)))
+            << endl;
+  } else {
+    *output << fp_bits_manipulated << endl;
+  }
   output->close();
   delete output;
   PIN_MutexFini(&fp_bits_manipulated_lock);
@@ -136,50 +168,94 @@ VOID PrintToFile(const INT32 code, ofstream *output) {
  * @param[in] output The output file to write to.
  */
 VOID InstrumentationCallback(const INS ins, ofstream *output) {
+  const OverheadCallbackTimer timer(kPrintFpBitsCallback);
+  if (!IsInRegionOfInterest()) {
+    return;
+  }
+
   if (IsFpInstruction(ins)) {
+    IARGLIST operand_args = IARGLIST_Alloc();
+    AFUNPTR count_operand_bits;
     if (INS_OperandIsReg(ins, 1)) {
+      count_operand_bits =
+          reinterpret_cast<AFUNPTR>(analysis::CountRegisterFpOperandBits);
       // clang-format off
-      INS_InsertCall(
-          ins, IPOINT_BEFORE,
-          reinterpret_cast<AFUNPTR>(analysis::CountRegisterFpOperandBits),
+      IARGLIST_AddArguments(
+          operand_args,
           IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 0),
           IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 1),
-          IARG_CALL_ORDER, CALL_ORDER_FIRST,
           IARG_END);
       // clang-format on
     } else {
+      count_operand_bits =
+          reinterpret_cast<AFUNPTR>(analysis::CountMemoryFpOperandBits);
       // clang-format off
-      INS_InsertCall(
-          ins, IPOINT_BEFORE,
-          reinterpret_cast<AFUNPTR>(analysis::CountMemoryFpOperandBits),
+      IARGLIST_AddArguments(
+          operand_args,
           IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 0),
           IARG_MEMORYREAD_EA,
-          IARG_CALL_ORDER, CALL_ORDER_FIRST,
           IARG_END);
       // clang-format on
     }
+    fp_op_sampler.InsertCall(ins, IPOINT_BEFORE, CALL_ORDER_FIRST, TRUE,
+                             count_operand_bits, operand_args);
+    IARGLIST_Free(operand_args);
 
+    IARGLIST result_args = IARGLIST_Alloc();
     // clang-format off
-    INS_InsertCall(
-        ins, IPOINT_AFTER,
-        reinterpret_cast<AFUNPTR>(analysis::CountFpResultBits),
+    IARGLIST_AddArguments(
+        result_args,
         IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 0),
         IARG_END);
     // clang-format on
+    fp_op_sampler.InsertCall(
+        ins, IPOINT_AFTER, CALL_ORDER_DEFAULT, FALSE,
+        reinterpret_cast<AFUNPTR>(analysis::CountFpResultBits), result_args);
+    IARGLIST_Free(result_args);
+    CountAnalysisCalls(ins, kPrintFpBitsFeature, 2);
   }
 }
 
+/**
+ * Makes the forked process count only the bits it manipulates.
+ * This function is called in the child process after every fork if the
+ * KnobPrintFpBitsManipulated flag is supplied on the command line.
+ *
+ * @param[in] output Unused.
+ */
+VOID ResetAfterFork(ofstream *output) {
+  fp_bits_manipulated = 0;
+  fp_bits_manipulated_squares = 0;
+}
+
 }  // namespace
 }  // namespace callbacks
 
-VOID PrintFpBitsManipulated(ofstream *output) {
+VOID PrintFpBitsManipulated(ofstream *output, const UINT64 sample_period,
+                            const UINT64 sample_burst) {
   PIN_MutexInit(&fp_bits_manipulated_lock);
+  fp_op_sampler.SetSampling(sample_period, sample_burst);
+  counting_fp_bits_manipulated = TRUE;
 
   PIN_AddFiniFunction(reinterpret_cast<FINI_CALLBACK>(callbacks::PrintToFile),
                       output);
+  RegisterProcessOutput(output, &fp_bits_manipulated_lock,
+                        callbacks::ResetAfterFork);
   INS_AddInstrumentFunction(reinterpret_cast<INS_INSTRUMENT_CALLBACK>(
                                 callbacks::InstrumentationCallback),
                             output);
 }
 
+BOOL GetFpBitsManipulated(UINT64 *fp_bits_manipulated_so_far) {
+  if (!counting_fp_bits_manipulated) {
+    return FALSE;
+  }
+  PIN_MutexLock(&fp_bits_manipulated_lock);
+  const UINT64 count = fp_bits_manipulated;
+  PIN_MutexUnlock(&fp_bits_manipulated_lock);
+  *fp_bits_manipulated_so_far = static_cast<UINT64>(
+      llround(count * fp_op_sampler.GetScalingFactor()));
+  return TRUE;
+}
+
 }  // namespace NEAT
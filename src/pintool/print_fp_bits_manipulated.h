@@ -12,8 +12,23 @@ namespace NEAT {
  * manipulated in every floating-point arithmetic operation in the application.
  *
  * @param[in] output The output file to write to.
+ * @param[in] sample_period Number of floating-point operations in every
+ *     sampling period of every thread.
+ * @param[in] sample_burst Number of floating-point operations counted in every
+ *     sampling period, all of them if it equals sample_period.
  */
-VOID PrintFpBitsManipulated(ofstream *output);
+VOID PrintFpBitsManipulated(ofstream *output, const UINT64 sample_period,
+                            const UINT64 sample_burst);
+
+/**
+ * Gets the number of bits manipulated so far while the application runs,
+ * estimated from the sampled operations if sampling.
+ *
+ * @param[out] fp_bits_manipulated The number of bits manipulated.
+ * @return Whether the bits manipulated are counted, which is only the case
+ *     after PrintFpBitsManipulated is called and until the application exits.
+ */
+BOOL GetFpBitsManipulated(UINT64 *fp_bits_manipulated);
 
 }  // namespace NEAT
 
@@ -0,0 +1,87 @@
+#include "pintool/print_fp_instruction_addresses.h"
+
+#include <pin.H>
+
+#include <fstream>
+#include <string>
+
+#include "pintool/overhead_report.h"
+#include "pintool/process_outputs.h"
+#include "pintool/utils.h"
+
+namespace NEAT {
+namespace callbacks {
+namespace {
+
+/**
+ * Closes the output file.
+ * This function is called immediately before the instrumented application
+ * exits if the KnobPrintFpInsAddresses flag is supplied on the command line.
+ *
+ * @param[in] code Exit code of the pintool.
+ * @param[in,out] output The output file to use.
+ */
+VOID CloseFile(const INT32 code, ofstream *output) {
+  output->close();
+  delete output;
+}
+
+/**
+ * Prints one tab-separated line for every floating-point arithmetic
+ * instruction of a routine: the file name of its image, its offset in the
+ * image, the routine name, its source location and its disassembly.
+ * This function is called every time a new routine is encountered, before
+ * the instrumented application is run if the KnobPrintFpInsAddresses flag is
+ * supplied on the command line.
+ *
+ * @param[in] rtn Routine to be instrumented.
+ * @param[in] output The output file to write to.
+ */
+VOID InstrumentationCallback(const RTN rtn, ofstream *output) {
+  const OverheadCallbackTimer timer(kPrintFpInsAddressesCallback);
+  const IMG img = SEC_Img(RTN_Sec(rtn));
+  const string &image_path = IMG_Name(img);
+  const string image_name = image_path.substr(image_path.rfind('/') + 1);
+  RTN_Open(rtn);
+  for (INS ins = RTN_InsHead(rtn); INS_Valid(ins); ins = INS_Next(ins)) {
+    if (!IsFpInstruction(ins)) {
+      continue;
+    }
+    INT32 line = 0;
+    string file_name;
+    PIN_GetSourceLocation(INS_Address(ins), NULL, &line, &file_name);
+    *output << image_name << "\t"
+            << hexstr(INS_Address(ins) - IMG_LowAddress(img)) << "\t"
+            << RTN_Name(rtn) << "\t"
+            << (file_name.empty() ? "??" : file_name) << ":" << line << "\t"
+            << INS_Disassemble(ins) << endl;
+  }
+  RTN_Close(rtn);
+}
+
+/**
+ * Starts the output file of the forked process like that of its parent.
+ * This function is called in the child process after every fork if the
+ * KnobPrintFpInsAddresses flag is supplied on the command line.
+ *
+ * @param[in,out] output The output file of the forked process.
+ */
+VOID ResetAfterFork(ofstream *output) {
+  *output << "# image\toffset\tfunction\tsource\tinstruction" << endl;
+}
+
+}  // namespace
+}  // namespace callbacks
+
+VOID PrintFpInstructionAddresses(ofstream *output) {
+  *output << "# image\toffset\tfunction\tsource\tinstruction" << endl;
+
+  PIN_AddFiniFunction(reinterpret_cast<FINI_CALLBACK>(callbacks::CloseFile),
+                      output);
+  RegisterProcessOutput(output, NULL, callbacks::ResetAfterFork);
+  RTN_AddInstrumentFunction(reinterpret_cast<RTN_INSTRUMENT_CALLBACK>(
+                                callbacks::InstrumentationCallback),
+                            output);
+}
+
+}  // namespace NEAT
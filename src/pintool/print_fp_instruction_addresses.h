@@ -0,0 +1,22 @@
+#ifndef PINTOOL_PRINT_FP_INSTRUCTION_ADDRESSES_H_
+#define PINTOOL_PRINT_FP_INSTRUCTION_ADDRESSES_H_
+
+#include <pin.H>
+
+#include <fstream>
+
+namespace NEAT {
+
+/**
+ * Instruments an application with functions to print the address of every
+ * floating-point arithmetic instruction relative to the image containing it,
+ * along with its function, source line and disassembly, as used by
+ * AddressRangeFpSelector config files.
+ *
+ * @param[in] output The output file to write to.
+ */
+VOID PrintFpInstructionAddresses(ofstream *output);
+
+}  // namespace NEAT
+
+#endif  // PINTOOL_PRINT_FP_INSTRUCTION_ADDRESSES_H_
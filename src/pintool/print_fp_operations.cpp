@@ -4,6 +4,10 @@
 
 #include <fstream>
 
+#include "pintool/fp_op_sampler.h"
+#include "pintool/overhead_report.h"
+#include "pintool/process_outputs.h"
+#include "pintool/region_of_interest.h"
 #include "pintool/utils.h"
 
 /**
@@ -23,6 +27,9 @@ namespace {
  */
 PIN_MUTEX output_file_lock;
 
+/// Decides which floating-point operations are printed.
+NEAT::FpOpSampler fp_op_sampler;
+
 }  // namespace
 
 namespace NEAT {
@@ -50,7 +57,7 @@ VOID PrintRegisterFpOperands(const OPCODE operation,
                              const PIN_REGISTER *operand2, ofstream *output) {
   // Take control of the output file from this point until the result is written
   // to it
-  PIN_MutexLock(&output_file_lock);
+  LockMutex(&output_file_lock, kPrintFpOpsMutex);
 
   *output << OPCODE_StringShort(operation) << " ";
   // To disambiguate assosiative operations, list the largest operand first.
@@ -85,7 +92,7 @@ VOID PrintMemoryFpOperands(const OPCODE operation, const PIN_REGISTER *operand1,
                            const FLT32 *operand2, ofstream *output) {
   // Take control of the output file from this point until the result is written
   // to it
-  PIN_MutexLock(&output_file_lock);
+  LockMutex(&output_file_lock, kPrintFpOpsMutex);
 
   *output << OPCODE_StringShort(operation) << " ";
   // To disambiguate assosiative operations, list the largest operand first.
@@ -147,52 +154,86 @@ VOID CloseOutputStream(const INT32 code, ofstream *output) {
  * @param[in] output The output file to write to.
  */
 VOID InstrumentationCallback(const INS ins, ofstream *output) {
+  const OverheadCallbackTimer timer(kPrintFpOpsCallback);
+  if (!IsInRegionOfInterest()) {
+    return;
+  }
+
   if (IsFpInstruction(ins)) {
+    IARGLIST operand_args = IARGLIST_Alloc();
+    AFUNPTR print_operands;
     if (INS_OperandIsReg(ins, 1)) {
+      print_operands =
+          reinterpret_cast<AFUNPTR>(analysis::PrintRegisterFpOperands);
       // clang-format off
-      INS_InsertCall(
-          ins, IPOINT_BEFORE,
-          reinterpret_cast<AFUNPTR>(analysis::PrintRegisterFpOperands),
+      IARGLIST_AddArguments(
+          operand_args,
           IARG_UINT32, INS_Opcode(ins),
           IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 0),
           IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 1),
           IARG_PTR, output,
-          IARG_CALL_ORDER, CALL_ORDER_FIRST,
           IARG_END);
       // clang-format on
     } else {
+      print_operands =
+          reinterpret_cast<AFUNPTR>(analysis::PrintMemoryFpOperands);
       // clang-format off
-      INS_InsertCall(
-          ins, IPOINT_BEFORE,
-          reinterpret_cast<AFUNPTR>(analysis::PrintMemoryFpOperands),
+      IARGLIST_AddArguments(
+          operand_args,
           IARG_UINT32, INS_Opcode(ins),
           IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 0),
           IARG_MEMORYREAD_EA,
           IARG_PTR, output,
-          IARG_CALL_ORDER, CALL_ORDER_FIRST,
           IARG_END);
       // clang-format on
     }
+    fp_op_sampler.InsertCall(ins, IPOINT_BEFORE, CALL_ORDER_FIRST, TRUE,
+                             print_operands, operand_args);
+    IARGLIST_Free(operand_args);
 
+    IARGLIST result_args = IARGLIST_Alloc();
     // clang-format off
-    INS_InsertCall(
-        ins, IPOINT_AFTER,
-        reinterpret_cast<AFUNPTR>(analysis::PrintFpResult),
+    IARGLIST_AddArguments(
+        result_args,
         IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 0),
         IARG_PTR, output,
         IARG_END);
     // clang-format on
+    fp_op_sampler.InsertCall(
+        ins, IPOINT_AFTER, CALL_ORDER_DEFAULT, FALSE,
+        reinterpret_cast<AFUNPTR>(analysis::PrintFpResult), result_args);
+    IARGLIST_Free(result_args);
+    CountAnalysisCalls(ins, kPrintFpOpsFeature, 2);
+  }
+}
+
+/**
+ * Starts the output file of the forked process like that of its parent.
+ * This function is called in the child process after every fork if the
+ * KnobPrintFpOps flag is supplied on the command line.
+ *
+ * @param[in,out] output The output file of the forked process.
+ */
+VOID ResetAfterFork(ofstream *output) {
+  if (fp_op_sampler.IsSampling()) {
+    *output << fp_op_sampler.GetDescription() << "\n";
   }
 }
 
 }  // namespace
 }  // namespace callbacks
 
-VOID PrintFpOperations(ofstream *output) {
+VOID PrintFpOperations(ofstream *output, const UINT64 sample_period,
+                       const UINT64 sample_burst) {
   PIN_MutexInit(&output_file_lock);
+  fp_op_sampler.SetSampling(sample_period, sample_burst);
+  if (fp_op_sampler.IsSampling()) {
+    *output << fp_op_sampler.GetDescription() << "\n";
+  }
 
   PIN_AddFiniFunction(
       reinterpret_cast<FINI_CALLBACK>(callbacks::CloseOutputStream), output);
+  RegisterProcessOutput(output, &output_file_lock, callbacks::ResetAfterFork);
   INS_AddInstrumentFunction(reinterpret_cast<INS_INSTRUMENT_CALLBACK>(
                                 callbacks::InstrumentationCallback),
                             output);
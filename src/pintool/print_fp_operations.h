@@ -12,8 +12,13 @@ namespace NEAT {
  * every floating-point instruction in the instrumented application.
  *
  * @param[in] output The output file to write to.
+ * @param[in] sample_period Number of floating-point operations in every
+ *     sampling period of every thread.
+ * @param[in] sample_burst Number of floating-point operations printed in every
+ *     sampling period, all of them if it equals sample_period.
  */
-VOID PrintFpOperations(ofstream *output);
+VOID PrintFpOperations(ofstream *output, const UINT64 sample_period,
+                       const UINT64 sample_burst);
 
 }  // namespace NEAT
 
@@ -2,11 +2,20 @@
 
 #include <pin.H>
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <map>
 #include <string>
 #include <utility>
-
+#include <vector>
+
+#include "pintool/fp_op_sampler.h"
+#include "pintool/fp_routine_index.h"
+#include "pintool/function_attribution.h"
+#include "pintool/overhead_report.h"
+#include "pintool/process_outputs.h"
+#include "pintool/region_of_interest.h"
 #include "pintool/utils.h"
 
 namespace NEAT {
@@ -25,6 +34,12 @@ map<string, UINT64> function_fp_op_count;
  */
 PIN_MUTEX function_fp_op_count_lock;
 
+/// Decides which floating-point operations are counted.
+FpOpSampler fp_op_sampler;
+
+/// Whether the operations are counted and not yet printed.
+BOOL counting_function_num_fp_ops = FALSE;
+
 }  // namespace
 
 namespace analysis {
@@ -40,7 +55,7 @@ namespace {
  *     floating-point operation.
  */
 VOID IncrementFpFunctionOpCount(const string *function_name) {
-  PIN_MutexLock(&function_fp_op_count_lock);
+  LockMutex(&function_fp_op_count_lock, kPrintFunctionFpOpsMutex);
   function_fp_op_count[*function_name]++;
   PIN_MutexUnlock(&function_fp_op_count_lock);
 }
@@ -61,14 +76,48 @@ namespace {
  * @param[in,out] output The output file to use.
  */
 VOID PrintToFile(const INT32 code, ofstream *output) {
-  for (const pair<string, UINT64> &count : function_fp_op_count) {
-    *output << count.first << " " << count.second << endl;
+  counting_function_num_fp_ops = FALSE;
+  if (fp_op_sampler.IsSampling()) {
+    // Print the estimated count of every function and the half-width of its
+    // 95% confidence interval.
+    *output << fp_op_sampler.GetDescription() << endl;
+    for (const pair<string, UINT64> &count : function_fp_op_count) {
+      *output << count.first << " "
+              << static_cast<UINT64>(llround(
+                     count.second * fp_op_sampler.GetScalingFactor()))
+              << " "
+              << static_cast<UINT64>(llround(
+                     fp_op_sampler.GetConfidenceInterval(count.second)))
+              << endl;
+    }
+  } else {
+    for (const pair<string, UINT64> &count : function_fp_op_count) {
+      *output << count.first << " " << count.second << endl;
+    }
   }
   output->close();
   delete output;
   PIN_MutexFini(&function_fp_op_count_lock);
 }
 
+/**
+ * Schedule a call to an analysis routine to count a floating-point arithmetic
+ * instruction in the supplied function.
+ *
+ * @param[in] ins Floating-point instruction to be instrumented.
+ * @param[in] function_name Name of the function containing the instruction,
+ *     which must stay valid until the application exits.
+ */
+VOID InstrumentFpInstruction(const INS ins, const string *function_name) {
+  IARGLIST args = IARGLIST_Alloc();
+  IARGLIST_AddArguments(args, IARG_PTR, function_name, IARG_END);
+  fp_op_sampler.InsertCall(
+      ins, IPOINT_BEFORE, CALL_ORDER_DEFAULT, TRUE,
+      reinterpret_cast<AFUNPTR>(analysis::IncrementFpFunctionOpCount), args);
+  IARGLIST_Free(args);
+  CountAnalysisCalls(ins, kPrintFunctionFpOpsFeature, 1);
+}
+
 /**
  * Schedule calls to analysis routines to count the number of floating-point
  * arithmetic operations that are executed in each function of the instrumented
@@ -81,32 +130,114 @@ VOID PrintToFile(const INT32 code, ofstream *output) {
  * @param[in] output The output file to write to.
  */
 VOID InstrumentationCallback(const RTN rtn, ofstream *output) {
+  const OverheadCallbackTimer timer(kPrintFunctionFpOpsRoutineCallback);
+  if (!IsInRegionOfInterest() || !MayContainFpInstructions(rtn)) {
+    return;
+  }
+
   RTN_Open(rtn);
   for (INS ins = RTN_InsHead(rtn); INS_Valid(ins); ins = INS_Next(ins)) {
     if (IsFpInstruction(ins)) {
-      // clang-format off
-      INS_InsertCall(
-          ins, IPOINT_BEFORE,
-          reinterpret_cast<AFUNPTR>(analysis::IncrementFpFunctionOpCount),
-          IARG_PTR, &RTN_Name(rtn),
-          IARG_END);
-      // clang-format on
+      InstrumentFpInstruction(ins, &RTN_Name(rtn));
     }
   }
   RTN_Close(rtn);
 }
 
+/**
+ * Schedule calls to analysis routines to count the floating-point arithmetic
+ * operations executed in a trace, attributing those outside any known routine
+ * to kUnknownFunctionName.
+ * This function is called every time a new trace is encountered if the
+ * KnobPrintFunctionNumFpOps and KnobTraceInstrumentation flags are supplied on
+ * the command line.
+ *
+ * @param[in] trace Trace to be instrumented.
+ * @param[in] v Unused.
+ */
+VOID TraceInstrumentationCallback(const TRACE trace, VOID *v) {
+  const OverheadCallbackTimer timer(kPrintFunctionFpOpsTraceCallback);
+  if (!IsInRegionOfInterest()) {
+    return;
+  }
+
+  for (BBL bbl = TRACE_BblHead(trace); BBL_Valid(bbl); bbl = BBL_Next(bbl)) {
+    for (INS ins = BBL_InsHead(bbl); INS_Valid(ins); ins = INS_Next(ins)) {
+      if (IsFpInstruction(ins)) {
+        InstrumentFpInstruction(ins, &GetFunctionName(INS_Address(ins)));
+      }
+    }
+  }
+}
+
+/**
+ * Makes the forked process count only the operations it executes.
+ * This function is called in the child process after every fork if the
+ * KnobPrintFunctionNumFpOps flag is supplied on the command line.
+ *
+ * @param[in] output Unused.
+ */
+VOID ResetAfterFork(ofstream *output) { function_fp_op_count.clear(); }
+
 }  // namespace
 }  // namespace callbacks
 
-VOID PrintFunctionNumFpOps(ofstream *output) {
+VOID PrintFunctionNumFpOps(ofstream *output, const UINT64 sample_period,
+                           const UINT64 sample_burst, const BOOL use_traces) {
   PIN_MutexInit(&function_fp_op_count_lock);
+  fp_op_sampler.SetSampling(sample_period, sample_burst);
+  counting_function_num_fp_ops = TRUE;
 
   PIN_AddFiniFunction(reinterpret_cast<FINI_CALLBACK>(callbacks::PrintToFile),
                       output);
-  RTN_AddInstrumentFunction(reinterpret_cast<RTN_INSTRUMENT_CALLBACK>(
-                                callbacks::InstrumentationCallback),
-                            output);
+  RegisterProcessOutput(output, &function_fp_op_count_lock,
+                        callbacks::ResetAfterFork);
+  if (use_traces) {
+    InitFunctionAttribution();
+    TRACE_AddInstrumentFunction(reinterpret_cast<TRACE_INSTRUMENT_CALLBACK>(
+                                    callbacks::TraceInstrumentationCallback),
+                                NULL);
+  } else {
+    RTN_AddInstrumentFunction(reinterpret_cast<RTN_INSTRUMENT_CALLBACK>(
+                                  callbacks::InstrumentationCallback),
+                              output);
+  }
+}
+
+BOOL GetTopFunctionNumFpOps(
+    const UINT32 max_functions,
+    vector<pair<string, UINT64>> *function_num_fp_ops) {
+  if (!counting_function_num_fp_ops) {
+    return FALSE;
+  }
+  // Functions are only removed from the map in a forked process before any
+  // other thread runs, so their names can be read after the lock is released,
+  // which keeps the time analysis routines may wait for it short.
+  vector<pair<UINT64, const string *>> counts;
+  PIN_MutexLock(&function_fp_op_count_lock);
+  counts.reserve(function_fp_op_count.size());
+  for (const auto &count : function_fp_op_count) {
+    counts.push_back(make_pair(count.second, &count.first));
+  }
+  PIN_MutexUnlock(&function_fp_op_count_lock);
+
+  const UINT32 num_functions =
+      min(static_cast<UINT32>(counts.size()), max_functions);
+  // Functions executing as many operations are ordered by name, so that the
+  // same counts are always published in the same order.
+  partial_sort(counts.begin(), counts.begin() + num_functions, counts.end(),
+               [](const pair<UINT64, const string *> &a,
+                  const pair<UINT64, const string *> &b) {
+                 return a.first > b.first ||
+                        (a.first == b.first && *a.second < *b.second);
+               });
+  function_num_fp_ops->clear();
+  for (UINT32 i = 0; i < num_functions; i++) {
+    const UINT64 count = static_cast<UINT64>(
+        llround(counts[i].first * fp_op_sampler.GetScalingFactor()));
+    function_num_fp_ops->push_back(make_pair(*counts[i].second, count));
+  }
+  return TRUE;
 }
 
 }  // namespace NEAT
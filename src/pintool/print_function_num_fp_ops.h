@@ -4,6 +4,9 @@
 #include <pin.H>
 
 #include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace NEAT {
 
@@ -13,8 +16,31 @@ namespace NEAT {
  * application.
  *
  * @param[in] output The output file to write to.
+ * @param[in] sample_period Number of floating-point operations in every
+ *     sampling period of every thread.
+ * @param[in] sample_burst Number of floating-point operations counted in every
+ *     sampling period, all of them if it equals sample_period.
+ * @param[in] use_traces Whether to instrument traces instead of routines, which
+ *     also counts operations in code without routine symbols under
+ *     kUnknownFunctionName.
  */
-VOID PrintFunctionNumFpOps(ofstream *output);
+VOID PrintFunctionNumFpOps(ofstream *output, const UINT64 sample_period,
+                           const UINT64 sample_burst, const BOOL use_traces);
+
+/**
+ * Gets the functions that executed the most floating-point arithmetic
+ * operations so far while the application runs, with their counts estimated
+ * from the sampled operations if sampling.
+ *
+ * @param[in] max_functions Maximum number of functions to get.
+ * @param[out] function_num_fp_ops The names and counts of the functions, in
+ *     decreasing order of count.
+ * @return Whether the operations are counted, which is only the case after
+ *     PrintFunctionNumFpOps is called and until the application exits.
+ */
+BOOL GetTopFunctionNumFpOps(
+    const UINT32 max_functions,
+    vector<pair<string, UINT64>> *function_num_fp_ops);
 
 }  // namespace NEAT
 
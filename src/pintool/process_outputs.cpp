@@ -0,0 +1,131 @@
+#include "pintool/process_outputs.h"
+
+#include <pin.H>
+
+#include <fstream>
+#include <map>
+#include <string>
+
+namespace NEAT {
+namespace {
+
+/// Whether every process writes its own outputs.
+BOOL per_process_outputs = FALSE;
+
+/// The name of the output file of the whole application, for every output
+/// file opened.
+map<ofstream *, string> output_file_names;
+
+/// An output file given to RegisterProcessOutput.
+struct ProcessOutput {
+  /// The output file.
+  ofstream *output;
+  /// The lock taken to write to the output file, or NULL.
+  PIN_MUTEX *lock;
+  /// The function resetting what a forked process inherited, or NULL.
+  ProcessOutputReset reset;
+};
+
+/**
+ * Returns the name of an output file of the current process.
+ */
+string GetProcessFileName(const string &file_name) {
+  return file_name + "." + decstr(PIN_GetPid());
+}
+
+}  // namespace
+
+namespace callbacks {
+namespace {
+
+/**
+ * Takes the lock of an output file and writes what the output file buffers,
+ * so that the forked process inherits neither.
+ * This function is called before the instrumented application forks for every
+ * output file given to RegisterProcessOutput.
+ *
+ * @param[in] thread_id Pin id of the forking thread.
+ * @param[in] ctxt Unused.
+ * @param[in,out] process_output The output file.
+ */
+VOID BeforeFork(const THREADID thread_id, const CONTEXT *ctxt,
+                ProcessOutput *process_output) {
+  if (process_output->lock != NULL) {
+    PIN_MutexLock(process_output->lock);
+  }
+  process_output->output->flush();
+}
+
+/**
+ * Releases the lock of an output file once the instrumented application has
+ * forked.
+ * This function is called in the parent process after every fork for every
+ * output file given to RegisterProcessOutput.
+ *
+ * @param[in] thread_id Pin id of the forking thread.
+ * @param[in] ctxt Unused.
+ * @param[in,out] process_output The output file.
+ */
+VOID AfterForkInParent(const THREADID thread_id, const CONTEXT *ctxt,
+                       ProcessOutput *process_output) {
+  if (process_output->lock != NULL) {
+    PIN_MutexUnlock(process_output->lock);
+  }
+}
+
+/**
+ * Makes the forked process write to an output file of its own.
+ * This function is called in the child process after every fork for every
+ * output file given to RegisterProcessOutput.
+ *
+ * @param[in] thread_id Pin id of the forking thread.
+ * @param[in] ctxt Unused.
+ * @param[in,out] process_output The output file inherited from the parent
+ *     process.
+ */
+VOID AfterForkInChild(const THREADID thread_id, const CONTEXT *ctxt,
+                      ProcessOutput *process_output) {
+  // The lock was taken by the forking thread, which is the only thread of the
+  // forked process.
+  if (process_output->lock != NULL) {
+    PIN_MutexInit(process_output->lock);
+  }
+  ofstream *output = process_output->output;
+  output->close();
+  output->clear();
+  output->open(GetProcessFileName(output_file_names[output]).c_str());
+  if (process_output->reset != NULL) {
+    process_output->reset(output);
+  }
+}
+
+}  // namespace
+}  // namespace callbacks
+
+VOID UsePerProcessOutputs() { per_process_outputs = TRUE; }
+
+ofstream *OpenProcessOutput(const string &file_name) {
+  ofstream *output = new ofstream(
+      (per_process_outputs ? GetProcessFileName(file_name) : file_name)
+          .c_str());
+  output_file_names[output] = file_name;
+  return output;
+}
+
+VOID RegisterProcessOutput(ofstream *output, PIN_MUTEX *lock,
+                           ProcessOutputReset reset) {
+  ProcessOutput *process_output = new ProcessOutput{output, lock, reset};
+  PIN_AddForkFunction(FPOINT_BEFORE,
+                      reinterpret_cast<FORK_CALLBACK>(callbacks::BeforeFork),
+                      process_output);
+  PIN_AddForkFunction(
+      FPOINT_AFTER_IN_PARENT,
+      reinterpret_cast<FORK_CALLBACK>(callbacks::AfterForkInParent),
+      process_output);
+  PIN_AddForkFunction(
+      FPOINT_AFTER_IN_CHILD,
+      reinterpret_cast<FORK_CALLBACK>(callbacks::AfterForkInChild),
+      process_output);
+}
+
+}  // namespace NEAT
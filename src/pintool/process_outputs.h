@@ -0,0 +1,56 @@
+#ifndef PINTOOL_PROCESS_OUTPUTS_H_
+#define PINTOOL_PROCESS_OUTPUTS_H_
+
+#include <pin.H>
+
+#include <fstream>
+#include <string>
+
+namespace NEAT {
+
+/**
+ * Makes every process write its own outputs, named after the supplied files
+ * with a dot and the process id appended, instead of only the processes forked
+ * by the instrumented application. Processes that Pin follows across exec run
+ * NEAT anew, so they only write outputs of their own if this is set before
+ * any output is opened.
+ */
+VOID UsePerProcessOutputs();
+
+/**
+ * Opens an output file of the current process.
+ *
+ * @param[in] file_name Name of the output file of the whole application.
+ * @return The output file, which stays open until it is deleted.
+ */
+ofstream *OpenProcessOutput(const string &file_name);
+
+/**
+ * Resets what a forked process inherited from its parent, so that it only
+ * writes what it executes itself to its output file. It is called once the
+ * output file of the forked process is open, and may start it anew.
+ *
+ * @param[in,out] output The output file of the forked process.
+ */
+typedef VOID (*ProcessOutputReset)(ofstream *output);
+
+/**
+ * Gives every process forked by the instrumented application an output file of
+ * its own. The lock is held while the application forks, and the output file
+ * is flushed, so that the forked process inherits neither. The forked process
+ * then initializes the lock again, closes the output file inherited from its
+ * parent, opens its own in its place and calls reset.
+ * This function must be called before the application starts.
+ *
+ * @param[in,out] output An output file opened with OpenProcessOutput.
+ * @param[in,out] lock The lock taken to write to the output file or to update
+ *     what is written to it, or NULL if there is none.
+ * @param[in] reset The function resetting what the forked process inherited,
+ *     or NULL if there is nothing to reset.
+ */
+VOID RegisterProcessOutput(ofstream *output, PIN_MUTEX *lock,
+                           ProcessOutputReset reset);
+
+}  // namespace NEAT
+
+#endif  // PINTOOL_PROCESS_OUTPUTS_H_
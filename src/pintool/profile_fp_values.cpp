@@ -0,0 +1,614 @@
+#include "pintool/profile_fp_values.h"
+
+#include <pin.H>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "pintool/fp_op_sampler.h"
+#include "pintool/overhead_report.h"
+#include "pintool/process_outputs.h"
+#include "pintool/region_of_interest.h"
+#include "pintool/utils.h"
+
+namespace NEAT {
+namespace {
+
+/// Number of rows of every count-min sketch.
+const UINT32 kSketchDepth = 4;
+
+/// Log base 2 of the number of counters in every row of a count-min sketch.
+/// Every row is indexed by its own 16 bits of the hash of a value.
+const UINT32 kSketchWidthLog2 = 12;
+const UINT32 kSketchWidth = 1 << kSketchWidthLog2;
+
+/// Log base 2 of the number of entries of the table of recent values of
+/// every thread, whose hit rate is reported as the repetition rate.
+const UINT32 kRecentValuesLog2 = 12;
+
+/// Number of hottest values of every thread tracked as candidate heavy
+/// hitters.
+const UINT32 kNumTrackedValues = 128;
+
+/// Number of instructions profiled. Instructions instrumented once this many
+/// are profiled are left unprofiled.
+const UINT32 kMaxProfiledInstructions = 4096;
+
+/**
+ * An operand pair or a result of an instruction. Instructions are numbered
+ * from 1 so that zeroed entries match no value.
+ */
+struct FpValue {
+  UINT32 instruction;
+  UINT32 value1;
+  UINT32 value2;
+
+  BOOL operator==(const FpValue &other) const {
+    return instruction == other.instruction && value1 == other.value1 &&
+           value2 == other.value2;
+  }
+
+  BOOL operator<(const FpValue &other) const {
+    if (instruction != other.instruction) {
+      return instruction < other.instruction;
+    }
+    if (value1 != other.value1) {
+      return value1 < other.value1;
+    }
+    return value2 < other.value2;
+  }
+};
+
+/// A value and an upper bound of the number of times it was seen.
+struct HotFpValue {
+  FpValue value;
+  UINT64 count;
+};
+
+/**
+ * Profiles the operand pairs or the results of every instruction on a single
+ * thread, in memory of a fixed size.
+ */
+struct FpValueSketch {
+  /// Count-min sketch of the number of times every value was seen.
+  UINT64 counts[kSketchDepth][kSketchWidth];
+  /// The last value seen in every entry, to detect repeated values.
+  FpValue recent_values[1 << kRecentValuesLog2];
+  /// Number of times every instruction saw a value in recent_values.
+  UINT64 repeated[kMaxProfiledInstructions + 1];
+  /// Candidate heavy hitters, the values with the highest counts seen when
+  /// they were last tracked.
+  HotFpValue hot_values[kNumTrackedValues];
+  UINT32 num_hot_values;
+  /// Lowest count of hot_values once it is full. Values with lower counts
+  /// cannot become heavy hitters, so they are not looked up in it.
+  UINT64 min_hot_count;
+};
+
+/// The values profiled on a single thread.
+struct ThreadFpValueProfile {
+  FpValueSketch operands;
+  FpValueSketch results;
+  /// Number of operations profiled for every instruction.
+  UINT64 fp_ops[kMaxProfiledInstructions + 1];
+};
+
+/// Where a profiled instruction is, printed like -print_fp_ins_addresses.
+struct ProfiledInstruction {
+  string image_name;
+  ADDRINT offset;
+  string function_name;
+  string disassembly;
+};
+
+/// The values profiled on every thread, allocated when the thread starts.
+ThreadFpValueProfile *thread_profiles[PIN_MAX_THREADS];
+
+/// The profiled instructions, indexed by their number minus 1.
+vector<ProfiledInstruction> profiled_instructions;
+
+/// The number of every profiled instruction, by address, so that
+/// instructions instrumented again keep their number.
+map<ADDRINT, UINT32> instruction_numbers;
+
+/// The addresses of the instructions left unprofiled.
+set<ADDRINT> unprofiled_instructions;
+
+/// Number of hottest operand pairs and results printed per instruction.
+UINT32 num_printed_hot_values = 0;
+
+/// Decides which floating-point operations are profiled.
+FpOpSampler fp_op_sampler;
+
+/**
+ * Returns the hash of a value, whose 16-bit parts index the rows of the
+ * count-min sketches.
+ */
+UINT64 HashFpValue(const FpValue &value) {
+  UINT64 hash =
+      (static_cast<UINT64>(value.value1) << 32 | value.value2) ^
+      (static_cast<UINT64>(value.instruction) * 0x9e3779b97f4a7c15ull);
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+/**
+ * Returns the count-min estimate of the number of times a value was seen.
+ */
+UINT64 EstimateCount(const UINT64 counts[kSketchDepth][kSketchWidth],
+                     const UINT64 hash) {
+  UINT64 estimate = counts[0][hash & (kSketchWidth - 1)];
+  for (UINT32 row = 1; row < kSketchDepth; row++) {
+    estimate =
+        min(estimate, counts[row][(hash >> (row * 16)) & (kSketchWidth - 1)]);
+  }
+  return estimate;
+}
+
+/**
+ * Updates the candidate heavy hitters with a value and its estimated count,
+ * replacing the candidate with the lowest count if the value is not one.
+ */
+VOID TrackHotFpValue(FpValueSketch *sketch, const FpValue &value,
+                     const UINT64 count) {
+  UINT32 min_index = 0;
+  UINT64 min_count = ~0ull;
+  BOOL found = FALSE;
+  for (UINT32 i = 0; i < sketch->num_hot_values; i++) {
+    HotFpValue &hot_value = sketch->hot_values[i];
+    if (hot_value.value == value) {
+      hot_value.count = count;
+      found = TRUE;
+    }
+    if (hot_value.count < min_count) {
+      min_index = i;
+      min_count = hot_value.count;
+    }
+  }
+  if (!found) {
+    if (sketch->num_hot_values < kNumTrackedValues) {
+      const HotFpValue hot_value = {value, count};
+      sketch->hot_values[sketch->num_hot_values++] = hot_value;
+      return;
+    }
+    if (count <= min_count) {
+      return;
+    }
+    sketch->hot_values[min_index].value = value;
+    sketch->hot_values[min_index].count = count;
+    min_count = count;
+    for (UINT32 i = 0; i < kNumTrackedValues; i++) {
+      min_count = min(min_count, sketch->hot_values[i].count);
+    }
+  }
+  sketch->min_hot_count = min_count;
+}
+
+/**
+ * Counts a value in a sketch: records whether it repeats a recent value,
+ * increments its count with a conservative update and tracks it if it may be
+ * a heavy hitter.
+ */
+VOID CountFpValue(FpValueSketch *sketch, const FpValue &value) {
+  const UINT64 hash = HashFpValue(value);
+  FpValue &recent_value =
+      sketch->recent_values[(hash * 0x9e3779b97f4a7c15ull) >>
+                            (64 - kRecentValuesLog2)];
+  if (recent_value == value) {
+    sketch->repeated[value.instruction]++;
+  } else {
+    recent_value = value;
+  }
+
+  // Only raising the counters below the new estimate keeps every counter an
+  // upper bound of the counts of the values mapped to it, and the sum of
+  // sketches of every thread an upper bound of the total counts.
+  const UINT64 count = EstimateCount(sketch->counts, hash) + 1;
+  for (UINT32 row = 0; row < kSketchDepth; row++) {
+    UINT64 &counter = sketch->counts[row][(hash >> (row * 16)) &
+                                          (kSketchWidth - 1)];
+    counter = max(counter, count);
+  }
+  if (sketch->num_hot_values < kNumTrackedValues ||
+      count >= sketch->min_hot_count) {
+    TrackHotFpValue(sketch, value, count);
+  }
+}
+
+/**
+ * Counts the operands of a floating-point operation.
+ *
+ * @param[in] thread_id Pin id of the thread executing the operation.
+ * @param[in] instruction Number of the instruction.
+ * @param[in] commutative Whether the order of the operands does not matter.
+ * @param[in] operand1 First operand of the operation.
+ * @param[in] operand2 Second operand of the operation.
+ */
+VOID CountFpOperands(const THREADID thread_id, const UINT32 instruction,
+                     const BOOL commutative, FLT32 operand1, FLT32 operand2) {
+  ThreadFpValueProfile *profile = thread_profiles[thread_id];
+  // To profile commutative operations as the same pair whatever the order of
+  // their operands, list the largest operand first.
+  if (commutative && !(operand1 > operand2)) {
+    swap(operand1, operand2);
+  }
+  FpValue value = {instruction, 0, 0};
+  memcpy(&value.value1, &operand1, sizeof(value.value1));
+  memcpy(&value.value2, &operand2, sizeof(value.value2));
+  profile->fp_ops[instruction]++;
+  CountFpValue(&profile->operands, value);
+}
+
+}  // namespace
+
+namespace analysis {
+namespace {
+
+/**
+ * Profiles the operands of a floating-point arithmetic operation.
+ * This function is called for every floating-point arithmetic instruction that
+ * operates on two registers if the KnobProfileFpValues flag is supplied on the
+ * command line.
+ *
+ * @param[in] thread_id Pin id of the thread executing the operation.
+ * @param[in] instruction Number of the instruction.
+ * @param[in] commutative Whether the order of the operands does not matter.
+ * @param[in] operand1 First operand of the instruction.
+ * @param[in] operand2 Second operand of the instruction.
+ */
+VOID ProfileRegisterFpOperands(const THREADID thread_id,
+                               const UINT32 instruction,
+                               const BOOL commutative,
+                               const PIN_REGISTER *operand1,
+                               const PIN_REGISTER *operand2) {
+  CountFpOperands(thread_id, instruction, commutative, *operand1->flt,
+                  *operand2->flt);
+}
+
+/**
+ * Profiles the operands of a floating-point arithmetic operation.
+ * This function is called for every floating-point arithmetic instruction that
+ * operates on a register and a memory location if the KnobProfileFpValues flag
+ * is supplied on the command line.
+ *
+ * @param[in] thread_id Pin id of the thread executing the operation.
+ * @param[in] instruction Number of the instruction.
+ * @param[in] commutative Whether the order of the operands does not matter.
+ * @param[in] operand1 First operand of the instruction.
+ * @param[in] operand2 Second operand of the instruction.
+ */
+VOID ProfileMemoryFpOperands(const THREADID thread_id,
+                             const UINT32 instruction, const BOOL commutative,
+                             const PIN_REGISTER *operand1,
+                             const FLT32 *operand2) {
+  CountFpOperands(thread_id, instruction, commutative, *operand1->flt,
+                  *operand2);
+}
+
+/**
+ * Profiles the result of a floating-point arithmetic operation.
+ * This function is called after every floating-point arithmetic instruction
+ * if the KnobProfileFpValues flag is supplied on the command line.
+ *
+ * @param[in] thread_id Pin id of the thread executing the operation.
+ * @param[in] instruction Number of the instruction.
+ * @param[in] result Result of the instruction.
+ */
+VOID ProfileFpResult(const THREADID thread_id, const UINT32 instruction,
+                     const PIN_REGISTER *result) {
+  FpValue value = {instruction, *result->dword, 0};
+  CountFpValue(&thread_profiles[thread_id]->results, value);
+}
+
+}  // namespace
+}  // namespace analysis
+
+namespace {
+
+/**
+ * Sums the sketches of every thread, and returns the hottest values of every
+ * instruction among the candidate heavy hitters of every thread, with their
+ * estimated total counts.
+ *
+ * @param[in] sketch Member of ThreadFpValueProfile holding the sketches.
+ * @param[in] num_fp_ops Number of operations profiled on every thread.
+ * @param[out] repeated Number of times every instruction repeated a value.
+ * @return The hottest values, indexed by instruction number.
+ */
+vector<vector<HotFpValue>> MergeFpValueSketches(
+    FpValueSketch ThreadFpValueProfile::*sketch, const UINT64 num_fp_ops,
+    vector<UINT64> *repeated) {
+  UINT64(*counts)[kSketchWidth] = new UINT64[kSketchDepth][kSketchWidth]();
+  set<FpValue> candidates;
+  repeated->assign(profiled_instructions.size() + 1, 0);
+  for (UINT32 thread_id = 0; thread_id < PIN_MAX_THREADS; thread_id++) {
+    if (thread_profiles[thread_id] == NULL) {
+      continue;
+    }
+    const FpValueSketch &thread_sketch = thread_profiles[thread_id]->*sketch;
+    for (UINT32 row = 0; row < kSketchDepth; row++) {
+      for (UINT32 column = 0; column < kSketchWidth; column++) {
+        counts[row][column] += thread_sketch.counts[row][column];
+      }
+    }
+    for (UINT32 i = 1; i < repeated->size(); i++) {
+      (*repeated)[i] += thread_sketch.repeated[i];
+    }
+    for (UINT32 i = 0; i < thread_sketch.num_hot_values; i++) {
+      candidates.insert(thread_sketch.hot_values[i].value);
+    }
+  }
+
+  // Every estimate exceeds the true count by at most e * num_fp_ops /
+  // kSketchWidth with probability 1 - exp(-kSketchDepth), so the values with
+  // lower estimates may not repeat at all.
+  const FLT64 max_error = M_E * num_fp_ops / kSketchWidth;
+  vector<vector<HotFpValue>> hot_values(profiled_instructions.size() + 1);
+  for (const FpValue &value : candidates) {
+    const HotFpValue hot_value = {value,
+                                  EstimateCount(counts, HashFpValue(value))};
+    if (hot_value.count > max_error) {
+      hot_values[value.instruction].push_back(hot_value);
+    }
+  }
+  delete[] counts;
+  for (vector<HotFpValue> &instruction_hot_values : hot_values) {
+    sort(instruction_hot_values.begin(), instruction_hot_values.end(),
+         [](const HotFpValue &a, const HotFpValue &b) {
+           return a.count > b.count;
+         });
+    if (instruction_hot_values.size() > num_printed_hot_values) {
+      instruction_hot_values.resize(num_printed_hot_values);
+    }
+  }
+  return hot_values;
+}
+
+/**
+ * Returns a count of sampled operations scaled into an estimated total.
+ */
+UINT64 ScaleCount(const UINT64 count) {
+  return static_cast<UINT64>(
+      llround(count * fp_op_sampler.GetScalingFactor()));
+}
+
+/**
+ * Returns the bits of a floating-point value as an 8 digit hex number, padded
+ * with 0's.
+ */
+string FpValueToHex(const UINT32 bits) { return StringHex(bits, 8, FALSE); }
+
+}  // namespace
+
+namespace callbacks {
+namespace {
+
+/**
+ * Allocates the profile of a thread.
+ * This function is called in every new thread of the instrumented application
+ * if the KnobProfileFpValues flag is supplied on the command line.
+ *
+ * @param[in] thread_id Pin id of the new thread.
+ * @param[in] ctxt Unused.
+ * @param[in] flags Unused.
+ * @param[in] v Unused.
+ */
+VOID ThreadStartCallback(const THREADID thread_id, CONTEXT *ctxt,
+                         const INT32 flags, VOID *v) {
+  // Pin reuses the ids of threads that exited, whose profiles are kept.
+  if (thread_profiles[thread_id] == NULL) {
+    thread_profiles[thread_id] = new ThreadFpValueProfile();
+  }
+}
+
+/**
+ * Merges the profiles of every thread, prints the repetition rates and the
+ * hottest values of every instruction, hottest instruction first, to the
+ * supplied output file and closes it.
+ * This function is called immediately before the instrumented application
+ * exits if the KnobProfileFpValues flag is supplied on the command line.
+ *
+ * @param[in] code Exit code of the pintool.
+ * @param[in,out] output The output file to use.
+ */
+VOID PrintToFile(const INT32 code, ofstream *output) {
+  vector<UINT64> fp_ops(profiled_instructions.size() + 1, 0);
+  UINT64 num_fp_ops = 0;
+  for (UINT32 thread_id = 0; thread_id < PIN_MAX_THREADS; thread_id++) {
+    if (thread_profiles[thread_id] != NULL) {
+      for (UINT32 i = 1; i < fp_ops.size(); i++) {
+        fp_ops[i] += thread_profiles[thread_id]->fp_ops[i];
+        num_fp_ops += thread_profiles[thread_id]->fp_ops[i];
+      }
+    }
+  }
+  vector<UINT64> repeated_operands;
+  vector<UINT64> repeated_results;
+  const vector<vector<HotFpValue>> hot_operands = MergeFpValueSketches(
+      &ThreadFpValueProfile::operands, num_fp_ops, &repeated_operands);
+  const vector<vector<HotFpValue>> hot_results = MergeFpValueSketches(
+      &ThreadFpValueProfile::results, num_fp_ops, &repeated_results);
+
+  vector<UINT32> instructions;
+  for (UINT32 i = 1; i < fp_ops.size(); i++) {
+    if (fp_ops[i] > 0) {
+      instructions.push_back(i);
+    }
+  }
+  stable_sort(instructions.begin(), instructions.end(),
+              [&fp_ops](const UINT32 a, const UINT32 b) {
+                return fp_ops[a] > fp_ops[b];
+              });
+
+  if (fp_op_sampler.IsSampling()) {
+    *output << fp_op_sampler.GetDescription() << endl;
+  }
+  *output << "# instruction\timage\toffset\tfunction\tdisassembly\tfp_ops"
+             "\toperand_repetition\tresult_repetition"
+          << endl;
+  *output << "# operands\toperand1\toperand2\tfp_ops" << endl;
+  *output << "# result\tresult\tfp_ops" << endl;
+  for (const UINT32 i : instructions) {
+    const ProfiledInstruction &instruction = profiled_instructions[i - 1];
+    *output << "instruction\t" << instruction.image_name << "\t"
+            << hexstr(instruction.offset) << "\t" << instruction.function_name
+            << "\t" << instruction.disassembly << "\t" << ScaleCount(fp_ops[i])
+            << "\t" << static_cast<FLT64>(repeated_operands[i]) / fp_ops[i]
+            << "\t" << static_cast<FLT64>(repeated_results[i]) / fp_ops[i]
+            << endl;
+    for (const HotFpValue &hot_value : hot_operands[i]) {
+      *output << "operands\t" << FpValueToHex(hot_value.value.value1) << "\t"
+              << FpValueToHex(hot_value.value.value2) << "\t"
+              << ScaleCount(hot_value.count) << endl;
+    }
+    for (const HotFpValue &hot_value : hot_results[i]) {
+      *output << "result\t" << FpValueToHex(hot_value.value.value1) << "\t"
+              << ScaleCount(hot_value.count) << endl;
+    }
+  }
+  if (!unprofiled_instructions.empty()) {
+    *output << "# " << unprofiled_instructions.size()
+            << " instructions were not profiled, only the first "
+            << kMaxProfiledInstructions << " are" << endl;
+  }
+  output->close();
+  delete output;
+}
+
+/**
+ * Schedule calls to analysis routines to profile the operands and the result
+ * of every floating-point operation in the instrumented application.
+ * This function is called every time a new instruction is encountered, before
+ * the instrumented application is run if the KnobProfileFpValues flag is
+ * supplied on the command line.
+ *
+ * @param[in] ins Instruction to be instrumented.
+ * @param[in] v Unused.
+ */
+VOID InstrumentationCallback(const INS ins, VOID *v) {
+  const OverheadCallbackTimer timer(kProfileFpValuesCallback);
+  if (!IsInRegionOfInterest() || !IsFpInstruction(ins)) {
+    return;
+  }
+
+  if (unprofiled_instructions.count(INS_Address(ins)) > 0) {
+    return;
+  }
+  UINT32 &instruction = instruction_numbers[INS_Address(ins)];
+  if (instruction == 0) {
+    if (profiled_instructions.size() == kMaxProfiledInstructions) {
+      instruction_numbers.erase(INS_Address(ins));
+      unprofiled_instructions.insert(INS_Address(ins));
+      return;
+    }
+    const IMG img = IMG_FindByAddress(INS_Address(ins));
+    ProfiledInstruction profiled_instruction;
+    if (IMG_Valid(img)) {
+      const string &image_path = IMG_Name(img);
+      profiled_instruction.image_name =
+          image_path.substr(image_path.rfind('/') + 1);
+      profiled_instruction.offset = INS_Address(ins) - IMG_LowAddress(img);
+    } else {
+      profiled_instruction.image_name = "??";
+      profiled_instruction.offset = INS_Address(ins);
+    }
+    profiled_instruction.function_name =
+        RTN_FindNameByAddress(INS_Address(ins));
+    profiled_instruction.disassembly = INS_Disassemble(ins);
+    profiled_instructions.push_back(profiled_instruction);
+    instruction = profiled_instructions.size();
+  }
+
+  const OPCODE opcode = INS_Opcode(ins);
+  const BOOL commutative =
+      opcode == XED_ICLASS_ADDSS || opcode == XED_ICLASS_MULSS;
+  IARGLIST operand_args = IARGLIST_Alloc();
+  AFUNPTR profile_operands;
+  if (INS_OperandIsReg(ins, 1)) {
+    profile_operands =
+        reinterpret_cast<AFUNPTR>(analysis::ProfileRegisterFpOperands);
+    // clang-format off
+    IARGLIST_AddArguments(
+        operand_args,
+        IARG_THREAD_ID,
+        IARG_UINT32, instruction,
+        IARG_BOOL, commutative,
+        IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 0),
+        IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 1),
+        IARG_END);
+    // clang-format on
+  } else {
+    profile_operands =
+        reinterpret_cast<AFUNPTR>(analysis::ProfileMemoryFpOperands);
+    // clang-format off
+    IARGLIST_AddArguments(
+        operand_args,
+        IARG_THREAD_ID,
+        IARG_UINT32, instruction,
+        IARG_BOOL, commutative,
+        IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 0),
+        IARG_MEMORYREAD_EA,
+        IARG_END);
+    // clang-format on
+  }
+  fp_op_sampler.InsertCall(ins, IPOINT_BEFORE, CALL_ORDER_FIRST, TRUE,
+                           profile_operands, operand_args);
+  IARGLIST_Free(operand_args);
+
+  IARGLIST result_args = IARGLIST_Alloc();
+  // clang-format off
+  IARGLIST_AddArguments(
+      result_args,
+      IARG_THREAD_ID,
+      IARG_UINT32, instruction,
+      IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 0),
+      IARG_END);
+  // clang-format on
+  fp_op_sampler.InsertCall(
+      ins, IPOINT_AFTER, CALL_ORDER_DEFAULT, FALSE,
+      reinterpret_cast<AFUNPTR>(analysis::ProfileFpResult), result_args);
+  IARGLIST_Free(result_args);
+  CountAnalysisCalls(ins, kProfileFpValuesFeature, 2);
+}
+
+/**
+ * Makes the forked process profile only the values it computes.
+ * This function is called in the child process after every fork if the
+ * KnobProfileFpValues flag is supplied on the command line.
+ *
+ * @param[in] output Unused.
+ */
+VOID ResetAfterFork(ofstream *output) {
+  for (UINT32 i = 0; i < PIN_MAX_THREADS; i++) {
+    if (thread_profiles[i] != NULL) {
+      memset(thread_profiles[i], 0, sizeof(ThreadFpValueProfile));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace callbacks
+
+VOID ProfileFpValues(ofstream *output, const UINT32 num_hot_values,
+                     const UINT64 sample_period, const UINT64 sample_burst) {
+  num_printed_hot_values = num_hot_values;
+  fp_op_sampler.SetSampling(sample_period, sample_burst);
+
+  PIN_AddThreadStartFunction(callbacks::ThreadStartCallback, NULL);
+  PIN_AddFiniFunction(reinterpret_cast<FINI_CALLBACK>(callbacks::PrintToFile),
+                      output);
+  RegisterProcessOutput(output, NULL, callbacks::ResetAfterFork);
+  INS_AddInstrumentFunction(callbacks::InstrumentationCallback, NULL);
+}
+
+}  // namespace NEAT
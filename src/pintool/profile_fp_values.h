@@ -0,0 +1,31 @@
+#ifndef PINTOOL_PROFILE_FP_VALUES_H_
+#define PINTOOL_PROFILE_FP_VALUES_H_
+
+#include <pin.H>
+
+#include <fstream>
+
+namespace NEAT {
+
+/**
+ * Instruments an application with functions to profile the operand and result
+ * values of every floating-point arithmetic instruction, and to print how
+ * often each instruction repeats its values and its hottest values when the
+ * application exits. Every thread counts values in count-min sketches and
+ * tracks its heavy hitters in fixed-size tables, so the memory used does not
+ * grow with the length of the run.
+ *
+ * @param[in] output The output file to write to.
+ * @param[in] num_hot_values Number of hottest operand pairs and results
+ *     printed for every instruction.
+ * @param[in] sample_period Number of floating-point operations in every
+ *     sampling period of every thread.
+ * @param[in] sample_burst Number of floating-point operations profiled in
+ *     every sampling period, all of them if it equals sample_period.
+ */
+VOID ProfileFpValues(ofstream *output, const UINT32 num_hot_values,
+                     const UINT64 sample_period, const UINT64 sample_burst);
+
+}  // namespace NEAT
+
+#endif  // PINTOOL_PROFILE_FP_VALUES_H_
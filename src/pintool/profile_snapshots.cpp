@@ -0,0 +1,229 @@
+#include "pintool/profile_snapshots.h"
+
+#include <pin.H>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pintool/print_fp_bits_manipulated.h"
+#include "pintool/print_function_num_fp_ops.h"
+
+namespace NEAT {
+namespace {
+
+/// The start of the first line of every snapshot file, which ends with the
+/// id of the run writing it.
+const char kSnapshotFileHeader[] = "NEAT profile snapshots 1";
+
+/// Longest time the snapshot thread sleeps before checking for exit.
+const UINT32 kMaxSleepMs = 100;
+
+/// Time to wait for the snapshot thread to finish when the application exits.
+const UINT32 kSnapshotThreadTimeoutMs = 10000;
+
+/// Prefix of the names of the snapshot files.
+string snapshot_prefix;
+
+/// Time between snapshots in milliseconds.
+UINT32 snapshot_interval_ms = 0;
+
+/// Number of snapshots written to each file.
+UINT32 snapshots_per_file = 0;
+
+/// Identifies the run in every snapshot file, so that files left over from
+/// an earlier run are never merged with those of this one.
+string run_id;
+
+/// Time at which the application started.
+chrono::steady_clock::time_point start_time;
+
+/// Number of snapshots written.
+UINT64 num_snapshots = 0;
+
+/// The counts of the profiles in the last snapshot.
+UINT64 last_fp_bits_manipulated = 0;
+map<string, UINT64> last_function_fp_ops;
+
+/// The internal thread taking the snapshots.
+PIN_THREAD_UID snapshot_thread_uid;
+
+/// Whether this process takes snapshots, which forked processes do not.
+BOOL snapshotting = FALSE;
+
+/**
+ * Returns the name of the snapshot file with an index.
+ */
+string GetSnapshotFileName(const UINT64 file_index) {
+  ostringstream file_name;
+  file_name << snapshot_prefix << "." << file_index;
+  return file_name.str();
+}
+
+/**
+ * Writes the counts of the profiles since the last snapshot to the current
+ * snapshot file. Only one thread may call this function at a time.
+ *
+ * @param[in] final Whether the application has exited.
+ */
+VOID TakeSnapshot(const BOOL final) {
+  UINT64 fp_bits_manipulated = 0;
+  const BOOL has_fp_bits_manipulated =
+      GetFpBitsManipulated(&fp_bits_manipulated);
+  vector<pair<string, UINT64>> function_fp_ops;
+  const BOOL has_function_fp_ops = GetTopFunctionNumFpOps(
+      numeric_limits<UINT32>::max(), &function_fp_ops);
+
+  // The snapshot is formatted before the file is opened so that it is written
+  // at once, and a snapshot cut off by a crash lacks its end line.
+  ostringstream snapshot;
+  snapshot << "snapshot " << num_snapshots << " "
+           << chrono::duration_cast<chrono::milliseconds>(
+                  chrono::steady_clock::now() - start_time)
+                  .count()
+           << (final ? " final" : "") << "\n";
+  if (has_fp_bits_manipulated) {
+    snapshot << "fp_bits_manipulated "
+             << fp_bits_manipulated - last_fp_bits_manipulated << "\n";
+    last_fp_bits_manipulated = fp_bits_manipulated;
+  }
+  if (has_function_fp_ops) {
+    for (const pair<string, UINT64> &count : function_fp_ops) {
+      UINT64 &last_count = last_function_fp_ops[count.first];
+      if (count.second != last_count) {
+        snapshot << "function " << count.second - last_count << " "
+                 << count.first << "\n";
+        last_count = count.second;
+      }
+    }
+  }
+  snapshot << "end " << num_snapshots << "\n";
+
+  // The first file is created with its header before the application starts.
+  const UINT64 file_index = num_snapshots / snapshots_per_file;
+  const BOOL new_file =
+      file_index > 0 && num_snapshots % snapshots_per_file == 0;
+  ofstream output(GetSnapshotFileName(file_index).c_str(),
+                  new_file ? ios::trunc : ios::app);
+  if (new_file) {
+    output << kSnapshotFileHeader << " " << run_id << "\n";
+  }
+  output << snapshot.str();
+  output.close();
+  if (!output) {
+    cerr << "Could not write profile snapshot " << num_snapshots << " to "
+         << GetSnapshotFileName(file_index) << endl;
+  }
+  num_snapshots++;
+}
+
+}  // namespace
+
+namespace callbacks {
+namespace {
+
+/**
+ * Takes a snapshot every snapshot_interval_ms milliseconds until the
+ * application exits.
+ * This function runs on an internal thread if the KnobSnapshotPrefix flag is
+ * supplied on the command line.
+ *
+ * @param[in] arg Unused.
+ */
+VOID SnapshotThread(VOID *arg) {
+  while (!PIN_IsProcessExiting()) {
+    for (UINT32 slept_ms = 0;
+         slept_ms < snapshot_interval_ms && !PIN_IsProcessExiting();
+         slept_ms += kMaxSleepMs) {
+      PIN_Sleep(min(snapshot_interval_ms - slept_ms, kMaxSleepMs));
+    }
+    if (!PIN_IsProcessExiting()) {
+      TakeSnapshot(FALSE);
+    }
+  }
+}
+
+/**
+ * Stops the snapshot thread and takes the final snapshot, before the profiles
+ * print their outputs.
+ * This function is called when the application is about to exit if the
+ * KnobSnapshotPrefix flag is supplied on the command line.
+ *
+ * @param[in] code OS specific termination code for the application.
+ * @param[in] v Unused.
+ */
+VOID TakeFinalSnapshot(const INT32 code, VOID *v) {
+  if (!snapshotting) {
+    return;
+  }
+  if (!PIN_WaitForThreadTermination(snapshot_thread_uid,
+                                    kSnapshotThreadTimeoutMs, NULL)) {
+    cerr << "Timed out waiting for the profile snapshot thread" << endl;
+    return;
+  }
+  TakeSnapshot(TRUE);
+}
+
+/**
+ * Stops taking snapshots in the forked process, which has no snapshot thread
+ * and must not append to the snapshots of its parent.
+ * This function is called in the child process after every fork if the
+ * KnobSnapshotPrefix flag is supplied on the command line.
+ *
+ * @param[in] thread_id Pin id of the forking thread.
+ * @param[in] ctxt Unused.
+ * @param[in] v Unused.
+ */
+VOID AfterForkInChild(const THREADID thread_id, const CONTEXT *ctxt,
+                      VOID *v) {
+  snapshotting = FALSE;
+}
+
+}  // namespace
+}  // namespace callbacks
+
+VOID SnapshotProfiles(const string &prefix, const UINT32 interval_ms,
+                      const UINT32 num_snapshots_per_file) {
+  snapshot_prefix = prefix;
+  snapshot_interval_ms = interval_ms;
+  snapshots_per_file = num_snapshots_per_file;
+  start_time = chrono::steady_clock::now();
+  ostringstream id;
+  id << PIN_GetPid() << "-"
+     << chrono::duration_cast<chrono::nanoseconds>(
+            chrono::system_clock::now().time_since_epoch())
+            .count();
+  run_id = id.str();
+
+  // Fail before the application starts if the snapshots cannot be written.
+  // The header is written at once, so that the first file of a run that stops
+  // before its first snapshot still identifies the run.
+  ofstream first_file(GetSnapshotFileName(0).c_str());
+  first_file << kSnapshotFileHeader << " " << run_id << "\n";
+  first_file.close();
+  if (!first_file) {
+    cerr << "Could not create profile snapshot file "
+         << GetSnapshotFileName(0) << endl;
+    exit(1);
+  }
+
+  snapshotting = TRUE;
+  if (PIN_SpawnInternalThread(callbacks::SnapshotThread, NULL, 0,
+                              &snapshot_thread_uid) == INVALID_THREADID) {
+    cerr << "Could not start the profile snapshot thread" << endl;
+    exit(1);
+  }
+  PIN_AddPrepareForFiniFunction(callbacks::TakeFinalSnapshot, NULL);
+  PIN_AddForkFunction(FPOINT_AFTER_IN_CHILD, callbacks::AfterForkInChild,
+                      NULL);
+}
+
+}  // namespace NEAT
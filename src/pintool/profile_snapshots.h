@@ -0,0 +1,30 @@
+#ifndef PINTOOL_PROFILE_SNAPSHOTS_H_
+#define PINTOOL_PROFILE_SNAPSHOTS_H_
+
+#include <pin.H>
+
+#include <string>
+
+namespace NEAT {
+
+/**
+ * Periodically writes what the bits manipulated and per-function profiles
+ * counted since the previous snapshot, so that the profiles of an application
+ * that crashes or is killed can be reconstructed up to its last snapshot with
+ * tools/merge_profile_snapshots.py. Snapshots are taken by an internal thread
+ * that only holds the locks of the profiles while copying their counts, so the
+ * application never waits for a snapshot to be written. Snapshots are appended
+ * to the files <prefix>.0, <prefix>.1 and so on, moving on to the next file
+ * every snapshots_per_file snapshots, and a final snapshot is written when the
+ * application exits.
+ *
+ * @param[in] prefix Prefix of the names of the snapshot files.
+ * @param[in] interval_ms Time between snapshots in milliseconds.
+ * @param[in] snapshots_per_file Number of snapshots written to each file.
+ */
+VOID SnapshotProfiles(const string &prefix, const UINT32 interval_ms,
+                      const UINT32 snapshots_per_file);
+
+}  // namespace NEAT
+
+#endif  // PINTOOL_PROFILE_SNAPSHOTS_H_
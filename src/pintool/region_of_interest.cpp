@@ -0,0 +1,182 @@
+#include "pintool/region_of_interest.h"
+
+#include <pin.H>
+
+#include <limits>
+#include <string>
+
+#include "pintool/overhead_report.h"
+
+namespace NEAT {
+namespace {
+
+/// Whether the application is in the region of interest.
+BOOL in_region = TRUE;
+
+/// Functions whose entry starts and ends the region, or empty.
+string start_function;
+string end_function;
+
+/**
+ * Number of instructions executed by every thread, counted per basic block
+ * without synchronization so that counting can be inlined.
+ */
+UINT64 executed_instructions = 0;
+
+/**
+ * Number of executed instructions at which the region starts or ends next,
+ * or the largest UINT64 if instructions are not counted.
+ */
+UINT64 next_boundary_icount = numeric_limits<UINT64>::max();
+
+/// Number of executed instructions at which the region ends, or 0.
+UINT64 region_end_icount = 0;
+
+/**
+ * Lock to ensure that only one thread starts or ends the region at each
+ * boundary.
+ */
+PIN_MUTEX region_lock;
+
+}  // namespace
+
+namespace analysis {
+namespace {
+
+/**
+ * Counts the instructions of a basic block. This function is simple enough
+ * for Pin to inline it.
+ * This function is called before every basic block while instructions are
+ * counted to find the boundaries of the region of interest.
+ *
+ * @param[in] num_instructions Number of instructions in the basic block.
+ * @return Whether the next boundary of the region has been reached.
+ */
+ADDRINT CountInstructions(const UINT32 num_instructions) {
+  executed_instructions += num_instructions;
+  return executed_instructions >= next_boundary_icount;
+}
+
+/**
+ * Starts or ends the region of interest, then discards all instrumented code
+ * and resumes the application from the current instruction so that it is
+ * instrumented again. Never returns.
+ * This function is called when a boundary of the region of interest is
+ * reached.
+ *
+ * @param[in] enter Whether the region starts rather than ends.
+ * @param[in] ctxt Context of the instrumented application to resume from.
+ */
+VOID CrossRegionBoundary(const BOOL enter, const CONTEXT *ctxt) {
+  LockMutex(&region_lock, kRegionOfInterestMutex);
+  // Other threads may reach the boundary before the code is instrumented
+  // again, but only the first one crosses it.
+  if (in_region != enter) {
+    in_region = enter;
+    if (enter && region_end_icount > 0) {
+      next_boundary_icount = region_end_icount;
+    } else {
+      next_boundary_icount = numeric_limits<UINT64>::max();
+    }
+    PIN_RemoveInstrumentation();
+  }
+  PIN_MutexUnlock(&region_lock);
+  PIN_ExecuteAt(ctxt);
+}
+
+}  // namespace
+}  // namespace analysis
+
+namespace callbacks {
+namespace {
+
+/**
+ * Schedule calls to analysis routines that cross the next boundary of the
+ * region of interest.
+ * This function is called every time a new trace is encountered if a region
+ * of interest is specified on the command line.
+ *
+ * @param[in] trace Trace to be instrumented.
+ * @param[in] v Unused.
+ */
+VOID InstrumentationCallback(const TRACE trace, VOID *v) {
+  const OverheadCallbackTimer timer(kRegionOfInterestCallback);
+  const string &boundary_function = in_region ? end_function : start_function;
+  const RTN rtn = TRACE_Rtn(trace);
+  if (!boundary_function.empty() && RTN_Valid(rtn) &&
+      TRACE_Address(trace) == RTN_Address(rtn) &&
+      RTN_Name(rtn) == boundary_function) {
+    // clang-format off
+    TRACE_InsertCall(
+        trace, IPOINT_BEFORE,
+        reinterpret_cast<AFUNPTR>(analysis::CrossRegionBoundary),
+        IARG_BOOL, !in_region,
+        IARG_CONST_CONTEXT,
+        IARG_CALL_ORDER, CALL_ORDER_FIRST,
+        IARG_END);
+    // clang-format on
+  }
+
+  if (next_boundary_icount == numeric_limits<UINT64>::max()) {
+    return;
+  }
+  for (BBL bbl = TRACE_BblHead(trace); BBL_Valid(bbl); bbl = BBL_Next(bbl)) {
+    // clang-format off
+    BBL_InsertIfCall(
+        bbl, IPOINT_BEFORE,
+        reinterpret_cast<AFUNPTR>(analysis::CountInstructions),
+        IARG_UINT32, BBL_NumIns(bbl),
+        IARG_CALL_ORDER, CALL_ORDER_FIRST,
+        IARG_END);
+    BBL_InsertThenCall(
+        bbl, IPOINT_BEFORE,
+        reinterpret_cast<AFUNPTR>(analysis::CrossRegionBoundary),
+        IARG_BOOL, !in_region,
+        IARG_CONST_CONTEXT,
+        IARG_CALL_ORDER, CALL_ORDER_FIRST,
+        IARG_END);
+    // clang-format on
+    CountAnalysisCalls(BBL_InsHead(bbl), kRegionOfInterestFeature, 1);
+  }
+}
+
+/**
+ * Releases the lock of the region in the forked process, where the thread
+ * that may have held it when the application forked does not exist.
+ * This function is called in the child process after every fork if a region
+ * of interest is specified on the command line.
+ *
+ * @param[in] thread_id Pin id of the forking thread.
+ * @param[in] ctxt Unused.
+ * @param[in] v Unused.
+ */
+VOID AfterForkInChild(const THREADID thread_id, const CONTEXT *ctxt,
+                      VOID *v) {
+  PIN_MutexInit(&region_lock);
+}
+
+}  // namespace
+}  // namespace callbacks
+
+VOID RegionOfInterest(const string &start_function_name,
+                      const string &end_function_name,
+                      const UINT64 start_icount, const UINT64 end_icount) {
+  start_function = start_function_name;
+  end_function = end_function_name;
+  region_end_icount = end_icount;
+  in_region = start_function_name.empty() && start_icount == 0;
+  if (!in_region && start_icount > 0) {
+    next_boundary_icount = start_icount;
+  } else if (in_region && end_icount > 0) {
+    next_boundary_icount = end_icount;
+  }
+  PIN_MutexInit(&region_lock);
+
+  PIN_AddForkFunction(FPOINT_AFTER_IN_CHILD, callbacks::AfterForkInChild,
+                      NULL);
+  TRACE_AddInstrumentFunction(callbacks::InstrumentationCallback, NULL);
+}
+
+BOOL IsInRegionOfInterest() { return in_region; }
+
+}  // namespace NEAT
@@ -0,0 +1,41 @@
+#ifndef PINTOOL_REGION_OF_INTEREST_H_
+#define PINTOOL_REGION_OF_INTEREST_H_
+
+#include <pin.H>
+
+#include <string>
+
+namespace NEAT {
+
+/**
+ * Restricts the instrumentation of every NEAT feature to a region of interest
+ * of the application, which starts on entry to a function or once a number of
+ * instructions have executed, and ends on entry to another function or once
+ * another number of instructions have executed. Function regions may be
+ * entered any number of times. Whenever the region starts or ends, all
+ * instrumented code is discarded, so code outside the region runs without any
+ * floating-point analysis routine.
+ *
+ * @param[in] start_function_name The function starting the region, or empty.
+ * @param[in] end_function_name The function ending the region, or empty for
+ *     the region to last until the application exits.
+ * @param[in] start_icount Number of instructions executed before the region
+ *     starts, or 0 when the region starts with a function.
+ * @param[in] end_icount Number of instructions executed before the region
+ *     ends, or 0 for the region to last until the application exits.
+ */
+VOID RegionOfInterest(const string &start_function_name,
+                      const string &end_function_name,
+                      const UINT64 start_icount, const UINT64 end_icount);
+
+/**
+ * Returns whether code being instrumented belongs to the region of interest,
+ * which is always the case if RegionOfInterest was not called. Instrumentation
+ * callbacks of every feature must insert no analysis routine outside the
+ * region.
+ */
+BOOL IsInRegionOfInterest();
+
+}  // namespace NEAT
+
+#endif  // PINTOOL_REGION_OF_INTEREST_H_
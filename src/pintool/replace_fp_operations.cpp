@@ -2,17 +2,105 @@
 
 #include <pin.H>
 
+#include <cstdlib>
+#include <iostream>
 #include <string>
 
 #include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/interfaces/fp_result_transform.h"
 #include "client_lib/interfaces/fp_selector.h"
+#include "client_lib/utils/fp_instruction.h"
+#include "client_lib/utils/fp_operand_predicate.h"
 #include "client_lib/utils/fp_operation.h"
+#include "pintool/error_budget.h"
+#include "pintool/fp_routine_index.h"
+#include "pintool/function_attribution.h"
+#include "pintool/live_statistics.h"
+#include "pintool/overhead_report.h"
+#include "pintool/region_of_interest.h"
 #include "pintool/utils.h"
 
 namespace NEAT {
+namespace {
+
+/**
+ * Number of floating-point operations left to execute natively before the
+ * pass-through of the FpSelector ends. Threads decrement it without
+ * synchronization so that the decrement can be inlined.
+ */
+INT64 pass_through_fp_ops_left;
+
+/**
+ * Whether the code instrumented since the last time instrumentation was
+ * removed executes natively, so that the pass-through counter is reset once
+ * when passing through starts.
+ */
+BOOL instrumenting_pass_through = FALSE;
+
+/**
+ * Lock to ensure that only one thread ends the pass-through of the FpSelector.
+ */
+PIN_MUTEX pass_through_lock;
+
+/**
+ * The result of a floating-point operation computed by an FpImplementation
+ * before the instruction executes natively, padded to a cache line so that
+ * threads never share one.
+ */
+struct alignas(64) PendingFpResult {
+  FLT32 result;
+  /// Whether the result must replace the result of the instruction.
+  ADDRINT pending;
+};
+
+/// The pending result of every thread.
+PendingFpResult pending_fp_results[PIN_MAX_THREADS];
+
+/// Whether replaced operations are sampled for the overhead report.
+BOOL profile_fp_operations = FALSE;
+
+}  // namespace
+
 namespace analysis {
 namespace {
 
+/**
+ * Returns the result of a floating-point operation computed by a user defined
+ * implementation, sampling it for the overhead report if it is enabled and
+ * checking it against the error budget if it is monitored.
+ *
+ * @param[in] operation The floating-point operation.
+ * @param[in,out] fp_selector Floating-point selector which selects the
+ *     floating-point implementation to use.
+ * @param[in,out] fp_implementation Floating-point implementation selected for
+ *     every execution of the instruction, or NULL to select one with
+ *     fp_selector.
+ * @param[in,out] error_budget Error budget of the function containing the
+ *     operation, or NULL if the error budget is not monitored.
+ */
+FLT32 PerformFpOperation(const FpOperation &operation, FpSelector *fp_selector,
+                         FpImplementation *fp_implementation,
+                         FunctionErrorBudget *error_budget) {
+  if (IsExecutingNatively(error_budget)) {
+    return GetNativeFpResult(operation);
+  }
+  CountReplacedFpOperation(operation.thread_id);
+  FLT32 result;
+  if (profile_fp_operations && ProfileNextFpOperation(operation.thread_id)) {
+    result = PerformProfiledFpOperation(operation, fp_selector,
+                                        fp_implementation);
+  } else {
+    if (fp_implementation == NULL) {
+      fp_implementation = fp_selector->SelectFpImplementation(operation);
+    }
+    result = fp_implementation->PerformOperation(operation);
+  }
+  if (error_budget != NULL) {
+    return CheckFpResult(error_budget, operation, result);
+  }
+  return result;
+}
+
 /**
  * Replaces a floating-point operation with a user defined implementation.
  * This function is called for every floating-point arithmetic instruction that
@@ -23,23 +111,33 @@ namespace {
  * @param[in] operand1 First operand of the instruction.
  * @param[in] operand2 Second operand of the instruction.
  * @param[in] function_name Name of the function containing this operation.
+ * @param[in] thread_id Pin id of the thread executing the operation.
  * @param[in,out] fp_selector Floating-point selector which selects the
  *     floating-point implementation to use.
+ * @param[in,out] fp_implementation Floating-point implementation selected for
+ *     every execution of this instruction, or NULL to select one with
+ *     fp_selector.
+ * @param[in,out] error_budget Error budget of the function containing this
+ *     operation, or NULL if the error budget is not monitored.
  * @param[in,out] ctxt Context of the instrumented application, used to store
  *     the result of the floating-point operation in the correct register.
  */
 VOID ReplaceRegisterFpInstruction(const OPCODE opcode, const REG operand1,
                                   const REG operand2,
                                   const string *function_name,
-                                  FpSelector *fp_selector, CONTEXT *ctxt) {
+                                  const THREADID thread_id,
+                                  FpSelector *fp_selector,
+                                  FpImplementation *fp_implementation,
+                                  FunctionErrorBudget *error_budget,
+                                  CONTEXT *ctxt) {
   PIN_REGISTER reg1, reg2, result;
   PIN_GetContextRegval(ctxt, operand1, reg1.byte);
   PIN_GetContextRegval(ctxt, operand2, reg2.byte);
 
-  FpOperation operation(opcode, *reg1.flt, *reg2.flt, *function_name);
-  FpImplementation *fp_implementation =
-      fp_selector->SelectFpImplementation(operation);
-  *result.flt = fp_implementation->PerformOperation(operation);
+  FpOperation operation(opcode, *reg1.flt, *reg2.flt, *function_name,
+                        thread_id);
+  *result.flt = PerformFpOperation(operation, fp_selector, fp_implementation,
+                                   error_budget);
   PIN_SetContextRegval(ctxt, operand1, result.byte);
 }
 
@@ -53,25 +151,216 @@ VOID ReplaceRegisterFpInstruction(const OPCODE opcode, const REG operand1,
  * @param[in] operand1 First operand of the instruction.
  * @param[in] operand2 Second operand of the instruction
  * @param[in] function_name Name of the function containing this operation.
+ * @param[in] thread_id Pin id of the thread executing the operation.
  * @param[in,out] fp_selector Floating-point selector which selects the
  *     floating-point implementation to use.
+ * @param[in,out] fp_implementation Floating-point implementation selected for
+ *     every execution of this instruction, or NULL to select one with
+ *     fp_selector.
+ * @param[in,out] error_budget Error budget of the function containing this
+ *     operation, or NULL if the error budget is not monitored.
  * @param[in,out] ctxt Context of the instrumented application, used to store
  *     the result of the floating-point operation in the correct register.
  */
 VOID ReplaceMemoryFpInstruction(const OPCODE opcode, const REG operand1,
                                 const FLT32 *operand2,
                                 const string *function_name,
-                                FpSelector *fp_selector, CONTEXT *ctxt) {
+                                const THREADID thread_id,
+                                FpSelector *fp_selector,
+                                FpImplementation *fp_implementation,
+                                FunctionErrorBudget *error_budget,
+                                CONTEXT *ctxt) {
   PIN_REGISTER reg1, result;
   PIN_GetContextRegval(ctxt, operand1, reg1.byte);
 
-  FpOperation operation(opcode, *reg1.flt, *operand2, *function_name);
-  FpImplementation *fp_implementation =
-      fp_selector->SelectFpImplementation(operation);
-  *result.flt = fp_implementation->PerformOperation(operation);
+  FpOperation operation(opcode, *reg1.flt, *operand2, *function_name,
+                        thread_id);
+  *result.flt = PerformFpOperation(operation, fp_selector, fp_implementation,
+                                   error_budget);
   PIN_SetContextRegval(ctxt, operand1, result.byte);
 }
 
+/**
+ * Transforms the result of a floating-point instruction that executed natively.
+ * This function is called after every floating-point arithmetic instruction
+ * for which the FpSelector selected an FpResultTransform that does not only
+ * clear bits of the result.
+ *
+ * @param[in] opcode Opcode of the floating-point operation.
+ * @param[in,out] result The destination register of the instruction.
+ * @param[in,out] fp_result_transform The transform to apply to the result.
+ */
+VOID TransformFpResult(const OPCODE opcode, PIN_REGISTER *result,
+                       FpResultTransform *fp_result_transform) {
+  *result->flt = fp_result_transform->TransformResult(opcode, *result->flt);
+}
+
+/**
+ * Clears bits of the result of a floating-point instruction that executed
+ * natively. This function is simple enough for Pin to inline it.
+ * This function is called after every floating-point arithmetic instruction
+ * for which the FpSelector selected an FpResultTransform that only clears bits
+ * of the result.
+ *
+ * @param[in,out] result The destination register of the instruction.
+ * @param[in] mask The mask to AND the bit pattern of the result with.
+ */
+VOID MaskFpResult(PIN_REGISTER *result, const UINT32 mask) {
+  result->dword[0] &= mask;
+}
+
+/**
+ * Returns whether either register operand of a floating-point instruction
+ * matches the predicate of the FpSelector. This function is simple enough for
+ * Pin to inline it.
+ * This function is called before every floating-point arithmetic instruction
+ * operating on two registers for which the FpSelector selected an
+ * FpOperandPredicate.
+ *
+ * @param[in] table The table of the predicate.
+ * @param[in] operand1 First operand of the instruction.
+ * @param[in] operand2 Second operand of the instruction.
+ */
+ADDRINT MatchRegisterFpOperands(const UINT8 *table,
+                                const PIN_REGISTER *operand1,
+                                const PIN_REGISTER *operand2) {
+  return table[FpOperandPredicate::GetClass(operand1->dword[0])] |
+         table[FpOperandPredicate::GetClass(operand2->dword[0])];
+}
+
+/**
+ * Returns whether either operand of a floating-point instruction operating on
+ * a register and a memory location matches the predicate of the FpSelector.
+ * This function is simple enough for Pin to inline it.
+ * This function is called before every such floating-point arithmetic
+ * instruction for which the FpSelector selected an FpOperandPredicate.
+ *
+ * @param[in] table The table of the predicate.
+ * @param[in] operand1 First operand of the instruction.
+ * @param[in] operand2 Address of the second operand of the instruction.
+ */
+ADDRINT MatchMemoryFpOperands(const UINT8 *table,
+                              const PIN_REGISTER *operand1,
+                              const UINT32 *operand2) {
+  return table[FpOperandPredicate::GetClass(operand1->dword[0])] |
+         table[FpOperandPredicate::GetClass(*operand2)];
+}
+
+/**
+ * Computes the result of a floating-point operation with a user defined
+ * implementation and keeps it until the instruction has executed natively.
+ *
+ * @param[in] operation The floating-point operation.
+ * @param[in,out] fp_selector Floating-point selector which selects the
+ *     floating-point implementation to use.
+ * @param[in,out] fp_implementation Floating-point implementation selected for
+ *     every execution of this instruction, or NULL to select one with
+ *     fp_selector.
+ * @param[in,out] error_budget Error budget of the function containing this
+ *     operation, or NULL if the error budget is not monitored.
+ */
+VOID ComputePendingFpResult(const FpOperation &operation,
+                            FpSelector *fp_selector,
+                            FpImplementation *fp_implementation,
+                            FunctionErrorBudget *error_budget) {
+  PendingFpResult &pending_fp_result =
+      pending_fp_results[operation.thread_id];
+  pending_fp_result.result = PerformFpOperation(
+      operation, fp_selector, fp_implementation, error_budget);
+  pending_fp_result.pending = TRUE;
+}
+
+/**
+ * Computes the replacement result of a floating-point operation on two
+ * registers.
+ * This function is called before every floating-point arithmetic instruction
+ * operating on two registers whose operands match the predicate of the
+ * FpSelector.
+ *
+ * @param[in] opcode Opcode of the floating-point operation.
+ * @param[in] operand1 First operand of the instruction.
+ * @param[in] operand2 Second operand of the instruction.
+ * @param[in] function_name Name of the function containing this operation.
+ * @param[in] thread_id Pin id of the thread executing the operation.
+ * @param[in,out] fp_selector Floating-point selector which selects the
+ *     floating-point implementation to use.
+ * @param[in,out] fp_implementation Floating-point implementation selected for
+ *     every execution of this instruction, or NULL to select one with
+ *     fp_selector.
+ * @param[in,out] error_budget Error budget of the function containing this
+ *     operation, or NULL if the error budget is not monitored.
+ */
+VOID ComputeRegisterFpResult(const OPCODE opcode,
+                             const PIN_REGISTER *operand1,
+                             const PIN_REGISTER *operand2,
+                             const string *function_name,
+                             const THREADID thread_id, FpSelector *fp_selector,
+                             FpImplementation *fp_implementation,
+                             FunctionErrorBudget *error_budget) {
+  const FpOperation operation(opcode, *operand1->flt, *operand2->flt,
+                              *function_name, thread_id);
+  ComputePendingFpResult(operation, fp_selector, fp_implementation,
+                         error_budget);
+}
+
+/**
+ * Computes the replacement result of a floating-point operation on a
+ * register and a memory location.
+ * This function is called before every such floating-point arithmetic
+ * instruction whose operands match the predicate of the FpSelector.
+ *
+ * @param[in] opcode Opcode of the floating-point operation.
+ * @param[in] operand1 First operand of the instruction.
+ * @param[in] operand2 Address of the second operand of the instruction.
+ * @param[in] function_name Name of the function containing this operation.
+ * @param[in] thread_id Pin id of the thread executing the operation.
+ * @param[in,out] fp_selector Floating-point selector which selects the
+ *     floating-point implementation to use.
+ * @param[in,out] fp_implementation Floating-point implementation selected for
+ *     every execution of this instruction, or NULL to select one with
+ *     fp_selector.
+ * @param[in,out] error_budget Error budget of the function containing this
+ *     operation, or NULL if the error budget is not monitored.
+ */
+VOID ComputeMemoryFpResult(const OPCODE opcode, const PIN_REGISTER *operand1,
+                           const FLT32 *operand2, const string *function_name,
+                           const THREADID thread_id, FpSelector *fp_selector,
+                           FpImplementation *fp_implementation,
+                           FunctionErrorBudget *error_budget) {
+  const FpOperation operation(opcode, *operand1->flt, *operand2,
+                              *function_name, thread_id);
+  ComputePendingFpResult(operation, fp_selector, fp_implementation,
+                         error_budget);
+}
+
+/**
+ * Returns whether the result of the floating-point instruction that a thread
+ * just executed must be replaced. This function is simple enough for Pin to
+ * inline it.
+ * This function is called after every floating-point arithmetic instruction
+ * for which the FpSelector selected an FpOperandPredicate.
+ *
+ * @param[in] thread_id Pin id of the thread executing the instruction.
+ */
+ADDRINT HasPendingFpResult(const THREADID thread_id) {
+  return pending_fp_results[thread_id].pending;
+}
+
+/**
+ * Replaces the result of the floating-point instruction that a thread just
+ * executed with the result computed before it executed.
+ * This function is called after every floating-point arithmetic instruction
+ * whose operands matched the predicate of the FpSelector.
+ *
+ * @param[in,out] result The destination register of the instruction.
+ * @param[in] thread_id Pin id of the thread executing the instruction.
+ */
+VOID WritePendingFpResult(PIN_REGISTER *result, const THREADID thread_id) {
+  PendingFpResult &pending_fp_result = pending_fp_results[thread_id];
+  *result->flt = pending_fp_result.result;
+  pending_fp_result.pending = FALSE;
+}
+
 /**
  * Performs any per-function setup needed by the given floating-point selector.
  * This function is called every time a new function is entered in the
@@ -79,10 +368,12 @@ VOID ReplaceMemoryFpInstruction(const OPCODE opcode, const REG operand1,
  * command line.
  *
  * @param[in] function_name The name of the function being entered.
+ * @param[in] thread_id The Pin id of the thread entering the function.
  * @param[in,out] fp_selector The floating-point selector.
  */
-VOID EnterFunction(const string *function_name, FpSelector *fp_selector) {
-  fp_selector->OnFunctionStart(*function_name);
+VOID EnterFunction(const string *function_name, const THREADID thread_id,
+                   FpSelector *fp_selector) {
+  fp_selector->OnFunctionStartInThread(*function_name, thread_id);
 }
 
 /**
@@ -93,10 +384,49 @@ VOID EnterFunction(const string *function_name, FpSelector *fp_selector) {
  * command line.
  *
  * @param[in] function_name The name of the function being exited.
+ * @param[in] thread_id The Pin id of the thread exiting the function.
  * @param[in,out] fp_selector The floating-point selector.
  */
-VOID ExitFunction(const string *function_name, FpSelector *fp_selector) {
-  fp_selector->OnFunctionEnd(*function_name);
+VOID ExitFunction(const string *function_name, const THREADID thread_id,
+                  FpSelector *fp_selector) {
+  fp_selector->OnFunctionEndInThread(*function_name, thread_id);
+}
+
+/**
+ * Counts a floating-point operation executed natively while the FpSelector
+ * passes through. This function is simple enough for Pin to inline it.
+ * This function is called before every floating-point arithmetic instruction
+ * while the FpSelector passes through with a limit on the number of
+ * floating-point operations.
+ *
+ * @return Whether the limit has been exceeded, so that this operation must not
+ *     execute natively.
+ */
+ADDRINT CountPassThroughFpOp() { return --pass_through_fp_ops_left < 0; }
+
+/**
+ * Ends the pass-through of the given floating-point selector, then discards
+ * all instrumented code and resumes the instrumented application from the
+ * current instruction so that it is instrumented again. Never returns.
+ * This function is called when a floating-point operation limit is reached or
+ * a trigger function is entered while the FpSelector passes through.
+ *
+ * @param[in] thread_id The Pin id of the thread hitting the trigger.
+ * @param[in,out] fp_selector The floating-point selector.
+ * @param[in] ctxt Context of the instrumented application to resume from.
+ */
+VOID EndPassThrough(const THREADID thread_id, FpSelector *fp_selector,
+                    const CONTEXT *ctxt) {
+  LockMutex(&pass_through_lock, kPassThroughMutex);
+  // Other threads may reach the trigger before the code is instrumented again,
+  // but only the first one ends the pass-through.
+  if (instrumenting_pass_through) {
+    fp_selector->EndPassThrough(thread_id);
+    instrumenting_pass_through = FALSE;
+    PIN_RemoveInstrumentation();
+  }
+  PIN_MutexUnlock(&pass_through_lock);
+  PIN_ExecuteAt(ctxt);
 }
 
 }  // namespace
@@ -127,6 +457,309 @@ VOID ExitCallback(const INT32 code, FpSelector *fp_selector) {
   fp_selector->ExitCallback(code);
 }
 
+/**
+ * Performs any per-thread setup needed by the given floating-point selector.
+ * This function is called in every new thread of the instrumented application
+ * before it runs if the KnobFpSelectorName flag is supplied on the command
+ * line.
+ *
+ * @param[in] thread_id The Pin id of the new thread.
+ * @param[in,out] ctxt Initial register state of the thread.
+ * @param[in] flags OS specific flags for the thread.
+ * @param[in,out] fp_selector The floating-point selector.
+ */
+VOID ThreadStartCallback(const THREADID thread_id, CONTEXT *ctxt,
+                         const INT32 flags, FpSelector *fp_selector) {
+  fp_selector->OnThreadStart(thread_id);
+}
+
+/**
+ * Performs any per-thread teardown needed by the given floating-point
+ * selector.
+ * This function is called whenever a thread of the instrumented application
+ * ends if the KnobFpSelectorName flag is supplied on the command line.
+ *
+ * @param[in] thread_id The Pin id of the ending thread.
+ * @param[in] ctxt Final register state of the thread.
+ * @param[in] code OS specific termination code for the thread.
+ * @param[in,out] fp_selector The floating-point selector.
+ */
+VOID ThreadFiniCallback(const THREADID thread_id, const CONTEXT *ctxt,
+                        const INT32 code, FpSelector *fp_selector) {
+  fp_selector->OnThreadFini(thread_id);
+}
+
+/**
+ * Releases the lock of the pass-through in the forked process, where the
+ * thread that may have held it when the application forked does not exist.
+ * This function is called in the child process after every fork if the
+ * KnobFpSelectorName flag is supplied on the command line.
+ *
+ * @param[in] thread_id Pin id of the forking thread.
+ * @param[in] ctxt Unused.
+ * @param[in] fp_selector Unused.
+ */
+VOID AfterForkInChild(const THREADID thread_id, const CONTEXT *ctxt,
+                      FpSelector *fp_selector) {
+  PIN_MutexInit(&pass_through_lock);
+}
+
+/**
+ * Schedule calls to analysis routines to replace the result of a
+ * floating-point instruction only when its operands match a predicate. The
+ * instruction always executes natively, and its result is overwritten when
+ * the predicate matched, so operations that do not match only pay for the
+ * inlined predicate.
+ *
+ * @param[in] ins Floating-point instruction to be instrumented.
+ * @param[in] function_name Name of the function containing the instruction.
+ * @param[in] fp_selector The floating-point selector to use.
+ * @param[in] fp_implementation Floating-point implementation selected for
+ *     every execution of the instruction, or NULL to select one dynamically.
+ * @param[in] fp_operand_predicate The predicate selecting which executions to
+ *     replace.
+ * @param[in] error_budget Error budget of the function containing the
+ *     instruction, or NULL if the error budget is not monitored.
+ */
+VOID InstrumentPredicatedFpInstruction(
+    const INS ins, const string &function_name, FpSelector *fp_selector,
+    FpImplementation *fp_implementation,
+    const FpOperandPredicate *fp_operand_predicate,
+    FunctionErrorBudget *error_budget) {
+  if (INS_OperandIsReg(ins, 1)) {
+    // clang-format off
+    INS_InsertIfCall(
+        ins, IPOINT_BEFORE,
+        reinterpret_cast<AFUNPTR>(analysis::MatchRegisterFpOperands),
+        IARG_PTR, fp_operand_predicate->GetTable(),
+        IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 0),
+        IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 1),
+        IARG_END);
+    INS_InsertThenCall(
+        ins, IPOINT_BEFORE,
+        reinterpret_cast<AFUNPTR>(analysis::ComputeRegisterFpResult),
+        IARG_UINT32, INS_Opcode(ins),
+        IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 0),
+        IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 1),
+        IARG_PTR, &function_name,
+        IARG_THREAD_ID,
+        IARG_PTR, fp_selector,
+        IARG_PTR, fp_implementation,
+        IARG_PTR, error_budget,
+        IARG_END);
+    // clang-format on
+  } else {
+    // clang-format off
+    INS_InsertIfCall(
+        ins, IPOINT_BEFORE,
+        reinterpret_cast<AFUNPTR>(analysis::MatchMemoryFpOperands),
+        IARG_PTR, fp_operand_predicate->GetTable(),
+        IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 0),
+        IARG_MEMORYREAD_EA,
+        IARG_END);
+    INS_InsertThenCall(
+        ins, IPOINT_BEFORE,
+        reinterpret_cast<AFUNPTR>(analysis::ComputeMemoryFpResult),
+        IARG_UINT32, INS_Opcode(ins),
+        IARG_REG_CONST_REFERENCE, INS_OperandReg(ins, 0),
+        IARG_MEMORYREAD_EA,
+        IARG_PTR, &function_name,
+        IARG_THREAD_ID,
+        IARG_PTR, fp_selector,
+        IARG_PTR, fp_implementation,
+        IARG_PTR, error_budget,
+        IARG_END);
+    // clang-format on
+  }
+
+  // Overwrite the result before any other analysis routine reads it.
+  // clang-format off
+  INS_InsertIfCall(
+      ins, IPOINT_AFTER,
+      reinterpret_cast<AFUNPTR>(analysis::HasPendingFpResult),
+      IARG_THREAD_ID,
+      IARG_CALL_ORDER, CALL_ORDER_FIRST,
+      IARG_END);
+  INS_InsertThenCall(
+      ins, IPOINT_AFTER,
+      reinterpret_cast<AFUNPTR>(analysis::WritePendingFpResult),
+      IARG_REG_REFERENCE, INS_OperandReg(ins, 0),
+      IARG_THREAD_ID,
+      IARG_CALL_ORDER, CALL_ORDER_FIRST,
+      IARG_END);
+  // clang-format on
+}
+
+/**
+ * Schedule calls to analysis routines that end the pass-through of the
+ * floating-point selector, leaving every floating-point instruction of the
+ * routine to execute natively.
+ * This function is called every time a new routine is encountered while the
+ * FpSelector passes through.
+ *
+ * @param[in] rtn Routine to be instrumented.
+ * @param[in] fp_selector The floating-point selector to use.
+ */
+VOID InstrumentPassThroughRoutine(const RTN rtn, FpSelector *fp_selector) {
+  if (!instrumenting_pass_through) {
+    pass_through_fp_ops_left =
+        static_cast<INT64>(fp_selector->GetPassThroughFpOpLimit());
+    instrumenting_pass_through = TRUE;
+  }
+
+  RTN_Open(rtn);
+  if (fp_selector->IsPassThroughTrigger(RTN_Name(rtn))) {
+    // clang-format off
+    RTN_InsertCall(
+        rtn, IPOINT_BEFORE,
+        reinterpret_cast<AFUNPTR>(analysis::EndPassThrough),
+        IARG_THREAD_ID,
+        IARG_PTR, fp_selector,
+        IARG_CONST_CONTEXT,
+        IARG_END);
+    // clang-format on
+  }
+  if (fp_selector->GetPassThroughFpOpLimit() > 0) {
+    for (INS ins = RTN_InsHead(rtn); INS_Valid(ins); ins = INS_Next(ins)) {
+      if (!IsFpInstruction(ins)) {
+        continue;
+      }
+      // The instruction executes again once the pass-through ends, so run
+      // before analysis routines of other modules that would see it twice.
+      // clang-format off
+      INS_InsertIfCall(
+          ins, IPOINT_BEFORE,
+          reinterpret_cast<AFUNPTR>(analysis::CountPassThroughFpOp),
+          IARG_CALL_ORDER, CALL_ORDER_FIRST,
+          IARG_END);
+      INS_InsertThenCall(
+          ins, IPOINT_BEFORE,
+          reinterpret_cast<AFUNPTR>(analysis::EndPassThrough),
+          IARG_THREAD_ID,
+          IARG_PTR, fp_selector,
+          IARG_CONST_CONTEXT,
+          IARG_CALL_ORDER, CALL_ORDER_FIRST,
+          IARG_END);
+      // clang-format on
+      CountAnalysisCalls(ins, kReplaceFpOpsFeature, 1);
+    }
+  }
+  RTN_Close(rtn);
+}
+
+/**
+ * Schedule calls to analysis routines to replace a floating-point instruction
+ * with a user-defined implementation, or to transform its result.
+ *
+ * @param[in] ins Floating-point instruction to be instrumented.
+ * @param[in] function_name Name of the function containing the instruction,
+ *     which must stay valid while the instruction may execute.
+ * @param[in] image_name Name of the image containing the instruction.
+ * @param[in] image_address Address the image containing the instruction is
+ *     loaded at.
+ * @param[in] fp_selector The floating-point selector to use.
+ */
+VOID InstrumentFpInstruction(const INS ins, const string &function_name,
+                             const string &image_name,
+                             const ADDRINT image_address,
+                             FpSelector *fp_selector) {
+  // Functions that exceeded the error budget execute natively.
+  FunctionErrorBudget *error_budget = GetFunctionErrorBudget(function_name);
+  if (IsExecutingNatively(error_budget)) {
+    return;
+  }
+
+  // Instructions whose result is only transformed execute natively. The
+  // transform runs before any other analysis routine reads the result.
+  const FpInstruction instruction(INS_Opcode(ins), function_name, image_name,
+                                  INS_Address(ins) - image_address);
+  FpResultTransform *fp_result_transform =
+      fp_selector->SelectFpResultTransform(instruction);
+  if (fp_result_transform != NULL) {
+    UINT32 mask;
+    if (fp_result_transform->GetResultMask(&mask)) {
+      // clang-format off
+      INS_InsertCall(
+          ins, IPOINT_AFTER,
+          reinterpret_cast<AFUNPTR>(analysis::MaskFpResult),
+          IARG_REG_REFERENCE, INS_OperandReg(ins, 0),
+          IARG_UINT32, mask,
+          IARG_CALL_ORDER, CALL_ORDER_FIRST,
+          IARG_END);
+      // clang-format on
+    } else {
+      // clang-format off
+      INS_InsertCall(
+          ins, IPOINT_AFTER,
+          reinterpret_cast<AFUNPTR>(analysis::TransformFpResult),
+          IARG_UINT32, INS_Opcode(ins),
+          IARG_REG_REFERENCE, INS_OperandReg(ins, 0),
+          IARG_PTR, fp_result_transform,
+          IARG_CALL_ORDER, CALL_ORDER_FIRST,
+          IARG_END);
+      // clang-format on
+    }
+    CountAnalysisCalls(ins, kReplaceFpOpsFeature, 1);
+    return;
+  }
+
+  FpImplementation *fp_implementation =
+      fp_selector->SelectStaticFpImplementation(instruction);
+  const FpOperandPredicate *fp_operand_predicate =
+      fp_selector->SelectFpOperandPredicate(instruction);
+  if (fp_operand_predicate != NULL) {
+    InstrumentPredicatedFpInstruction(ins, function_name, fp_selector,
+                                      fp_implementation, fp_operand_predicate,
+                                      error_budget);
+    // Only the predicates run on every execution.
+    CountAnalysisCalls(ins, kReplaceFpOpsFeature, 2);
+    return;
+  }
+
+  REGSET regs_in, regs_out;
+  REGSET_Clear(regs_in);
+  REGSET_Clear(regs_out);
+  REGSET_Insert(regs_in, INS_OperandReg(ins, 0));
+  REGSET_Insert(regs_out, INS_OperandReg(ins, 0));
+
+  INS_Delete(ins);
+  CountAnalysisCalls(ins, kReplaceFpOpsFeature, 1);
+  if (INS_OperandIsReg(ins, 1)) {
+    REGSET_Insert(regs_in, INS_OperandReg(ins, 1));
+    // clang-format off
+    INS_InsertCall(
+        ins, IPOINT_BEFORE,
+        reinterpret_cast<AFUNPTR>(analysis::ReplaceRegisterFpInstruction),
+        IARG_UINT32, INS_Opcode(ins),
+        IARG_UINT32, INS_OperandReg(ins, 0),
+        IARG_UINT32, INS_OperandReg(ins, 1),
+        IARG_PTR, &function_name,
+        IARG_THREAD_ID,
+        IARG_PTR, fp_selector,
+        IARG_PTR, fp_implementation,
+        IARG_PTR, error_budget,
+        IARG_PARTIAL_CONTEXT, &regs_in, &regs_out,
+        IARG_END);
+    // clang-format on
+  } else {
+    // clang-format off
+    INS_InsertCall(
+        ins, IPOINT_BEFORE,
+        reinterpret_cast<AFUNPTR>(analysis::ReplaceMemoryFpInstruction),
+        IARG_UINT32, INS_Opcode(ins),
+        IARG_UINT32, INS_OperandReg(ins, 0),
+        IARG_MEMORYREAD_EA,
+        IARG_PTR, &function_name,
+        IARG_THREAD_ID,
+        IARG_PTR, fp_selector,
+        IARG_PTR, fp_implementation,
+        IARG_PTR, error_budget,
+        IARG_PARTIAL_CONTEXT, &regs_in, &regs_out,
+        IARG_END);
+    // clang-format on
+  }
+}
+
 /**
  * Schedule calls to analysis routines to replace every floating-point operation
  * in the instrumented application with a user-defined implementation.
@@ -138,6 +771,24 @@ VOID ExitCallback(const INT32 code, FpSelector *fp_selector) {
  * @param[in] fp_selector The floating-point selector to use.
  */
 VOID InstrumentationCallback(const RTN rtn, FpSelector *fp_selector) {
+  const OverheadCallbackTimer timer(kReplaceRoutineCallback);
+  if (!IsInRegionOfInterest()) {
+    return;
+  }
+
+  if (fp_selector->IsPassThrough()) {
+    InstrumentPassThroughRoutine(rtn, fp_selector);
+    return;
+  }
+  instrumenting_pass_through = FALSE;
+
+  // Routines without floating-point instructions are only instrumented for
+  // FpSelectors tracking the functions being called.
+  if (!fp_selector->NeedsFunctionCallbacks() &&
+      !MayContainFpInstructions(rtn)) {
+    return;
+  }
+
   RTN_Open(rtn);
   const string &function_name = RTN_Name(rtn);
   // clang-format off
@@ -145,49 +796,22 @@ VOID InstrumentationCallback(const RTN rtn, FpSelector *fp_selector) {
       rtn, IPOINT_BEFORE,
       reinterpret_cast<AFUNPTR>(analysis::EnterFunction),
       IARG_PTR, &function_name,
+      IARG_THREAD_ID,
       IARG_PTR, fp_selector,
       IARG_END);
   // clang-format on
+  // Every call of the routine enters and exits it once.
+  CountAnalysisCalls(RTN_InsHead(rtn), kReplaceFpOpsFeature, 2);
 
   // Pass through every instruction in the routine and replace every
-  // floating-point instruction.
+  // floating-point instruction or transform its result.
+  const IMG img = SEC_Img(RTN_Sec(rtn));
+  const string image_name = IMG_Valid(img) ? IMG_Name(img) : "";
+  const ADDRINT image_address = IMG_Valid(img) ? IMG_LowAddress(img) : 0;
   for (INS ins = RTN_InsHead(rtn); INS_Valid(ins); ins = INS_Next(ins)) {
     if (IsFpInstruction(ins)) {
-      REGSET regs_in, regs_out;
-      REGSET_Clear(regs_in);
-      REGSET_Clear(regs_out);
-      REGSET_Insert(regs_in, INS_OperandReg(ins, 0));
-      REGSET_Insert(regs_out, INS_OperandReg(ins, 0));
-
-      INS_Delete(ins);
-      if (INS_OperandIsReg(ins, 1)) {
-        REGSET_Insert(regs_in, INS_OperandReg(ins, 1));
-        // clang-format off
-        INS_InsertCall(
-            ins, IPOINT_BEFORE,
-            reinterpret_cast<AFUNPTR>(analysis::ReplaceRegisterFpInstruction),
-            IARG_UINT32, INS_Opcode(ins),
-            IARG_UINT32, INS_OperandReg(ins, 0),
-            IARG_UINT32, INS_OperandReg(ins, 1),
-            IARG_PTR, &function_name,
-            IARG_PTR, fp_selector,
-            IARG_PARTIAL_CONTEXT, &regs_in, &regs_out,
-            IARG_END);
-        // clang-format on
-      } else {
-        // clang-format off
-        INS_InsertCall(
-            ins, IPOINT_BEFORE,
-            reinterpret_cast<AFUNPTR>(analysis::ReplaceMemoryFpInstruction),
-            IARG_UINT32, INS_Opcode(ins),
-            IARG_UINT32, INS_OperandReg(ins, 0),
-            IARG_MEMORYREAD_EA,
-            IARG_PTR, &function_name,
-            IARG_PTR, fp_selector,
-            IARG_PARTIAL_CONTEXT, &regs_in, &regs_out,
-            IARG_END);
-        // clang-format on
-      }
+      InstrumentFpInstruction(ins, function_name, image_name, image_address,
+                              fp_selector);
     }
   }
   // clang-format off
@@ -195,24 +819,81 @@ VOID InstrumentationCallback(const RTN rtn, FpSelector *fp_selector) {
       rtn, IPOINT_AFTER,
       reinterpret_cast<AFUNPTR>(analysis::ExitFunction),
       IARG_PTR, &function_name,
+      IARG_THREAD_ID,
       IARG_PTR, fp_selector,
       IARG_END);
   // clang-format on
   RTN_Close(rtn);
 }
 
+/**
+ * Schedule calls to analysis routines to replace every floating-point operation
+ * in a trace with a user-defined implementation, whether or not it belongs to
+ * a known routine.
+ * This function is called every time a new trace is encountered if the
+ * KnobTraceInstrumentation flag is supplied on the command line.
+ *
+ * @param[in] trace Trace to be instrumented.
+ * @param[in] fp_selector The floating-point selector to use.
+ */
+VOID TraceInstrumentationCallback(const TRACE trace, FpSelector *fp_selector) {
+  const OverheadCallbackTimer timer(kReplaceTraceCallback);
+  if (!IsInRegionOfInterest()) {
+    return;
+  }
+
+  for (BBL bbl = TRACE_BblHead(trace); BBL_Valid(bbl); bbl = BBL_Next(bbl)) {
+    for (INS ins = BBL_InsHead(bbl); INS_Valid(ins); ins = INS_Next(ins)) {
+      if (!IsFpInstruction(ins)) {
+        continue;
+      }
+      const IMG img = IMG_FindByAddress(INS_Address(ins));
+      InstrumentFpInstruction(ins, GetFunctionName(INS_Address(ins)),
+                              IMG_Valid(img) ? IMG_Name(img) : "",
+                              IMG_Valid(img) ? IMG_LowAddress(img) : 0,
+                              fp_selector);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace callbacks
 
-VOID ReplaceFpOperations(FpSelector *fp_selector) {
+VOID ReplaceFpOperations(FpSelector *fp_selector, const BOOL use_traces) {
+  if (use_traces && fp_selector->NeedsFunctionCallbacks()) {
+    cerr << "Trace instrumentation cannot be used with FpSelectors that need "
+            "function callbacks"
+         << endl;
+    exit(1);
+  }
+  PIN_MutexInit(&pass_through_lock);
+  profile_fp_operations = IsOverheadReportEnabled();
+
   PIN_AddApplicationStartFunction(
       reinterpret_cast<APPLICATION_START_CALLBACK>(callbacks::StartCallback),
       fp_selector);
   PIN_AddFiniFunction(reinterpret_cast<FINI_CALLBACK>(callbacks::ExitCallback),
                       fp_selector);
-  RTN_AddInstrumentFunction(reinterpret_cast<RTN_INSTRUMENT_CALLBACK>(
-                                callbacks::InstrumentationCallback),
-                            fp_selector);
+  PIN_AddThreadStartFunction(reinterpret_cast<THREAD_START_CALLBACK>(
+                                 callbacks::ThreadStartCallback),
+                             fp_selector);
+  PIN_AddThreadFiniFunction(
+      reinterpret_cast<THREAD_FINI_CALLBACK>(callbacks::ThreadFiniCallback),
+      fp_selector);
+  PIN_AddForkFunction(
+      FPOINT_AFTER_IN_CHILD,
+      reinterpret_cast<FORK_CALLBACK>(callbacks::AfterForkInChild),
+      fp_selector);
+  if (use_traces) {
+    InitFunctionAttribution();
+    TRACE_AddInstrumentFunction(reinterpret_cast<TRACE_INSTRUMENT_CALLBACK>(
+                                    callbacks::TraceInstrumentationCallback),
+                                fp_selector);
+  } else {
+    RTN_AddInstrumentFunction(reinterpret_cast<RTN_INSTRUMENT_CALLBACK>(
+                                  callbacks::InstrumentationCallback),
+                              fp_selector);
+  }
 }
 
 }  // namespace NEAT
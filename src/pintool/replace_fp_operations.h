@@ -13,8 +13,11 @@ namespace NEAT {
  * user-defined implementations.
  *
  * @param[in,out] fp_selector The floating-point selector.
+ * @param[in] use_traces Whether to instrument traces instead of routines, which
+ *     also replaces operations in code without routine symbols but cannot be
+ *     used with FpSelectors that need function callbacks.
  */
-VOID ReplaceFpOperations(FpSelector *fp_selector);
+VOID ReplaceFpOperations(FpSelector *fp_selector, const BOOL use_traces);
 
 }  // namespace NEAT
 
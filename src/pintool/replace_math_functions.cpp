@@ -0,0 +1,141 @@
+#include "pintool/replace_math_functions.h"
+
+#include <pin.H>
+
+#include "client_lib/interfaces/math_implementation.h"
+#include "client_lib/utils/math_call.h"
+#include "client_lib/utils/math_function.h"
+#include "pintool/live_statistics.h"
+#include "pintool/overhead_report.h"
+
+namespace NEAT {
+namespace {
+
+/// The signature of every replaced function, allocated when the first image
+/// containing it is loaded.
+PROTO math_function_prototypes[kNumMathFunctions];
+
+}  // namespace
+
+namespace analysis {
+namespace {
+
+/**
+ * Evaluates a call to a function of the math library with a user defined
+ * implementation. The arguments are read from the registers used to pass
+ * them in the System V x86-64 calling convention.
+ * This function replaces every function of the math library that the
+ * MathImplementation replaces.
+ *
+ * @param[in,out] math_implementation The math implementation.
+ * @param[in] function The function called.
+ * @param[in] argument1 Register holding the first argument of the call.
+ * @param[in] argument2 Register holding the second argument of the call, if
+ *     any.
+ * @param[in] thread_id Pin id of the thread performing the call.
+ * @return The result of the call.
+ */
+FLT32 ReplaceMathFunction(MathImplementation *math_implementation,
+                          const UINT32 function,
+                          const PIN_REGISTER *argument1,
+                          const PIN_REGISTER *argument2,
+                          const THREADID thread_id) {
+  const MathFunction math_function = static_cast<MathFunction>(function);
+  const MathCall call(math_function, *argument1->flt,
+                      GetMathFunctionNumArguments(math_function) > 1
+                          ? *argument2->flt
+                          : 0.0f,
+                      thread_id);
+  CountAnalysisCall(thread_id, kReplaceMathFunctionsFeature);
+  CountReplacedMathCall(thread_id);
+  return math_implementation->Evaluate(call);
+}
+
+}  // namespace
+}  // namespace analysis
+
+namespace callbacks {
+namespace {
+
+/**
+ * Returns the signature of a function of the math library, allocating it the
+ * first time.
+ *
+ * @param[in] function The function of the math library.
+ */
+PROTO GetMathFunctionPrototype(const MathFunction function) {
+  if (math_function_prototypes[function] == NULL) {
+    const char *name = GetMathFunctionName(function);
+    math_function_prototypes[function] =
+        GetMathFunctionNumArguments(function) == 1
+            ? PROTO_Allocate(PIN_PARG(float), CALLINGSTD_DEFAULT, name,
+                             PIN_PARG(float), PIN_PARG_END())
+            : PROTO_Allocate(PIN_PARG(float), CALLINGSTD_DEFAULT, name,
+                             PIN_PARG(float), PIN_PARG(float),
+                             PIN_PARG_END());
+  }
+  return math_function_prototypes[function];
+}
+
+/**
+ * Replaces the functions of the math library defined in an image with the
+ * MathImplementation.
+ * This function is called every time a new image is loaded, before any of its
+ * code runs.
+ *
+ * @param[in] img Image to be instrumented.
+ * @param[in,out] math_implementation The math implementation.
+ */
+VOID InstrumentationCallback(const IMG img,
+                             MathImplementation *math_implementation) {
+  const OverheadCallbackTimer timer(kReplaceMathImageCallback);
+  for (UINT32 function = 0; function < kNumMathFunctions; function++) {
+    const MathFunction math_function = static_cast<MathFunction>(function);
+    if (!math_implementation->ReplacesMathFunction(math_function)) {
+      continue;
+    }
+    const RTN rtn = RTN_FindByName(img, GetMathFunctionName(math_function));
+    if (!RTN_Valid(rtn)) {
+      continue;
+    }
+    // clang-format off
+    RTN_ReplaceSignature(
+        rtn, reinterpret_cast<AFUNPTR>(analysis::ReplaceMathFunction),
+        IARG_PROTOTYPE, GetMathFunctionPrototype(math_function),
+        IARG_PTR, math_implementation,
+        IARG_UINT32, function,
+        IARG_REG_CONST_REFERENCE, REG_XMM0,
+        IARG_REG_CONST_REFERENCE, REG_XMM1,
+        IARG_THREAD_ID,
+        IARG_END);
+    // clang-format on
+  }
+}
+
+/**
+ * Frees the signatures of the replaced functions.
+ * This function is called immediately before the instrumented application
+ * exits.
+ *
+ * @param[in] code Exit code of the pintool.
+ * @param[in] v Unused.
+ */
+VOID FreePrototypes(const INT32 code, VOID *v) {
+  for (UINT32 function = 0; function < kNumMathFunctions; function++) {
+    if (math_function_prototypes[function] != NULL) {
+      PROTO_Free(math_function_prototypes[function]);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace callbacks
+
+VOID ReplaceMathFunctions(MathImplementation *math_implementation) {
+  IMG_AddInstrumentFunction(
+      reinterpret_cast<IMAGECALLBACK>(callbacks::InstrumentationCallback),
+      math_implementation);
+  PIN_AddFiniFunction(callbacks::FreePrototypes, NULL);
+}
+
+}  // namespace NEAT
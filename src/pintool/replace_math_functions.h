@@ -0,0 +1,22 @@
+#ifndef PINTOOL_REPLACE_MATH_FUNCTIONS_H_
+#define PINTOOL_REPLACE_MATH_FUNCTIONS_H_
+
+#include <pin.H>
+
+#include "client_lib/interfaces/math_implementation.h"
+
+namespace NEAT {
+
+/**
+ * Replaces every call to the single-precision functions of the application's
+ * math library, such as expf, with the supplied math implementation. The
+ * instructions of replaced functions never execute, so they are neither
+ * replaced nor counted by the other features.
+ *
+ * @param[in,out] math_implementation The math implementation.
+ */
+VOID ReplaceMathFunctions(MathImplementation *math_implementation);
+
+}  // namespace NEAT
+
+#endif  // PINTOOL_REPLACE_MATH_FUNCTIONS_H_
@@ -0,0 +1,109 @@
+/*! @file
+ * This is a benchmark repeatedly computing an iterative radix-2 fast Fourier
+ * transform of single-precision complex numbers.
+ *
+ * Usage: benchmark_fft [<log2 of the transform size> [<number of transforms>]]
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_LOG_SIZE 16
+#define DEFAULT_NUM_TRANSFORMS 16
+#define PI 3.14159265358979f
+
+/**
+ * Transforms n complex numbers in place, where n is a power of two.
+ * @param[in,out]   re              real parts
+ * @param[in,out]   im              imaginary parts
+ * @param[in]       twiddle_re      real parts of the n / 2 twiddle factors
+ * @param[in]       twiddle_im      imaginary parts of the twiddle factors
+ * @param[in]       n               number of complex numbers
+ */
+void fft(float *re, float *im, const float *twiddle_re,
+         const float *twiddle_im, int n) {
+  // Reorder the input by bit-reversed index.
+  for (int i = 1, j = 0; i < n; i++) {
+    int bit = n >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      float tmp = re[i];
+      re[i] = re[j];
+      re[j] = tmp;
+      tmp = im[i];
+      im[i] = im[j];
+      im[j] = tmp;
+    }
+  }
+
+  for (int length = 2; length <= n; length <<= 1) {
+    const int stride = n / length;
+    for (int start = 0; start < n; start += length) {
+      for (int k = 0; k < length / 2; k++) {
+        const float w_re = twiddle_re[k * stride];
+        const float w_im = twiddle_im[k * stride];
+        const int even = start + k;
+        const int odd = even + length / 2;
+        const float t_re = re[odd] * w_re - im[odd] * w_im;
+        const float t_im = re[odd] * w_im + im[odd] * w_re;
+        re[odd] = re[even] - t_re;
+        im[odd] = im[even] - t_im;
+        re[even] = re[even] + t_re;
+        im[even] = im[even] + t_im;
+      }
+    }
+  }
+}
+
+/**
+ * Prints the bits of a float in hex. The kernels are optimized, so the bits are
+ * copied rather than read through a type-punned pointer.
+ * @param[in]   value           the value to print
+ */
+static void print_hex(const float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  printf("%08x\n", bits);
+}
+
+/**
+ * The main procedure of the application.
+ * @param[in]   argc            total number of elements in the argv array
+ * @param[in]   argv            array of command line arguments
+ */
+int main(int argc, char *argv[]) {
+  const int n = 1 << (argc > 1 ? atoi(argv[1]) : DEFAULT_LOG_SIZE);
+  const int num_transforms = argc > 2 ? atoi(argv[2]) : DEFAULT_NUM_TRANSFORMS;
+  float *re = malloc(sizeof(float) * n);
+  float *im = malloc(sizeof(float) * n);
+  float *twiddle_re = malloc(sizeof(float) * n / 2);
+  float *twiddle_im = malloc(sizeof(float) * n / 2);
+
+  for (int k = 0; k < n / 2; k++) {
+    twiddle_re[k] = cosf(-2.0f * PI * k / n);
+    twiddle_im[k] = sinf(-2.0f * PI * k / n);
+  }
+
+  float checksum = 0.0f;
+  for (int transform = 0; transform < num_transforms; transform++) {
+    for (int i = 0; i < n; i++) {
+      re[i] = (float)((i + transform) % 11) - 5.0f;
+      im[i] = (float)(i % 5) - 2.0f;
+    }
+    fft(re, im, twiddle_re, twiddle_im, n);
+    checksum += re[transform] + im[n - 1 - transform];
+  }
+  print_hex(checksum);
+
+  free(re);
+  free(im);
+  free(twiddle_re);
+  free(twiddle_im);
+  return 0;
+}
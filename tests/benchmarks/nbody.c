@@ -0,0 +1,89 @@
+/*! @file
+ * This is a benchmark simulating gravitating bodies with direct summation of
+ * all pairwise forces, dominated by dependent multiplications, additions and
+ * divisions.
+ *
+ * Usage: benchmark_nbody [<number of bodies> [<number of steps>]]
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_NUM_BODIES 1024
+#define DEFAULT_NUM_STEPS 16
+#define TIME_STEP 0.01f
+#define SOFTENING 0.001f
+
+/// Position, velocity and mass of a body.
+struct body {
+  float x, y, z;
+  float vx, vy, vz;
+  float mass;
+};
+
+/**
+ * Prints the bits of a float in hex. The kernels are optimized, so the bits are
+ * copied rather than read through a type-punned pointer.
+ * @param[in]   value           the value to print
+ */
+static void print_hex(const float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  printf("%08x\n", bits);
+}
+
+/**
+ * The main procedure of the application.
+ * @param[in]   argc            total number of elements in the argv array
+ * @param[in]   argv            array of command line arguments
+ */
+int main(int argc, char *argv[]) {
+  const int num_bodies = argc > 1 ? atoi(argv[1]) : DEFAULT_NUM_BODIES;
+  const int num_steps = argc > 2 ? atoi(argv[2]) : DEFAULT_NUM_STEPS;
+  struct body *bodies = malloc(sizeof(struct body) * num_bodies);
+
+  for (int i = 0; i < num_bodies; i++) {
+    bodies[i].x = (float)(i % 29) - 14.0f;
+    bodies[i].y = (float)(i % 31) - 15.0f;
+    bodies[i].z = (float)(i % 37) - 18.0f;
+    bodies[i].vx = bodies[i].vy = bodies[i].vz = 0.0f;
+    bodies[i].mass = 1.0f + (float)(i % 7) / 7.0f;
+  }
+
+  for (int step = 0; step < num_steps; step++) {
+    for (int i = 0; i < num_bodies; i++) {
+      float ax = 0.0f, ay = 0.0f, az = 0.0f;
+      for (int j = 0; j < num_bodies; j++) {
+        const float dx = bodies[j].x - bodies[i].x;
+        const float dy = bodies[j].y - bodies[i].y;
+        const float dz = bodies[j].z - bodies[i].z;
+        const float distance_squared = dx * dx + dy * dy + dz * dz + SOFTENING;
+        const float distance = sqrtf(distance_squared);
+        const float scale = bodies[j].mass / (distance_squared * distance);
+        ax += dx * scale;
+        ay += dy * scale;
+        az += dz * scale;
+      }
+      bodies[i].vx += ax * TIME_STEP;
+      bodies[i].vy += ay * TIME_STEP;
+      bodies[i].vz += az * TIME_STEP;
+    }
+    for (int i = 0; i < num_bodies; i++) {
+      bodies[i].x += bodies[i].vx * TIME_STEP;
+      bodies[i].y += bodies[i].vy * TIME_STEP;
+      bodies[i].z += bodies[i].vz * TIME_STEP;
+    }
+  }
+
+  float checksum = 0.0f;
+  for (int i = 0; i < num_bodies; i++) {
+    checksum += bodies[i].x + bodies[i].y + bodies[i].z;
+  }
+  print_hex(checksum);
+
+  free(bodies);
+  return 0;
+}
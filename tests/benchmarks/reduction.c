@@ -0,0 +1,94 @@
+/*! @file
+ * This is a benchmark computing a single-precision dot product split evenly
+ * between threads, to measure how the cost of NEAT scales with the number of
+ * application threads. The total amount of work does not depend on the number
+ * of threads.
+ *
+ * Usage: benchmark_reduction [<number of threads> [<vector length>]]
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_THREADS 64
+#define DEFAULT_NUM_THREADS 1
+#define DEFAULT_LENGTH (1 << 22)
+#define NUM_PASSES 4
+
+/// The part of the dot product computed by one thread.
+struct reduction_part {
+  const float *a;
+  const float *b;
+  int begin;
+  int end;
+  float sum;
+};
+
+void *reduce_part(void *arg);
+
+/**
+ * Prints the bits of a float in hex. The kernels are optimized, so the bits are
+ * copied rather than read through a type-punned pointer.
+ * @param[in]   value           the value to print
+ */
+static void print_hex(const float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  printf("%08x\n", bits);
+}
+
+/**
+ * The main procedure of the application.
+ * @param[in]   argc            total number of elements in the argv array
+ * @param[in]   argv            array of command line arguments
+ */
+int main(int argc, char *argv[]) {
+  int num_threads = argc > 1 ? atoi(argv[1]) : DEFAULT_NUM_THREADS;
+  const int length = argc > 2 ? atoi(argv[2]) : DEFAULT_LENGTH;
+  if (num_threads < 1 || num_threads > MAX_THREADS) {
+    fprintf(stderr, "The number of threads must be between 1 and %d\n",
+            MAX_THREADS);
+    return 1;
+  }
+  float *a = malloc(sizeof(float) * length);
+  float *b = malloc(sizeof(float) * length);
+  for (int i = 0; i < length; i++) {
+    a[i] = (float)(i % 9) / 8.0f;
+    b[i] = (float)(i % 7) / 6.0f - 0.5f;
+  }
+
+  pthread_t threads[MAX_THREADS];
+  struct reduction_part parts[MAX_THREADS];
+  for (int t = 0; t < num_threads; t++) {
+    parts[t].a = a;
+    parts[t].b = b;
+    parts[t].begin = (int)((int64_t)length * t / num_threads);
+    parts[t].end = (int)((int64_t)length * (t + 1) / num_threads);
+    pthread_create(&threads[t], NULL, reduce_part, &parts[t]);
+  }
+  float sum = 0.0f;
+  for (int t = 0; t < num_threads; t++) {
+    pthread_join(threads[t], NULL);
+    sum += parts[t].sum;
+  }
+  print_hex(sum);
+
+  free(a);
+  free(b);
+  return 0;
+}
+
+void *reduce_part(void *arg) {
+  struct reduction_part *part = arg;
+  float sum = 0.0f;
+  for (int pass = 0; pass < NUM_PASSES; pass++) {
+    for (int i = part->begin; i < part->end; i++) {
+      sum += part->a[i] * part->b[i];
+    }
+  }
+  part->sum = sum;
+  return NULL;
+}
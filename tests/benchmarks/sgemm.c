@@ -0,0 +1,63 @@
+/*! @file
+ * This is a benchmark multiplying two dense single-precision matrices, which
+ * executes one multiplication and one addition per inner loop iteration.
+ *
+ * Usage: benchmark_sgemm [<matrix size>]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_SIZE 384
+
+/**
+ * Prints the bits of a float in hex. The kernels are optimized, so the bits are
+ * copied rather than read through a type-punned pointer.
+ * @param[in]   value           the value to print
+ */
+static void print_hex(const float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  printf("%08x\n", bits);
+}
+
+/**
+ * The main procedure of the application.
+ * @param[in]   argc            total number of elements in the argv array
+ * @param[in]   argv            array of command line arguments
+ */
+int main(int argc, char *argv[]) {
+  const int n = argc > 1 ? atoi(argv[1]) : DEFAULT_SIZE;
+  float *a = malloc(sizeof(float) * n * n);
+  float *b = malloc(sizeof(float) * n * n);
+  float *c = calloc(n * n, sizeof(float));
+
+  for (int i = 0; i < n * n; i++) {
+    a[i] = (float)(i % 17) / 16.0f - 0.5f;
+    b[i] = (float)(i % 13) / 12.0f + 0.25f;
+  }
+
+  // The i-k-j loop order streams through b and c, like a blocked SGEMM's
+  // inner kernel.
+  for (int i = 0; i < n; i++) {
+    for (int k = 0; k < n; k++) {
+      const float a_ik = a[i * n + k];
+      for (int j = 0; j < n; j++) {
+        c[i * n + j] += a_ik * b[k * n + j];
+      }
+    }
+  }
+
+  float checksum = 0.0f;
+  for (int i = 0; i < n * n; i++) {
+    checksum += c[i];
+  }
+  print_hex(checksum);
+
+  free(a);
+  free(b);
+  free(c);
+  return 0;
+}
@@ -0,0 +1,65 @@
+/*! @file
+ * This is a benchmark running Jacobi iterations of a five-point stencil over a
+ * two-dimensional single-precision grid.
+ *
+ * Usage: benchmark_stencil [<grid size> [<number of iterations>]]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_SIZE 1024
+#define DEFAULT_NUM_ITERATIONS 32
+
+/**
+ * Prints the bits of a float in hex. The kernels are optimized, so the bits are
+ * copied rather than read through a type-punned pointer.
+ * @param[in]   value           the value to print
+ */
+static void print_hex(const float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  printf("%08x\n", bits);
+}
+
+/**
+ * The main procedure of the application.
+ * @param[in]   argc            total number of elements in the argv array
+ * @param[in]   argv            array of command line arguments
+ */
+int main(int argc, char *argv[]) {
+  const int n = argc > 1 ? atoi(argv[1]) : DEFAULT_SIZE;
+  const int num_iterations = argc > 2 ? atoi(argv[2]) : DEFAULT_NUM_ITERATIONS;
+  float *grid = calloc(n * n, sizeof(float));
+  float *next = calloc(n * n, sizeof(float));
+
+  // Hold the top edge at a fixed temperature.
+  for (int j = 0; j < n; j++) {
+    grid[j] = next[j] = 100.0f;
+  }
+
+  for (int iteration = 0; iteration < num_iterations; iteration++) {
+    for (int i = 1; i < n - 1; i++) {
+      for (int j = 1; j < n - 1; j++) {
+        next[i * n + j] =
+            0.25f * (grid[(i - 1) * n + j] + grid[(i + 1) * n + j] +
+                     grid[i * n + j - 1] + grid[i * n + j + 1]);
+      }
+    }
+    float *tmp = grid;
+    grid = next;
+    next = tmp;
+  }
+
+  float checksum = 0.0f;
+  for (int i = 0; i < n * n; i++) {
+    checksum += grid[i];
+  }
+  print_hex(checksum);
+
+  free(grid);
+  free(next);
+  return 0;
+}
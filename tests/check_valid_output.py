@@ -21,6 +21,9 @@ def main():
         lines = f.read().split("\n")
     if lines[-1] == "":
         lines = lines[:-1]
+    # Sampled output starts with a comment describing the sampling.
+    if lines and lines[0].startswith("#"):
+        lines = lines[1:]
     if len(lines) % 2 != 0:
         sys.stderr.write(
             "Expected an even number of lines in {}\n".format(sys.argv[1]))
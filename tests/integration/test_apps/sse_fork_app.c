@@ -0,0 +1,63 @@
+/*! @file
+ * This is a sample application using SSE floating-point arithmetic instructions
+ * before and after it forks to test the outputs NEAT writes for every process.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// Print the hex value of a 32-bit value to stdout
+#define PRINT_HEX(fp) printf("%08x\n", *(uint32_t *)&(fp))
+
+float a, b, c, d, e;
+
+/**
+ * Executes a floating-point operation in the parent process only.
+ */
+void parent_work() {
+  d = a * b;  // d = 2.5 * 0.5 = 1.25
+}
+
+/**
+ * Executes a floating-point operation in the forked process only.
+ */
+void child_work() {
+  e = a - b;  // e = 2.5 - 0.5 = 2.0
+}
+
+/**
+ * The main procedure of the application.
+ * @param[in]   argc            total number of elements in the argv array
+ * @param[in]   argv            array of command line arguments
+ */
+int main(int argc, char *argv[]) {
+  a = 2.5f;  // a = 2.5
+  b = 0.5f;  // b = 0.5
+
+  // Executed before the fork, so only counted in the parent process
+  c = a + b;  // c = 2.5 + 0.5 = 3.0
+
+  // Nothing is printed before the fork, so that the forked process does not
+  // inherit buffered output
+  const pid_t pid = fork();
+  if (pid < 0) {
+    return 1;
+  }
+  if (pid == 0) {
+    child_work();
+    PRINT_HEX(e);
+    return 0;
+  }
+  waitpid(pid, NULL, 0);
+  parent_work();
+
+  PRINT_HEX(a);
+  PRINT_HEX(b);
+  PRINT_HEX(c);
+  PRINT_HEX(d);
+
+  return 0;
+}
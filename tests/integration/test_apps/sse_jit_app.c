@@ -0,0 +1,48 @@
+/*! @file
+ * This is a sample application executing SSE floating-point arithmetic
+ * instructions in code it generates at runtime, which belongs to no routine,
+ * to test the NEAT tool.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/// Print the hex value of a 32-bit value to stdout
+#define PRINT_HEX(fp) printf("%08x\n", *(uint32_t *)&(fp))
+
+/// The machine code of a function returning the sum of its two float
+/// arguments: addss %xmm1, %xmm0; ret
+static const unsigned char kAddCode[] = {0xf3, 0x0f, 0x58, 0xc1, 0xc3};
+
+float a, b, c, d;
+
+/**
+ * The main procedure of the application.
+ * @param[in]   argc            total number of elements in the argv array
+ * @param[in]   argv            array of command line arguments
+ */
+int main(int argc, char *argv[]) {
+  void *code = mmap(NULL, sizeof(kAddCode), PROT_READ | PROT_WRITE | PROT_EXEC,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (code == MAP_FAILED) {
+    return 1;
+  }
+  memcpy(code, kAddCode, sizeof(kAddCode));
+  float (*add)(float, float) = (float (*)(float, float))code;
+
+  a = 2.5f;  // a = 2.5
+  b = 0.5f;  // b = 0.5
+
+  c = add(a, b);  // c = 2.5 + 0.5 = 3.0, outside any routine
+  d = a * b;      // d = 2.5 * 0.5 = 1.25, in main
+
+  PRINT_HEX(a);
+  PRINT_HEX(b);
+  PRINT_HEX(c);
+  PRINT_HEX(d);
+
+  munmap(code, sizeof(kAddCode));
+  return 0;
+}
@@ -0,0 +1,41 @@
+/*! @file
+ * This is a sample application calling single-precision math library
+ * functions to test the replacement of whole math library functions by the
+ * NEAT tool.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/// Print the hex value of a 32-bit value to stdout
+#define PRINT_HEX(fp) printf("%08x\n", *(uint32_t *)&(fp))
+
+float a, b, c, d, e, f;
+
+/**
+ * The main procedure of the application.
+ * @param[in]   argc            total number of elements in the argv array
+ * @param[in]   argv            array of command line arguments
+ */
+int main(int argc, char *argv[]) {
+  a = 2.0f;  // a = 2.0
+  b = 0.5f;  // b = 0.5
+
+  // Make sure that functions of one and two arguments are replaced
+  c = expf(a);     // c = e^2.0 = 7.389056
+  d = sinf(b);     // d = sin(0.5) = 0.479426
+  e = powf(a, b);  // e = 2.0^0.5 = 1.414214
+
+  // Make sure that the results of replaced functions reach the application
+  f = c + d;  // f = 7.389056 + 0.479426 = 7.868482
+
+  PRINT_HEX(a);
+  PRINT_HEX(b);
+  PRINT_HEX(c);
+  PRINT_HEX(d);
+  PRINT_HEX(e);
+  PRINT_HEX(f);
+
+  return 0;
+}
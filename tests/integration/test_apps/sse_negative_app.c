@@ -0,0 +1,36 @@
+/*! @file
+ * This is a sample application using SSE floating-point arithmetic instructions
+ * on negative operands to test the NEAT tool.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+/// Print the hex value of a 32-bit value to stdout
+#define PRINT_HEX(fp) printf("%08x\n", *(uint32_t *)&(fp))
+
+float a, b, c, d, e;
+
+/**
+ * The main procedure of the application.
+ * @param[in]   argc            total number of elements in the argv array
+ * @param[in]   argv            array of command line arguments
+ */
+int main(int argc, char *argv[]) {
+  a = 2.0f;        // a = 2.0
+  b = -6.01e+30f;  // b = -6.01e+30
+
+  // Make sure that operations on large negative numbers are told apart from
+  // operations on small numbers
+  c = a + b;  // c = 2.0 + -6.01e+30 = -6.01e+30
+  d = a * b;  // d = 2.0 * -6.01e+30 = -1.202e+31
+  e = a * a;  // e = 2.0 * 2.0 = 4.0
+
+  PRINT_HEX(a);
+  PRINT_HEX(b);
+  PRINT_HEX(c);
+  PRINT_HEX(d);
+  PRINT_HEX(e);
+
+  return 0;
+}
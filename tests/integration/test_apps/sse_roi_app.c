@@ -0,0 +1,40 @@
+/*! @file
+ * This is a sample application delimiting a region of interest with the
+ * markers of include/neat_roi.h to test the -roi_markers flag of the NEAT
+ * tool.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "neat_roi.h"
+
+/// Print the hex value of a 32-bit value to stdout
+#define PRINT_HEX(fp) printf("%08x\n", *(uint32_t *)&(fp))
+
+float a, b, c, d, e;
+
+/**
+ * The main procedure of the application.
+ * @param[in]   argc            total number of elements in the argv array
+ * @param[in]   argv            array of command line arguments
+ */
+int main(int argc, char *argv[]) {
+  a = 2.0f;  // a = 2.0
+  b = 0.3f;  // b = 0.3
+
+  // Make sure that only the operations inside the region are instrumented
+  c = a + b;  // c = 2.0 + 0.3 = 2.3
+  NEAT_RoiBegin();
+  d = a * b;  // d = 2.0 * 0.3 = 0.6
+  NEAT_RoiEnd();
+  e = a - b;  // e = 2.0 - 0.3 = 1.7
+
+  PRINT_HEX(a);
+  PRINT_HEX(b);
+  PRINT_HEX(c);
+  PRINT_HEX(d);
+  PRINT_HEX(e);
+
+  return 0;
+}
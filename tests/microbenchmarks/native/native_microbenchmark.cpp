@@ -0,0 +1,487 @@
+/**
+ * This is a native program that measures the cost of every registered
+ * FpImplementation and FpSelector without running Pin. The client library and
+ * the test FpSelectors are compiled against the stub of pin.H in this
+ * directory, and each FpImplementation and FpSelector is driven over
+ * synthetic streams of operands the way NEAT drives it while replacing an
+ * instruction. Each measurement is printed as nanoseconds and millions of
+ * operations per second, with the L1 data cache and last level cache misses
+ * per operation when the kernel lets the program read hardware counters.
+ *
+ * Usage: native_microbenchmark [-num_operations <count>]
+ *     [-cold_operands <count>] [-filter <substring>] [-csv]
+ */
+
+#include <pin.H>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/interfaces/fp_result_transform.h"
+#include "client_lib/interfaces/fp_selector.h"
+#include "client_lib/registry/internal/fp_implementation_factory_registry.h"
+#include "client_lib/registry/internal/fp_selector_registry.h"
+#include "client_lib/utils/fp_implementation_parameters.h"
+#include "client_lib/utils/fp_instruction.h"
+#include "client_lib/utils/fp_operand_predicate.h"
+#include "client_lib/utils/fp_operation.h"
+
+using NEAT::FpImplementation;
+using NEAT::FpImplementationParameters;
+using NEAT::FpInstruction;
+using NEAT::FpOperandPredicate;
+using NEAT::FpOperation;
+using NEAT::FpResultTransform;
+using NEAT::FpSelector;
+using NEAT::internal::FpImplementationFactoryRegistry;
+using NEAT::internal::FpSelectorRegistry;
+
+namespace {
+
+/// Number of operands of the streams that fit in the L1 data cache.
+const UINT32 kNumHotOperands = 4096;
+
+/// The opcodes cycled through by every measurement.
+const OPCODE kOpcodes[] = {XED_ICLASS_ADDSS, XED_ICLASS_SUBSS,
+                           XED_ICLASS_MULSS, XED_ICLASS_DIVSS};
+const UINT32 kNumOpcodes = sizeof(kOpcodes) / sizeof(kOpcodes[0]);
+
+/// Function and image the synthetic operations are attributed to. The
+/// function name is short enough to be copied into every FpOperation without
+/// allocating, so that the copy does not dominate cheap FpImplementations.
+const string kFunctionName = "kernel";
+const string kImageName = "native_microbenchmark";
+
+/// Settings read from the command line.
+struct Options {
+  UINT64 num_operations = 4000000;
+  UINT32 num_cold_operands = 1 << 22;
+  string filter;
+  BOOL csv = FALSE;
+};
+
+/// A named stream of operands.
+struct OperandStream {
+  string name;
+  vector<FLT32> operands;
+};
+
+/**
+ * Returns the next value of a linear congruential generator.
+ */
+UINT32 NextRandom(UINT32 *state) {
+  *state = *state * 1664525 + 1013904223;
+  return *state;
+}
+
+/**
+ * Returns random operands spread over several orders of magnitude around 1,
+ * like the values of most applications.
+ */
+vector<FLT32> MakeUnitOperands(const UINT32 num_operands) {
+  vector<FLT32> operands(num_operands);
+  UINT32 state = 12345;
+  for (UINT32 i = 0; i < num_operands; i++) {
+    const UINT32 random = NextRandom(&state);
+    const FLT32 mantissa = 1.0f + (random >> 8) / 16777216.0f;
+    const INT32 exponent = static_cast<INT32>(random & 0x1f) - 16;
+    operands[i] = (random & 0x20 ? -mantissa : mantissa) *
+                  (exponent < 0 ? 1.0f / (1 << -exponent) : 1 << exponent);
+  }
+  return operands;
+}
+
+/**
+ * Returns random finite operands over the whole range of FLT32, including
+ * zeros and denormals, which exercise the slow paths of emulated formats.
+ */
+vector<FLT32> MakeWideOperands(const UINT32 num_operands) {
+  vector<FLT32> operands(num_operands);
+  UINT32 state = 54321;
+  for (UINT32 i = 0; i < num_operands; i++) {
+    UINT32 bits = NextRandom(&state);
+    if ((bits & 0x7f800000) == 0x7f800000) {
+      bits &= ~0x40000000u;
+    }
+    memcpy(&operands[i], &bits, sizeof(bits));
+  }
+  return operands;
+}
+
+/**
+ * Hardware counters of the cache misses of this thread, read with
+ * perf_event_open. The counters are unavailable when the kernel does not
+ * allow unprivileged programs to read them.
+ */
+class CacheMissCounters {
+ public:
+  CacheMissCounters() {
+    l1d_fd_ = Open(PERF_TYPE_HW_CACHE,
+                   PERF_COUNT_HW_CACHE_L1D |
+                       (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    llc_fd_ = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  }
+
+  ~CacheMissCounters() {
+    if (l1d_fd_ >= 0) {
+      close(l1d_fd_);
+    }
+    if (llc_fd_ >= 0) {
+      close(llc_fd_);
+    }
+  }
+
+  VOID Start() {
+    Reset(l1d_fd_);
+    Reset(llc_fd_);
+  }
+
+  VOID Stop() {
+    l1d_misses_ = Read(l1d_fd_);
+    llc_misses_ = Read(llc_fd_);
+  }
+
+  /// Returns the L1 data cache read misses since Start, or -1 if unknown.
+  INT64 GetL1dMisses() const { return l1d_misses_; }
+
+  /// Returns the last level cache misses since Start, or -1 if unknown.
+  INT64 GetLlcMisses() const { return llc_misses_; }
+
+ private:
+  static INT32 Open(const UINT32 type, const UINT64 config) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<INT32>(
+        syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  static VOID Reset(const INT32 fd) {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  static INT64 Read(const INT32 fd) {
+    UINT64 count;
+    if (fd < 0) {
+      return -1;
+    }
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+      return -1;
+    }
+    return static_cast<INT64>(count);
+  }
+
+  INT32 l1d_fd_;
+  INT32 llc_fd_;
+  INT64 l1d_misses_ = -1;
+  INT64 llc_misses_ = -1;
+};
+
+/**
+ * Returns the result of executing a floating-point operation natively.
+ */
+FLT32 ExecuteNatively(const FpOperation &operation) {
+  switch (operation.opcode) {
+    case XED_ICLASS_ADDSS:
+      return operation.operand1 + operation.operand2;
+    case XED_ICLASS_SUBSS:
+      return operation.operand1 - operation.operand2;
+    case XED_ICLASS_MULSS:
+      return operation.operand1 * operation.operand2;
+    default:
+      return operation.operand1 / operation.operand2;
+  }
+}
+
+/**
+ * Executes operations the way NEAT executes a replaced instruction with an
+ * FpSelector: the FpResultTransform, static FpImplementation and
+ * FpOperandPredicate of each opcode are selected once, as when the
+ * instruction is instrumented, and the rest on every operation.
+ */
+class FpSelectorDriver {
+ public:
+  explicit FpSelectorDriver(FpSelector *fp_selector)
+      : fp_selector_(fp_selector) {
+    for (UINT32 i = 0; i < kNumOpcodes; i++) {
+      const FpInstruction instruction(kOpcodes[i], kFunctionName, kImageName,
+                                      0);
+      transforms_[i] = fp_selector->SelectFpResultTransform(instruction);
+      has_mask_[i] = transforms_[i] != NULL &&
+                     transforms_[i]->GetResultMask(&masks_[i]);
+      implementations_[i] =
+          fp_selector->SelectStaticFpImplementation(instruction);
+      predicates_[i] = fp_selector->SelectFpOperandPredicate(instruction);
+    }
+  }
+
+  FLT32 PerformOperation(const UINT32 opcode_index,
+                         const FpOperation &operation) {
+    if (transforms_[opcode_index] != NULL) {
+      const FLT32 result = ExecuteNatively(operation);
+      if (!has_mask_[opcode_index]) {
+        return transforms_[opcode_index]->TransformResult(operation.opcode,
+                                                          result);
+      }
+      UINT32 bits;
+      memcpy(&bits, &result, sizeof(bits));
+      bits &= masks_[opcode_index];
+      FLT32 masked;
+      memcpy(&masked, &bits, sizeof(bits));
+      return masked;
+    }
+    if (predicates_[opcode_index] != NULL &&
+        !predicates_[opcode_index]->Matches(operation.operand1) &&
+        !predicates_[opcode_index]->Matches(operation.operand2)) {
+      return ExecuteNatively(operation);
+    }
+    FpImplementation *fp_implementation = implementations_[opcode_index];
+    if (fp_implementation == NULL) {
+      fp_implementation = fp_selector_->SelectFpImplementation(operation);
+    }
+    return fp_implementation->PerformOperation(operation);
+  }
+
+ private:
+  FpSelector *fp_selector_;
+  FpResultTransform *transforms_[kNumOpcodes];
+  BOOL has_mask_[kNumOpcodes];
+  UINT32 masks_[kNumOpcodes];
+  FpImplementation *implementations_[kNumOpcodes];
+  const FpOperandPredicate *predicates_[kNumOpcodes];
+};
+
+/**
+ * Drives an FpImplementation directly.
+ */
+class FpImplementationDriver {
+ public:
+  explicit FpImplementationDriver(FpImplementation *fp_implementation)
+      : fp_implementation_(fp_implementation) {}
+
+  FLT32 PerformOperation(const UINT32 opcode_index,
+                         const FpOperation &operation) {
+    return fp_implementation_->PerformOperation(operation);
+  }
+
+ private:
+  FpImplementation *fp_implementation_;
+};
+
+/**
+ * Runs operations on consecutive operands of a stream with a driver.
+ *
+ * @return The sum of the results, so that no operation can be optimized out.
+ */
+template <typename Driver>
+FLT32 RunOperations(Driver *driver, const vector<FLT32> &operands,
+                    const UINT64 num_operations) {
+  const UINT64 num_operands = operands.size();
+  FLT32 sum = 0.0f;
+  UINT64 operand_index = 0;
+  for (UINT64 i = 0; i < num_operations; i++) {
+    const UINT32 opcode_index = i % kNumOpcodes;
+    const UINT64 next_operand_index =
+        operand_index + 1 == num_operands ? 0 : operand_index + 1;
+    const FpOperation operation(kOpcodes[opcode_index],
+                                operands[operand_index],
+                                operands[next_operand_index], kFunctionName,
+                                0);
+    sum += driver->PerformOperation(opcode_index, operation);
+    operand_index = next_operand_index;
+  }
+  return sum;
+}
+
+/**
+ * Prints the header of the table of measurements.
+ */
+VOID PrintHeader(const Options &options) {
+  if (options.csv) {
+    cout << "kind,name,operands,ns_per_op,mops_per_s,l1d_misses_per_op,"
+            "llc_misses_per_op"
+         << endl;
+    return;
+  }
+  cout << setw(18) << left << "kind" << setw(36) << "name" << setw(10)
+       << "operands" << setw(10) << right << "ns/op" << setw(10) << "Mops/s"
+       << setw(12) << "L1D miss/op" << setw(12) << "LLC miss/op" << endl;
+}
+
+/**
+ * Prints a cache miss count per operation, or "-" if it is unknown.
+ */
+VOID PrintMissesPerOperation(const INT64 misses, const UINT64 num_operations,
+                             const Options &options) {
+  ostringstream value;
+  if (misses < 0) {
+    value << "-";
+  } else {
+    value << fixed << setprecision(4)
+          << static_cast<FLT64>(misses) / num_operations;
+  }
+  if (options.csv) {
+    cout << "," << (misses < 0 ? "" : value.str());
+  } else {
+    cout << setw(12) << right << value.str();
+  }
+}
+
+/**
+ * Measures a driver over every operand stream and prints the results.
+ */
+template <typename Driver>
+VOID Measure(const string &kind, const string &name, Driver *driver,
+             const vector<OperandStream> &streams, const Options &options) {
+  volatile FLT32 sink;
+  for (const OperandStream &stream : streams) {
+    // Warm up the caches and any state built on first use.
+    sink = RunOperations(driver, stream.operands,
+                         min<UINT64>(options.num_operations,
+                                     stream.operands.size()));
+    CacheMissCounters counters;
+    counters.Start();
+    const auto start = chrono::steady_clock::now();
+    sink = RunOperations(driver, stream.operands, options.num_operations);
+    const auto end = chrono::steady_clock::now();
+    counters.Stop();
+    (void)sink;
+
+    const FLT64 ns_per_operation =
+        chrono::duration<FLT64, nano>(end - start).count() /
+        options.num_operations;
+    if (options.csv) {
+      cout << kind << "," << name << "," << stream.name << "," << fixed
+           << setprecision(3) << ns_per_operation << ","
+           << 1000.0 / ns_per_operation;
+    } else {
+      cout << setw(18) << left << kind << setw(36) << name << setw(10)
+           << stream.name << setw(10) << right << fixed << setprecision(2)
+           << ns_per_operation << setw(10) << 1000.0 / ns_per_operation;
+    }
+    PrintMissesPerOperation(counters.GetL1dMisses(), options.num_operations,
+                            options);
+    PrintMissesPerOperation(counters.GetLlcMisses(), options.num_operations,
+                            options);
+    cout << endl;
+  }
+}
+
+/**
+ *  Prints out a help message.
+ *
+ *  @return An error code for the application.
+ */
+INT32 Usage() {
+  cerr << "This program measures the cost of every registered "
+          "FpImplementation and FpSelector without running Pin."
+       << endl
+       << "Usage: native_microbenchmark [-num_operations <count>] "
+          "[-cold_operands <count>] [-filter <substring>] [-csv]"
+       << endl;
+  return 1;
+}
+
+/**
+ * Reads the options from the command line.
+ *
+ * @return Whether the command line is valid.
+ */
+BOOL ParseOptions(const int argc, char *argv[], Options *options) {
+  for (int i = 1; i < argc; i++) {
+    const string flag = argv[i];
+    if (flag == "-csv") {
+      options->csv = TRUE;
+    } else if (i + 1 == argc) {
+      return FALSE;
+    } else if (flag == "-num_operations") {
+      options->num_operations = strtoull(argv[++i], NULL, 10);
+    } else if (flag == "-cold_operands") {
+      options->num_cold_operands = strtoul(argv[++i], NULL, 10);
+    } else if (flag == "-filter") {
+      options->filter = argv[++i];
+    } else {
+      return FALSE;
+    }
+  }
+  return options->num_operations > 0 && options->num_cold_operands > 1;
+}
+
+}  // namespace
+
+/**
+ * The main procedure of the microbenchmark.
+ *
+ * @param[in] argc Total number of elements in the argv array
+ * @param[in] argv Array of command line arguments
+ */
+int main(int argc, char *argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    return Usage();
+  }
+
+  // The cold stream is larger than the last level cache of most processors,
+  // so that table-based implementations are measured with their tables
+  // competing with the application's data.
+  const vector<OperandStream> streams = {
+      {"unit", MakeUnitOperands(kNumHotOperands)},
+      {"wide", MakeWideOperands(kNumHotOperands)},
+      {"unit_cold", MakeUnitOperands(options.num_cold_operands)}};
+
+  PrintHeader(options);
+  FpImplementationFactoryRegistry *factory_registry =
+      FpImplementationFactoryRegistry::GetFpImplementationFactoryRegistry();
+  for (const string &name : factory_registry->GetFpImplementationNames()) {
+    if (name.find(options.filter) == string::npos) {
+      continue;
+    }
+    FpImplementation *fp_implementation =
+        factory_registry->CreateFpImplementationOrDie(
+            name, FpImplementationParameters());
+    // FpImplementations have no virtual destructor, so they are never deleted,
+    // as in NEAT.
+    FpImplementationDriver driver(fp_implementation);
+    Measure("FpImplementation", name, &driver, streams, options);
+  }
+
+  FpSelectorRegistry *selector_registry =
+      FpSelectorRegistry::GetFpSelectorRegistry();
+  for (const string &name : selector_registry->GetFpSelectorNames()) {
+    if (name.find(options.filter) == string::npos) {
+      continue;
+    }
+    FpSelector *fp_selector = selector_registry->GetFpSelectorOrDie(name);
+    fp_selector->StartCallback();
+    fp_selector->OnThreadStart(0);
+    if (fp_selector->NeedsFunctionCallbacks()) {
+      fp_selector->OnFunctionStartInThread(kFunctionName, 0);
+    }
+    FpSelectorDriver driver(fp_selector);
+    Measure("FpSelector", name, &driver, streams, options);
+  }
+  return 0;
+}
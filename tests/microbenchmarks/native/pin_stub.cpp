@@ -0,0 +1,81 @@
+#include <pin.H>
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace {
+
+/// Guards every structure of the stub.
+mutex stub_mutex;
+
+/// Destructors of the thread data keys, indexed by key.
+vector<DESTRUCTFUN> thread_data_destructors;
+
+/// Thread data, indexed by key and thread.
+map<pair<TLS_KEY, THREADID>, VOID *> thread_data;
+
+/// Internal threads that have not been waited for, indexed by UID.
+map<PIN_THREAD_UID, thread> internal_threads;
+
+/// UID of the next internal thread.
+PIN_THREAD_UID next_thread_uid = 1;
+
+}  // namespace
+
+TLS_KEY PIN_CreateThreadDataKey(DESTRUCTFUN destruct_function) {
+  lock_guard<mutex> lock(stub_mutex);
+  thread_data_destructors.push_back(destruct_function);
+  return static_cast<TLS_KEY>(thread_data_destructors.size() - 1);
+}
+
+BOOL PIN_SetThreadData(TLS_KEY key, const VOID *data, THREADID thread_id) {
+  lock_guard<mutex> lock(stub_mutex);
+  thread_data[make_pair(key, thread_id)] = const_cast<VOID *>(data);
+  return TRUE;
+}
+
+VOID *PIN_GetThreadData(TLS_KEY key, THREADID thread_id) {
+  lock_guard<mutex> lock(stub_mutex);
+  const auto data = thread_data.find(make_pair(key, thread_id));
+  return data == thread_data.end() ? NULL : data->second;
+}
+
+VOID PIN_Yield() { this_thread::yield(); }
+
+// Native programs run no instrumented code to discard.
+VOID PIN_RemoveInstrumentation() {}
+
+THREADID PIN_SpawnInternalThread(ROOT_THREAD_FUNC thread_function, VOID *arg,
+                                 size_t stack_size,
+                                 PIN_THREAD_UID *thread_uid) {
+  lock_guard<mutex> lock(stub_mutex);
+  const PIN_THREAD_UID uid = next_thread_uid++;
+  internal_threads[uid] = thread(thread_function, arg);
+  if (thread_uid != NULL) {
+    *thread_uid = uid;
+  }
+  return static_cast<THREADID>(uid);
+}
+
+// Unlike Pin, waits for the thread regardless of the timeout, since a
+// standard thread cannot be abandoned while it runs.
+BOOL PIN_WaitForThreadTermination(const PIN_THREAD_UID &thread_uid,
+                                  UINT32 milliseconds, INT32 *exit_code) {
+  thread internal_thread;
+  {
+    lock_guard<mutex> lock(stub_mutex);
+    const auto found = internal_threads.find(thread_uid);
+    if (found == internal_threads.end()) {
+      return FALSE;
+    }
+    internal_thread = move(found->second);
+    internal_threads.erase(found);
+  }
+  internal_thread.join();
+  if (exit_code != NULL) {
+    *exit_code = 0;
+  }
+  return TRUE;
+}
@@ -0,0 +1,151 @@
+/**
+ * This is a Pin tool that measures the throughput of the posit
+ * FpImplementations for every operation, alongside the software emulation of
+ * IEEE binary16 and bfloat16 for comparison. It does not instrument the
+ * application; the measurements are taken before the application would start
+ * and printed as nanoseconds per operation.
+ */
+
+#include <pin.H>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "client_lib/default_fp_selectors/posit_fp_implementation.h"
+#include "client_lib/default_fp_selectors/soft_float_fp_implementation.h"
+#include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/utils/fp_operation.h"
+
+using NEAT::Bfloat16FpImplementation;
+using NEAT::Fp16FpImplementation;
+using NEAT::FpImplementation;
+using NEAT::FpOperation;
+using NEAT::PositFpImplementation;
+
+KNOB<UINT32> KnobNumOperations(KNOB_MODE_OVERWRITE, "pintool",
+                               "num_operations", "10000000",
+                               "number of operations to time per "
+                               "implementation and opcode");
+
+namespace {
+
+/// Number of distinct operand pairs cycled through by the benchmark.
+const UINT32 kNumOperands = 4096;
+
+/**
+ * Returns random FLT32 operands spread over several orders of magnitude
+ * around 1, where posits have the most precision.
+ */
+vector<FLT32> MakeOperands() {
+  vector<FLT32> operands(kNumOperands);
+  UINT32 state = 12345;
+  for (UINT32 i = 0; i < kNumOperands; i++) {
+    state = state * 1664525 + 1013904223;
+    const FLT32 mantissa = 1.0f + (state >> 8) / 16777216.0f;
+    const INT32 exponent = static_cast<INT32>(state & 0x1f) - 16;
+    operands[i] = (state & 0x20 ? -mantissa : mantissa) *
+                  (exponent < 0 ? 1.0f / (1 << -exponent) : 1 << exponent);
+  }
+  return operands;
+}
+
+/**
+ * Times an operation of an FpImplementation.
+ *
+ * @return The average time of a single operation, in nanoseconds.
+ */
+FLT64 TimeOperation(FpImplementation *fp_implementation, const OPCODE opcode,
+                    const vector<FLT32> &operands, const UINT32 num_operations) {
+  volatile FLT32 sink = 0.0f;
+  FLT32 result = 0.0f;
+  const auto start = std::chrono::steady_clock::now();
+  for (UINT32 i = 0; i < num_operations; i++) {
+    const FpOperation operation(opcode, operands[i % kNumOperands],
+                                operands[(i + 1) % kNumOperands], "", 0);
+    result += fp_implementation->PerformOperation(operation);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  sink = result;
+  (void)sink;
+  return std::chrono::duration<FLT64, std::nano>(end - start).count() /
+         num_operations;
+}
+
+}  // namespace
+
+/**
+ *  Prints out a help message.
+ *
+ *  @return An error code for the application.
+ */
+static INT32 Usage() {
+  cerr << "This is a Pin tool that measures the throughput of the posit "
+          "floating-point implementations."
+       << endl;
+  cerr << KNOB_BASE::StringKnobSummary() << endl;
+  return -1;
+}
+
+/**
+ * The main procedure of the tool. Runs the benchmark and exits without
+ * starting the application.
+ *
+ * @param[in] argc Total number of elements in the argv array
+ * @param[in] argv Array of command line arguments,
+ *     including pin -t <toolname> -- ...
+ */
+int main(int argc, char *argv[]) {
+  if (PIN_Init(argc, argv)) {
+    return Usage();
+  }
+
+  PositFpImplementation<8, 0> posit8_es0;
+  PositFpImplementation<8, 1> posit8_es1;
+  PositFpImplementation<8, 2> posit8_es2;
+  PositFpImplementation<16, 0> posit16_es0;
+  PositFpImplementation<16, 1> posit16_es1;
+  PositFpImplementation<16, 2> posit16_es2;
+  PositFpImplementation<32, 0> posit32_es0;
+  PositFpImplementation<32, 1> posit32_es1;
+  PositFpImplementation<32, 2> posit32_es2;
+  Fp16FpImplementation fp16;
+  Bfloat16FpImplementation bfloat16;
+  const struct {
+    const char *name;
+    FpImplementation *fp_implementation;
+  } implementations[] = {
+      {"posit8_es0", &posit8_es0},   {"posit8_es1", &posit8_es1},
+      {"posit8_es2", &posit8_es2},   {"posit16_es0", &posit16_es0},
+      {"posit16_es1", &posit16_es1}, {"posit16_es2", &posit16_es2},
+      {"posit32_es0", &posit32_es0}, {"posit32_es1", &posit32_es1},
+      {"posit32_es2", &posit32_es2}, {"fp16", &fp16},
+      {"bfloat16", &bfloat16}};
+  const struct {
+    const char *name;
+    OPCODE opcode;
+  } opcodes[] = {{"add", XED_ICLASS_ADDSS},
+                 {"sub", XED_ICLASS_SUBSS},
+                 {"mul", XED_ICLASS_MULSS},
+                 {"div", XED_ICLASS_DIVSS}};
+
+  const vector<FLT32> operands = MakeOperands();
+  const UINT32 num_operations = KnobNumOperations.Value();
+  cout << setw(12) << left << "ns/op";
+  for (const auto &opcode : opcodes) {
+    cout << setw(8) << right << opcode.name;
+  }
+  cout << endl;
+  for (const auto &implementation : implementations) {
+    cout << setw(12) << left << implementation.name;
+    for (const auto &opcode : opcodes) {
+      cout << setw(8) << right << fixed << setprecision(2)
+           << TimeOperation(implementation.fp_implementation, opcode.opcode,
+                            operands, num_operations);
+    }
+    cout << endl;
+  }
+  return 0;
+}
@@ -4,10 +4,16 @@
 
 #include "client_lib/default_fp_selectors/normal_fp_implementation.h"
 #include "client_lib/interfaces/fp_implementation.h"
+#include "client_lib/interfaces/math_implementation.h"
 #include "client_lib/registry/register_current_function_fp_selector.h"
+#include "client_lib/registry/register_fp_implementation_factory.h"
 #include "client_lib/registry/register_function_stack_fp_selector.h"
+#include "client_lib/registry/register_math_implementation.h"
+#include "client_lib/registry/register_predicated_fp_selector.h"
 #include "client_lib/registry/register_single_fp_implementation_selector.h"
+#include "client_lib/utils/fp_operand_predicate.h"
 #include "client_lib/utils/fp_operation.h"
+#include "client_lib/utils/math_call.h"
 
 namespace NEAT {
 
@@ -38,6 +44,14 @@ class TestComplexFpImplementation : public NormalFpImplementation {
   }
 };
 
+/**
+ * A simple test implementation of math library functions.
+ */
+class TestSimpleMathImplementation : public MathImplementation {
+ public:
+  FLT32 Evaluate(const MathCall &call) override { return 1.0; }
+};
+
 // FpImplementation instances for tests.
 static TestSimpleFpImplementation simple;
 static TestComplexFpImplementation complex;
@@ -71,5 +85,19 @@ static RegisterCurrentFunctionFpSelector test_simple_current_function(
 static RegisterCurrentFunctionFpSelector test_nested_current_function(
     test_nested_function_stack_map, test_nested_function_stack_map_size,
     &normal, "test_nested_current_function");
+static RegisterPredicatedFpSelector<TestSimpleFpImplementation>
+    test_simple_large_exponents(
+        FpOperandPredicate().MatchExponentRange(65, 127),
+        "test_simple_large_exponents");
+
+// Register FpImplementation factories for config file tests.
+static RegisterFpImplementationFactory test_simple_factory(
+    CreateFpImplementation<TestSimpleFpImplementation>, "test_simple");
+static RegisterFpImplementationFactory test_complex_factory(
+    CreateFpImplementation<TestComplexFpImplementation>, "test_complex");
+
+// Register MathImplementation instances for tests.
+static RegisterMathImplementation<TestSimpleMathImplementation>
+    test_simple_math("test_simple");
 
 }  // namespace NEAT
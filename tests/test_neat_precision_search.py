@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""
+Tests the delta-debugging search of tools/neat_precision_search.py with a fake
+runner whose outcomes are known, instead of running NEAT.
+"""
+
+import contextlib
+import io
+import itertools
+import os
+import random
+import sys
+import unittest
+
+sys.path.insert(
+    0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tools"))
+
+import neat_precision_search  # pylint: disable=wrong-import-position
+
+RULE = "bfloat16"
+
+
+class FakeRunner:
+    """Accepts an assignment unless the functions assigned RULE include one
+    of the failing sets, or make the fails function return True."""
+
+    def __init__(self, failing_sets, fails=None, max_runs=10000):
+        self.failing_sets = [frozenset(s) for s in failing_sets]
+        self.fails = fails
+        self.max_runs = max_runs
+        self.num_runs = 0
+
+    def accepts(self, assignment):
+        assigned = {f for f, rule in assignment.items() if rule == RULE}
+        if self.fails is not None and self.fails(assigned):
+            return False
+        return not any(s <= assigned for s in self.failing_sets)
+
+    def run_all(self, assignments):
+        self.num_runs += len(assignments)
+        if self.num_runs > self.max_runs:
+            raise AssertionError("the search does not terminate")
+        return [self.accepts(assignment) for assignment in assignments]
+
+
+def search(runner, functions):
+    assignment = {}
+    with contextlib.redirect_stdout(io.StringIO()):
+        rejected = neat_precision_search.search(runner, assignment, functions,
+                                                RULE)
+    return assignment, rejected
+
+
+class SearchTest(unittest.TestCase):
+
+    def check_result(self, runner, functions, assignment, rejected):
+        """Checks that every function is either assigned or rejected, that
+        the assignment is acceptable and that no rejected function could be
+        added to it."""
+        self.assertEqual(set(assignment) | set(rejected), set(functions))
+        self.assertFalse(set(assignment) & set(rejected))
+        self.assertTrue(runner.accepts(assignment))
+        for function in rejected:
+            extended = dict(assignment)
+            extended[function] = RULE
+            self.assertFalse(runner.accepts(extended))
+
+    def test_no_functions(self):
+        runner = FakeRunner([])
+        self.assertEqual(search(runner, []), ({}, []))
+        self.assertEqual(runner.num_runs, 0)
+
+    def test_every_function_passes(self):
+        functions = ["f{}".format(i) for i in range(10)]
+        runner = FakeRunner([])
+        assignment, rejected = search(runner, functions)
+        self.assertEqual(assignment, {f: RULE for f in functions})
+        self.assertEqual(rejected, [])
+        self.assertEqual(runner.num_runs, 1)
+
+    def test_failing_functions_are_rejected(self):
+        functions = ["f{}".format(i) for i in range(16)]
+        runner = FakeRunner([["f3"], ["f10"], ["f11"]])
+        assignment, rejected = search(runner, functions)
+        self.assertEqual(sorted(rejected), ["f10", "f11", "f3"])
+        self.check_result(runner, functions, assignment, rejected)
+
+    def test_functions_failing_together(self):
+        # Either half passes on its own, so the merge fails and the second
+        # half is tried again on top of the first.
+        functions = ["f{}".format(i) for i in range(8)]
+        runner = FakeRunner([["f1", "f6"]])
+        assignment, rejected = search(runner, functions)
+        self.assertEqual(rejected, ["f6"])
+        self.check_result(runner, functions, assignment, rejected)
+
+    def test_rejected_function_passes_with_final_assignment(self):
+        # g is rejected on its own before y is assigned, and is only accepted
+        # when the rejected functions are tried again at the end.
+        functions = ["g", "a", "b", "c", "y", "d", "e", "f"]
+        runner = FakeRunner([["y", "f"]],
+                            fails=lambda assigned: "g" in assigned and "y"
+                            not in assigned)
+        assignment, rejected = search(runner, functions)
+        self.assertEqual(rejected, ["f"])
+        self.assertIn("g", assignment)
+        self.check_result(runner, functions, assignment, rejected)
+
+    def test_random_failing_sets(self):
+        generator = random.Random(1)
+        for num_functions, num_sets in itertools.product([1, 2, 5, 13, 32],
+                                                         [0, 1, 3, 8]):
+            functions = ["f{}".format(i) for i in range(num_functions)]
+            failing_sets = [
+                generator.sample(functions, generator.randint(
+                    1, min(3, num_functions))) for _ in range(num_sets)
+            ]
+            runner = FakeRunner(failing_sets)
+            assignment, rejected = search(runner, functions)
+            with self.subTest(functions=num_functions,
+                              failing_sets=failing_sets):
+                self.check_result(runner, functions, assignment, rejected)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""
+Compacts a floating-point result cache file written by CachedFpImplementation.
+
+Duplicate records are removed, keeping the first result recorded for each
+operation. Optionally, records from all but the newest version of each
+implementation can be dropped, and the number of records kept can be capped.
+
+The compacted cache is written to a temporary file which then atomically
+replaces the original. NEAT processes that still have the old cache file open
+keep appending to the replaced file, so those new results are lost but the
+compacted file is never corrupted.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+HEADER = struct.Struct("=8sII")
+RECORD = struct.Struct("=IIIIII")
+MAGIC = b"NEATFRC\0"
+FORMAT_VERSION = 1
+
+
+def read_records(cache_file_name):
+    with open(cache_file_name, "rb") as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        sys.stderr.write("{} is too small to be a result cache\n".format(
+            cache_file_name))
+        sys.exit(1)
+    magic, format_version, record_size = HEADER.unpack_from(data)
+    if (magic != MAGIC or format_version != FORMAT_VERSION or
+            record_size != RECORD.size):
+        sys.stderr.write("{} is not a valid result cache\n".format(
+            cache_file_name))
+        sys.exit(1)
+    # A record that was still being appended may be cut off at the end of the
+    # file, so only whole records are read.
+    num_records = (len(data) - HEADER.size) // RECORD.size
+    return [
+        RECORD.unpack_from(data, HEADER.size + i * RECORD.size)
+        for i in range(num_records)
+    ]
+
+
+def compact(records, latest_version_only, max_records):
+    if latest_version_only:
+        latest_versions = {}
+        for implementation_id, version, _, _, _, _ in records:
+            latest_versions[implementation_id] = max(
+                version, latest_versions.get(implementation_id, version))
+        records = [
+            record for record in records
+            if record[1] == latest_versions[record[0]]
+        ]
+
+    seen = set()
+    unique_records = []
+    for record in records:
+        key = record[:5]
+        if key not in seen:
+            seen.add(key)
+            unique_records.append(record)
+
+    if max_records is not None and len(unique_records) > max_records:
+        # Keep the most recently appended records.
+        unique_records = unique_records[len(unique_records) - max_records:]
+    return unique_records
+
+
+def write_records(cache_file_name, records):
+    temp_file_name = "{}.compact.{}".format(cache_file_name, os.getpid())
+    with open(temp_file_name, "wb") as f:
+        f.write(HEADER.pack(MAGIC, FORMAT_VERSION, RECORD.size))
+        for record in records:
+            f.write(RECORD.pack(*record))
+    os.replace(temp_file_name, cache_file_name)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("cache_file", help="result cache file to compact")
+    parser.add_argument(
+        "--latest-version-only",
+        action="store_true",
+        help="drop records from all but the newest version of each "
+        "implementation")
+    parser.add_argument(
+        "--max-records",
+        type=int,
+        help="keep at most this many of the most recently added records")
+    args = parser.parse_args()
+
+    records = read_records(args.cache_file)
+    compacted = compact(records, args.latest_version_only, args.max_records)
+    write_records(args.cache_file, compacted)
+    print("{}: {} records compacted to {}".format(args.cache_file,
+                                                  len(records),
+                                                  len(compacted)))
+
+
+if __name__ == "__main__":
+    main()
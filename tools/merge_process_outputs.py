@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+Merges the outputs written by every process of an application that forks or
+execs into the output of the whole application.
+
+Processes forked by the application write their outputs to the file given on
+the command line with a dot and their process id appended, counting only what
+they execute themselves, and so does every process with -per_process_outputs.
+This sums the counts of -print_fp_bits_manipulated and
+-print_function_num_fp_ops, combining the confidence intervals of sampled runs,
+concatenates the operations of -print_fp_ops and keeps every distinct line of
+-print_fp_ins_addresses.
+"""
+
+import argparse
+import glob
+import math
+import os
+import re
+import sys
+
+KINDS = ("fp_bits_manipulated", "function_num_fp_ops", "fp_ops",
+         "fp_ins_addresses")
+
+
+def process_output_file_names(file_name):
+    """Returns the output of the root process, if any, and then those of the
+    other processes in the order of their process ids."""
+    file_names = [file_name] if os.path.exists(file_name) else []
+    pattern = re.compile(re.escape(file_name) + r"\.(\d+)$")
+    process_file_names = [
+        name for name in glob.glob(glob.escape(file_name) + ".*")
+        if pattern.match(name)
+    ]
+    process_file_names.sort(key=lambda name: int(pattern.match(name).group(1)))
+    return file_names + process_file_names
+
+
+def read_lines(file_name):
+    """Returns the description of the sampling, if any, and the other lines."""
+    with open(file_name) as f:
+        lines = f.read().splitlines()
+    if lines and lines[0].startswith("# sampled "):
+        return lines[0], lines[1:]
+    return None, lines
+
+
+def check_sampling(file_name, description, sampling):
+    if sampling is not None and description != sampling:
+        sys.stderr.write(
+            "{} was not sampled like the other outputs\n".format(file_name))
+        sys.exit(1)
+
+
+def merge_counts(file_names, kind):
+    """Sums the counts, and the squares of the confidence intervals, of every
+    function or of the bits manipulated."""
+    sampling = None
+    counts = {}
+    for index, file_name in enumerate(file_names):
+        description, lines = read_lines(file_name)
+        if index > 0:
+            check_sampling(file_name, description, sampling)
+        sampling = description
+        for line in lines:
+            if not line:
+                continue
+            if kind == "fp_bits_manipulated":
+                name, fields = "", line.split()
+            else:
+                fields = line.rsplit(" ", 2 if description else 1)
+                name, fields = fields[0], fields[1:]
+            count, variance = counts.get(name, (0, 0.0))
+            count += int(fields[0])
+            if description:
+                variance += float(fields[1])**2
+            counts[name] = (count, variance)
+    return sampling, counts
+
+
+def write_counts(output, kind, sampling, counts):
+    if sampling:
+        output.write("{}\n".format(sampling))
+    for name in sorted(counts):
+        count, variance = counts[name]
+        fields = [str(count)]
+        if kind == "function_num_fp_ops":
+            fields.insert(0, name)
+        if sampling:
+            fields.append(str(int(round(math.sqrt(variance)))))
+        output.write("{}\n".format(" ".join(fields)))
+
+
+def merge_lines(file_names, kind, output):
+    sampling = None
+    seen = set()
+    for index, file_name in enumerate(file_names):
+        description, lines = read_lines(file_name)
+        if index == 0:
+            sampling = description
+            if sampling:
+                output.write("{}\n".format(sampling))
+        else:
+            check_sampling(file_name, description, sampling)
+        for line in lines:
+            if kind == "fp_ins_addresses":
+                if line in seen:
+                    continue
+                seen.add(line)
+            output.write("{}\n".format(line))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("file", help="output file given to NEAT")
+    parser.add_argument("--kind",
+                        required=True,
+                        choices=KINDS,
+                        help="the NEAT feature that wrote the outputs")
+    parser.add_argument(
+        "--output", help="file to write the merged output to, or stdout")
+    args = parser.parse_args()
+
+    file_names = process_output_file_names(args.file)
+    if not file_names:
+        sys.stderr.write("No output {} or {}.<pid>\n".format(
+            args.file, args.file))
+        sys.exit(1)
+
+    output = open(args.output, "w") if args.output else sys.stdout
+    if args.kind in ("fp_bits_manipulated", "function_num_fp_ops"):
+        sampling, counts = merge_counts(file_names, args.kind)
+        write_counts(output, args.kind, sampling, counts)
+    else:
+        merge_lines(file_names, args.kind, output)
+    if args.output:
+        output.close()
+    sys.stderr.write("{} process outputs merged\n".format(len(file_names)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""
+Reconstructs the profiles of a NEAT run from the snapshots it wrote with
+-snapshot_prefix.
+
+The counts of every complete snapshot are summed, so the profiles are
+recovered up to the last snapshot even if the application crashed or was
+killed. The totals are written in the formats of -print_fp_bits_manipulated
+and -print_function_num_fp_ops, without confidence intervals when sampling.
+"""
+
+import argparse
+import os
+import sys
+
+HEADER = "NEAT profile snapshots 1"
+
+
+def snapshot_file_names(prefix):
+    index = 0
+    while os.path.exists("{}.{}".format(prefix, index)):
+        yield "{}.{}".format(prefix, index)
+        index += 1
+
+
+def read_snapshots(prefix):
+    """Returns the complete snapshots of the run, in order."""
+    run_id = None
+    snapshots = []
+    for file_name in snapshot_file_names(prefix):
+        with open(file_name) as f:
+            lines = f.read().split("\n")
+        header = lines[0].rsplit(" ", 1)
+        if len(header) != 2 or header[0] != HEADER:
+            sys.stderr.write("{} is not a profile snapshot file\n".format(
+                file_name))
+            sys.exit(1)
+        # Files with higher indices may be left over from an earlier run.
+        if run_id is None:
+            run_id = header[1]
+        elif header[1] != run_id:
+            break
+        snapshot = None
+        for line in lines[1:]:
+            fields = line.split(" ", 2)
+            if fields[0] == "snapshot":
+                snapshot = {
+                    "index": int(fields[1]),
+                    "time_ms": int(fields[2].split()[0]),
+                    "final": fields[2].endswith(" final"),
+                    "fp_bits_manipulated": None,
+                    "functions": [],
+                }
+            elif snapshot is None:
+                continue
+            elif fields[0] == "fp_bits_manipulated":
+                snapshot["fp_bits_manipulated"] = int(fields[1])
+            elif fields[0] == "function":
+                snapshot["functions"].append((fields[2], int(fields[1])))
+            elif fields[0] == "end" and int(fields[1]) == snapshot["index"]:
+                if snapshot["index"] != len(snapshots):
+                    return snapshots
+                snapshots.append(snapshot)
+                snapshot = None
+        if snapshot is not None:
+            # The run stopped while this snapshot was being written.
+            break
+    if run_id is None:
+        sys.stderr.write("No snapshot file {}.0\n".format(prefix))
+        sys.exit(1)
+    return snapshots
+
+
+def merge(snapshots):
+    fp_bits_manipulated = None
+    function_num_fp_ops = {}
+    for snapshot in snapshots:
+        if snapshot["fp_bits_manipulated"] is not None:
+            fp_bits_manipulated = ((fp_bits_manipulated or 0) +
+                                   snapshot["fp_bits_manipulated"])
+        for name, count in snapshot["functions"]:
+            function_num_fp_ops[name] = function_num_fp_ops.get(name,
+                                                                0) + count
+    return fp_bits_manipulated, function_num_fp_ops
+
+
+def write_fp_bits_manipulated(output, fp_bits_manipulated):
+    output.write("{}\n".format(fp_bits_manipulated))
+
+
+def write_function_num_fp_ops(output, function_num_fp_ops):
+    for name in sorted(function_num_fp_ops):
+        output.write("{} {}\n".format(name, function_num_fp_ops[name]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("prefix", help="prefix given to -snapshot_prefix")
+    parser.add_argument(
+        "--fp-bits-manipulated-output",
+        help="file to write the number of bits manipulated to")
+    parser.add_argument(
+        "--function-num-fp-ops-output",
+        help="file to write the number of operations per function to")
+    args = parser.parse_args()
+
+    snapshots = read_snapshots(args.prefix)
+    fp_bits_manipulated, function_num_fp_ops = merge(snapshots)
+
+    if args.fp_bits_manipulated_output and fp_bits_manipulated is not None:
+        with open(args.fp_bits_manipulated_output, "w") as f:
+            write_fp_bits_manipulated(f, fp_bits_manipulated)
+    if args.function_num_fp_ops_output:
+        with open(args.function_num_fp_ops_output, "w") as f:
+            write_function_num_fp_ops(f, function_num_fp_ops)
+    if (not args.fp_bits_manipulated_output and
+            not args.function_num_fp_ops_output):
+        if fp_bits_manipulated is not None:
+            print("# fp bits manipulated")
+            write_fp_bits_manipulated(sys.stdout, fp_bits_manipulated)
+        if function_num_fp_ops:
+            print("# function num fp ops")
+            write_function_num_fp_ops(sys.stdout, function_num_fp_ops)
+
+    if not snapshots:
+        status = "no complete snapshot"
+    elif snapshots[-1]["final"]:
+        status = "the application exited"
+    else:
+        status = "the last snapshot, {:.1f} s into the run".format(
+            snapshots[-1]["time_ms"] / 1000.0)
+    sys.stderr.write("{} snapshots merged up to {}\n".format(
+        len(snapshots), status))
+
+
+if __name__ == "__main__":
+    main()
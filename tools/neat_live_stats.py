@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""
+Prints the live statistics that NEAT publishes with -live_stats.
+
+The shared memory segment is polled without pausing the instrumented
+application, and the operation rates since the previous poll are printed with
+the counts. Polling stops once the application has exited, after printing its
+final statistics.
+"""
+
+import argparse
+import mmap
+import os
+import struct
+import sys
+import time
+
+HEADER = struct.Struct("=8sIIQQQQQQ4QQQQQQQ")
+FUNCTION = struct.Struct("=120sQ")
+MAGIC = b"NEATLIV\0"
+FORMAT_VERSION = 1
+OPCODES = ["addss", "subss", "mulss", "divss"]
+# Offset of the sequence counter within the segment.
+SEQUENCE_OFFSET = 16
+# Number of times a segment that is being updated is read again before giving
+# up on it.
+MAX_RETRIES = 1000
+
+
+def segment_path(segment_name):
+    # POSIX shared memory objects are files in /dev/shm on Linux.
+    return os.path.join("/dev/shm", segment_name.lstrip("/"))
+
+
+def read_sequence(mapping):
+    return struct.unpack_from("=Q", mapping, SEQUENCE_OFFSET)[0]
+
+
+def read_statistics(mapping):
+    for _ in range(MAX_RETRIES):
+        sequence = read_sequence(mapping)
+        if sequence % 2 == 1:
+            time.sleep(0.001)
+            continue
+        data = mapping[:]
+        if read_sequence(mapping) == sequence:
+            return parse_statistics(data)
+    sys.stderr.write("The live statistics are updated too often to read\n")
+    sys.exit(1)
+
+
+def parse_statistics(data):
+    fields = HEADER.unpack_from(data)
+    magic, format_version, max_functions = fields[:3]
+    if magic != MAGIC or format_version != FORMAT_VERSION:
+        return None
+    (_, pid, exited, num_updates, update_time_ns, fp_ops) = fields[3:9]
+    opcode_fp_ops = fields[9:13]
+    (replaced_fp_ops, replaced_math_calls, has_fp_bits_manipulated,
+     has_function_fp_ops, fp_bits_manipulated, num_functions) = fields[13:19]
+    functions = []
+    for i in range(min(num_functions, max_functions)):
+        name, count = FUNCTION.unpack_from(data,
+                                           HEADER.size + i * FUNCTION.size)
+        functions.append((name.split(b"\0", 1)[0].decode(errors="replace"),
+                          count))
+    return {
+        "pid": pid,
+        "exited": bool(exited),
+        "num_updates": num_updates,
+        "update_time": update_time_ns / 1e9,
+        "fp_ops": fp_ops,
+        "opcode_fp_ops": dict(zip(OPCODES, opcode_fp_ops)),
+        "replaced_fp_ops": replaced_fp_ops,
+        "replaced_math_calls": replaced_math_calls,
+        "fp_bits_manipulated":
+        fp_bits_manipulated if has_fp_bits_manipulated else None,
+        "functions": functions if has_function_fp_ops else None,
+    }
+
+
+def print_statistics(statistics, previous, top):
+    state = "exited" if statistics["exited"] else "running"
+    print("pid {} {}, update {}, {:.1f} s old".format(
+        statistics["pid"], state, statistics["num_updates"],
+        max(0.0, time.time() - statistics["update_time"])))
+    rate = ""
+    if previous is not None:
+        elapsed = statistics["update_time"] - previous["update_time"]
+        if elapsed > 0:
+            rate = ", {:.0f} ops/s".format(
+                (statistics["fp_ops"] - previous["fp_ops"]) / elapsed)
+    print("  fp ops: {}{}".format(statistics["fp_ops"], rate))
+    print("  " + ", ".join("{} {}".format(opcode, count) for opcode, count in
+                           statistics["opcode_fp_ops"].items()))
+    print("  replaced fp ops: {}, replaced math calls: {}".format(
+        statistics["replaced_fp_ops"], statistics["replaced_math_calls"]))
+    if statistics["fp_bits_manipulated"] is not None:
+        print("  fp bits manipulated: {}".format(
+            statistics["fp_bits_manipulated"]))
+    if statistics["functions"] is not None:
+        for name, count in statistics["functions"][:top]:
+            print("  {:>16} {}".format(count, name))
+    sys.stdout.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("segment", help="name given to -live_stats")
+    parser.add_argument("--interval",
+                        type=float,
+                        default=1.0,
+                        help="seconds between polls")
+    parser.add_argument("--once",
+                        action="store_true",
+                        help="print the statistics once and exit")
+    parser.add_argument("--top",
+                        type=int,
+                        default=10,
+                        help="number of functions to print")
+    parser.add_argument(
+        "--unlink",
+        action="store_true",
+        help="remove the segment once the application has exited")
+    args = parser.parse_args()
+
+    path = segment_path(args.segment)
+    try:
+        with open(path, "rb") as f:
+            mapping = mmap.mmap(f.fileno(), 0, prot=mmap.PROT_READ)
+    except (OSError, ValueError) as error:
+        sys.stderr.write("Could not open {}: {}\n".format(path, error))
+        sys.exit(1)
+    if len(mapping) < HEADER.size:
+        sys.stderr.write("{} is not a live statistics segment\n".format(path))
+        sys.exit(1)
+
+    previous = None
+    while True:
+        statistics = read_statistics(mapping)
+        if statistics is None:
+            # NEAT has not initialized the segment yet.
+            if args.once:
+                sys.stderr.write(
+                    "{} is not a live statistics segment\n".format(path))
+                sys.exit(1)
+        elif previous is None or (statistics["num_updates"] !=
+                                  previous["num_updates"]):
+            print_statistics(statistics, previous, args.top)
+            previous = statistics
+        if args.once or (statistics is not None and statistics["exited"]):
+            break
+        time.sleep(args.interval)
+
+    mapping.close()
+    if args.unlink and previous is not None and previous["exited"]:
+        os.unlink(path)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,372 @@
+#!/usr/bin/env python3
+"""
+Searches for the functions of an application that tolerate reduced precision.
+
+The application is run natively once for a reference output, and once under
+NEAT with -print_function_num_fp_ops to find the functions executing
+floating-point operations. Each candidate implementation, given as a rule of
+-fp_selector_config such as "bfloat16" or "soft_float mantissa_bits=10", is
+then tried in the order given, the most aggressive first: a delta-debugging
+search assigns it to as many of the functions not yet assigned as possible
+while the output of the application stays acceptable. The remaining functions
+execute normally.
+
+Candidate configurations run as concurrent NEAT processes, --jobs at a time.
+Every set of failing functions is split in two and its halves are tried again,
+sets that pass are merged, and a function is only left out when the output
+is unacceptable with it added on its own to the final assignment. The outcome
+of every configuration is memoized in --cache, so an interrupted search
+resumes where it stopped, unless NEAT or the application was rebuilt since.
+
+An output is acceptable if the --check command, run with the output and the
+reference output file names as its last two arguments, exits with status 0.
+Without --check, the outputs must be identical except for numbers, which may
+differ from the reference by a relative error of at most --tolerance.
+
+The assignment found is written to --output as a config file for
+-fp_selector_config.
+"""
+
+import argparse
+import concurrent.futures
+import json
+import math
+import os
+import re
+import shlex
+import shutil
+import subprocess
+import sys
+import tempfile
+
+NUMBER_REGEX = re.compile(
+    r"[-+]?(?:\d+\.?\d*(?:[eE][-+]?\d+)?|\.\d+(?:[eE][-+]?\d+)?|inf|nan)",
+    re.IGNORECASE)
+
+
+class Runner:
+    """Runs the application with NEAT in a configuration and checks its
+    output, memoizing the outcome of every configuration."""
+
+    def __init__(self, args, work_dir, reference_file_name):
+        self.args = args
+        self.work_dir = work_dir
+        self.reference_file_name = reference_file_name
+        self.num_runs = 0
+        # The outcomes are only valid for the same application and check, and
+        # for the same builds of NEAT and of the application.
+        self.signature = {
+            "pin": args.pin,
+            "neat": args.neat,
+            "neat_file": file_signature(args.neat),
+            "neat_knobs": args.neat_knobs,
+            "application": args.application,
+            "application_file": file_signature(
+                shutil.which(args.application[0]) or args.application[0]),
+            "check": args.check,
+            "tolerance": args.tolerance,
+        }
+        self.outcomes = {}
+        if args.cache and os.path.exists(args.cache):
+            with open(args.cache) as f:
+                cache = json.load(f)
+            if cache.get("signature") == self.signature:
+                self.outcomes = cache["outcomes"]
+
+    def save(self):
+        if not self.args.cache:
+            return
+        cache_dir = os.path.dirname(os.path.abspath(self.args.cache))
+        with tempfile.NamedTemporaryFile("w", dir=cache_dir,
+                                         delete=False) as f:
+            json.dump({
+                "signature": self.signature,
+                "outcomes": self.outcomes
+            }, f)
+        os.replace(f.name, self.args.cache)
+
+    @staticmethod
+    def key(assignment):
+        return "\n".join("{} {}".format(function, rule)
+                         for function, rule in sorted(assignment.items()))
+
+    def run(self, assignment):
+        """Returns whether the output of the application is acceptable with
+        every function of the assignment replaced by its rule."""
+        run_dir = tempfile.mkdtemp(prefix="run_", dir=self.work_dir)
+        try:
+            config_file_name = os.path.join(run_dir, "neat.config")
+            write_config(config_file_name, assignment)
+            output_file_name = os.path.join(run_dir, "stdout")
+            command = (shlex.split(self.args.pin) +
+                       ["-t", self.args.neat, "-fp_selector_config",
+                        config_file_name] +
+                       shlex.split(self.args.neat_knobs) + ["--"] +
+                       self.args.application)
+            with open(output_file_name, "w") as output:
+                try:
+                    result = subprocess.run(command,
+                                            stdout=output,
+                                            stderr=subprocess.DEVNULL,
+                                            timeout=self.args.timeout)
+                except subprocess.TimeoutExpired:
+                    return False
+            return result.returncode == 0 and check_output(
+                self.args, output_file_name, self.reference_file_name)
+        finally:
+            shutil.rmtree(run_dir)
+
+    def run_all(self, assignments):
+        """Returns whether the output is acceptable with each assignment,
+        running those whose outcome is unknown concurrently."""
+        pending = {}
+        for assignment in assignments:
+            key = self.key(assignment)
+            if key not in self.outcomes:
+                pending[key] = assignment
+        if pending:
+            with concurrent.futures.ThreadPoolExecutor(
+                    max_workers=self.args.jobs) as executor:
+                futures = {
+                    key: executor.submit(self.run, assignment)
+                    for key, assignment in pending.items()
+                }
+                for key, future in futures.items():
+                    self.outcomes[key] = future.result()
+            self.num_runs += len(pending)
+            self.save()
+        return [self.outcomes[self.key(assignment)]
+                for assignment in assignments]
+
+
+def file_signature(file_name):
+    """Returns the size and modification time of a file, which change when
+    it is rebuilt, or None if it does not exist."""
+    try:
+        file_stat = os.stat(file_name)
+    except OSError:
+        return None
+    return [file_stat.st_size, file_stat.st_mtime_ns]
+
+
+def split_numbers(text):
+    """Returns the text between the numbers of a text, and the numbers."""
+    return NUMBER_REGEX.split(text), NUMBER_REGEX.findall(text)
+
+
+def numbers_match(number, reference, tolerance):
+    value = float(number)
+    reference_value = float(reference)
+    if math.isnan(value) or math.isnan(reference_value):
+        return math.isnan(value) and math.isnan(reference_value)
+    if value == reference_value:
+        return True
+    if math.isinf(value) or math.isinf(reference_value):
+        return False
+    if reference_value == 0:
+        return abs(value) <= tolerance
+    return abs(value - reference_value) <= tolerance * abs(reference_value)
+
+
+def check_output(args, output_file_name, reference_file_name):
+    if args.check:
+        result = subprocess.run(shlex.split(args.check) +
+                                [output_file_name, reference_file_name],
+                                stdout=subprocess.DEVNULL,
+                                stderr=subprocess.DEVNULL)
+        return result.returncode == 0
+    with open(output_file_name, errors="replace") as f:
+        text, numbers = split_numbers(f.read())
+    with open(reference_file_name, errors="replace") as f:
+        reference_text, reference_numbers = split_numbers(f.read())
+    return (text == reference_text and
+            len(numbers) == len(reference_numbers) and all(
+                numbers_match(number, reference, args.tolerance)
+                for number, reference in zip(numbers, reference_numbers)))
+
+
+def write_config(config_file_name, assignment, comment=None):
+    with open(config_file_name, "w") as f:
+        if comment:
+            f.write("# {}\n".format(comment))
+        for function, rule in sorted(assignment.items()):
+            f.write("exact {} {}\n".format(function, rule))
+
+
+def run_reference(args, work_dir):
+    """Runs the application natively and returns the file containing its
+    output."""
+    reference_file_name = os.path.join(work_dir, "reference")
+    with open(reference_file_name, "w") as output:
+        result = subprocess.run(args.application, stdout=output)
+    if result.returncode != 0:
+        sys.stderr.write("{} failed with exit status {}\n".format(
+            " ".join(args.application), result.returncode))
+        sys.exit(1)
+    return reference_file_name
+
+
+def read_functions(file_name, min_fp_ops):
+    """Returns the functions of a -print_function_num_fp_ops output executing
+    at least min_fp_ops operations, those executing the most first."""
+    counts = []
+    with open(file_name) as f:
+        for line in f:
+            if line.startswith("#") or not line.strip():
+                continue
+            # Sampled outputs end with the half-width of a confidence
+            # interval.
+            fields = line.split()
+            count = int(fields[1])
+            if count >= min_fp_ops:
+                counts.append((fields[0], count))
+    counts.sort(key=lambda count: (-count[1], count[0]))
+    return [function for function, _ in counts]
+
+
+def profile_functions(args, work_dir):
+    profile_file_name = os.path.join(work_dir, "function_num_fp_ops")
+    command = (shlex.split(args.pin) +
+               ["-t", args.neat, "-print_function_num_fp_ops",
+                profile_file_name] + shlex.split(args.neat_knobs) + ["--"] +
+               args.application)
+    result = subprocess.run(command, stdout=subprocess.DEVNULL)
+    if result.returncode != 0:
+        sys.stderr.write("{} failed with exit status {}\n".format(
+            " ".join(command), result.returncode))
+        sys.exit(1)
+    return profile_file_name
+
+
+def halves(functions):
+    middle = len(functions) // 2
+    return [functions[:middle], functions[middle:]]
+
+
+def search(runner, assignment, functions, rule):
+    """Assigns a rule to as many functions as possible on top of an
+    assignment that is known to be acceptable, and returns the functions that
+    could not be assigned it."""
+
+    def with_rule(group):
+        extended = dict(assignment)
+        extended.update((function, rule) for function in group)
+        return extended
+
+    pending = [functions] if functions else []
+    rejected = []
+    while pending:
+        outcomes = runner.run_all([with_rule(group) for group in pending])
+        passing = [group for group, ok in zip(pending, outcomes) if ok]
+        failing = [group for group, ok in zip(pending, outcomes) if not ok]
+        pending = []
+        # Groups that pass on their own may still fail together, in which
+        # case only the first is accepted and the others are tried again.
+        if passing:
+            merged = [f for group in passing for f in group]
+            if len(passing) == 1 or runner.run_all([with_rule(merged)])[0]:
+                assignment.update(with_rule(merged))
+            else:
+                assignment.update(with_rule(passing[0]))
+                pending += passing[1:]
+        for group in failing:
+            if len(group) == 1:
+                rejected += group
+            else:
+                pending += halves(group)
+        print("{:24} {:5} assigned {:5} pending {:5} rejected {:5} runs".
+              format(rule[:24],
+                     sum(1 for r in assignment.values() if r == rule),
+                     sum(len(group) for group in pending), len(rejected),
+                     runner.num_runs))
+        sys.stdout.flush()
+        # A function rejected earlier may pass with the final assignment.
+        if not pending and rejected:
+            outcomes = runner.run_all([with_rule([f]) for f in rejected])
+            retried = [[f] for f, ok in zip(rejected, outcomes) if ok]
+            rejected = [f for f, ok in zip(rejected, outcomes) if not ok]
+            pending = retried
+    return rejected
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--pin",
+                        required=True,
+                        help="command that runs Pin, split like a shell would")
+    parser.add_argument("--neat", required=True, help="NEAT pintool")
+    parser.add_argument("--neat-knobs",
+                        default="",
+                        help="other NEAT knobs of every run, split like a "
+                        "shell would")
+    parser.add_argument("--candidates",
+                        required=True,
+                        nargs="+",
+                        help="rules of -fp_selector_config to try, most "
+                        "aggressive first")
+    parser.add_argument("--check",
+                        help="command checking an output against the "
+                        "reference output, split like a shell would")
+    parser.add_argument("--tolerance",
+                        type=float,
+                        default=0,
+                        help="largest relative error of the numbers of an "
+                        "output without --check")
+    parser.add_argument("--functions",
+                        help="-print_function_num_fp_ops output to take the "
+                        "functions from instead of profiling the application")
+    parser.add_argument("--min-fp-ops",
+                        type=int,
+                        default=1,
+                        help="smallest number of operations of the functions "
+                        "searched")
+    parser.add_argument("--jobs",
+                        type=int,
+                        default=os.cpu_count(),
+                        help="number of NEAT processes run concurrently")
+    parser.add_argument("--timeout",
+                        type=float,
+                        help="seconds after which a run is unacceptable")
+    parser.add_argument("--cache",
+                        help="JSON file memoizing the outcome of every "
+                        "configuration across searches")
+    parser.add_argument("--output",
+                        required=True,
+                        help="config file to write the assignment found to")
+    parser.add_argument("application",
+                        nargs=argparse.REMAINDER,
+                        help="the application and its arguments, after --")
+    args = parser.parse_args()
+    if args.application and args.application[0] == "--":
+        args.application = args.application[1:]
+    if not args.application:
+        parser.error("the application to search must follow --")
+    if args.jobs < 1:
+        parser.error("--jobs must be at least 1")
+    if args.tolerance < 0:
+        parser.error("--tolerance must not be negative")
+
+    with tempfile.TemporaryDirectory(prefix="neat_precision_") as work_dir:
+        reference_file_name = run_reference(args, work_dir)
+        functions_file_name = args.functions or profile_functions(
+            args, work_dir)
+        functions = read_functions(functions_file_name, args.min_fp_ops)
+        print("Searching {} functions".format(len(functions)))
+        runner = Runner(args, work_dir, reference_file_name)
+        assignment = {}
+        for rule in args.candidates:
+            functions = search(runner, assignment, functions, rule)
+
+    write_config(
+        args.output, assignment,
+        "Found by neat_precision_search.py in {} runs; {} functions execute "
+        "normally".format(runner.num_runs, len(functions)))
+    for rule in args.candidates:
+        print("{:5} functions use {}".format(
+            sum(1 for r in assignment.values() if r == rule), rule))
+    print("{:5} functions execute normally".format(len(functions)))
+    print("Assignment written to {}".format(args.output))
+
+
+if __name__ == "__main__":
+    main()
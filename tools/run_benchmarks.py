@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+"""
+Measures the slowdown of NEAT on the floating-point benchmark kernels.
+
+Each kernel runs natively and then under Pin with NEAT in a series of knob
+configurations, and its wall time is the fastest of several repetitions. The
+multithreaded reduction runs at every power of two number of threads up to
+--max-threads, so that the thread-scaling efficiency of each configuration,
+T(1) / (n * T(n)), can be compared with that of the native run.
+
+Results are written as JSON, one record per kernel, number of threads and
+configuration, and summarized as a table on stdout.
+"""
+
+import argparse
+import json
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+import time
+
+# Kernels and their command line arguments, relative to the application
+# directory. The reduction takes its number of threads as its first argument.
+KERNELS = [
+    ("sgemm", "benchmark_sgemm", []),
+    ("nbody", "benchmark_nbody", []),
+    ("fft", "benchmark_fft", []),
+    ("stencil", "benchmark_stencil", []),
+]
+THREADED_KERNEL = ("reduction", "benchmark_reduction", [])
+
+# NEAT knobs of each configuration. "{out}" is replaced by a file name in a
+# temporary directory, and the configuration "native" runs without Pin.
+CONFIGURATIONS = [
+    ("native", None),
+    ("pin_only", []),
+    ("print_fp_ops", ["-print_fp_ops", "{out}"]),
+    ("print_fp_ops_sampled",
+     ["-print_fp_ops", "{out}", "-sample_period", "1000"]),
+    ("print_fp_bits_manipulated", ["-print_fp_bits_manipulated", "{out}"]),
+    ("print_function_num_fp_ops", ["-print_function_num_fp_ops", "{out}"]),
+    ("print_function_num_fp_ops_traces",
+     ["-print_function_num_fp_ops", "{out}", "-trace_instrumentation"]),
+    ("replace_normal", ["-fp_selector_name", "default"]),
+    ("replace_normal_traces",
+     ["-fp_selector_name", "default", "-trace_instrumentation"]),
+    ("replace_bfloat16", ["-fp_selector_name", "bfloat16"]),
+    ("replace_bfloat16_truncated",
+     ["-fp_selector_name", "bfloat16_truncated"]),
+    ("replace_posit16_es1", ["-fp_selector_name", "posit16_es1"]),
+]
+
+# Configurations only run when named by --configurations. A full trace of the
+# kernels is gigabytes of output per run, sgemm alone performing over 100
+# million operations, so the sampled trace stands for it by default.
+OPT_IN_CONFIGURATIONS = {"print_fp_ops"}
+
+
+def run_once(command):
+    start = time.monotonic()
+    result = subprocess.run(command,
+                            stdout=subprocess.DEVNULL,
+                            stderr=subprocess.PIPE)
+    wall_time = time.monotonic() - start
+    if result.returncode != 0:
+        sys.stderr.write("{} failed with exit status {}:\n{}".format(
+            " ".join(command), result.returncode,
+            result.stderr.decode(errors="replace")))
+        sys.exit(1)
+    return wall_time
+
+
+def build_command(args, knobs, app, app_args, output_dir):
+    app_command = [os.path.join(args.app_dir, app)] + app_args
+    if knobs is None:
+        return app_command
+    output_file_name = os.path.join(output_dir, "neat.out")
+    tool_command = [knob.replace("{out}", output_file_name) for knob in knobs]
+    return (shlex.split(args.pin) + ["-t", args.neat] + tool_command +
+            ["--"] + app_command)
+
+
+def measure(args, knobs, app, app_args):
+    with tempfile.TemporaryDirectory(prefix="neat_benchmark_") as output_dir:
+        command = build_command(args, knobs, app, app_args, output_dir)
+        return min(
+            run_once(command) for _ in range(args.repetitions))
+
+
+def thread_counts(max_threads):
+    counts = []
+    num_threads = 1
+    while num_threads <= max_threads:
+        counts.append(num_threads)
+        num_threads *= 2
+    return counts
+
+
+def run_benchmarks(args, configurations):
+    runs = [(name, app, app_args, 1) for name, app, app_args in KERNELS]
+    name, app, app_args = THREADED_KERNEL
+    runs += [(name, app, [str(num_threads)] + app_args, num_threads)
+             for num_threads in thread_counts(args.max_threads)]
+
+    results = []
+    native_times = {}
+    single_thread_times = {}
+    for kernel, app, app_args, num_threads in runs:
+        for configuration, knobs in configurations:
+            wall_time = measure(args, knobs, app, app_args)
+            if knobs is None:
+                native_times[(kernel, num_threads)] = wall_time
+            if num_threads == 1:
+                single_thread_times[(kernel, configuration)] = wall_time
+            native_time = native_times.get((kernel, num_threads))
+            single_thread_time = single_thread_times[(kernel, configuration)]
+            results.append({
+                "kernel": kernel,
+                "threads": num_threads,
+                "configuration": configuration,
+                "knobs": knobs,
+                "wall_time": wall_time,
+                "slowdown": wall_time / native_time if native_time else None,
+                "scaling_efficiency":
+                single_thread_time / (num_threads * wall_time),
+            })
+            print("{:10} {:3} {:34} {:9.3f}s {:>9}".format(
+                kernel, num_threads, configuration, wall_time,
+                "{:.1f}x".format(wall_time / native_time)
+                if native_time else "-"))
+            sys.stdout.flush()
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--pin",
+                        required=True,
+                        help="command that runs Pin, split like a shell would")
+    parser.add_argument("--neat", required=True, help="NEAT pintool")
+    parser.add_argument("--app-dir",
+                        required=True,
+                        help="directory containing the benchmark kernels")
+    parser.add_argument("--output",
+                        required=True,
+                        help="JSON file to write the results to")
+    parser.add_argument("--repetitions",
+                        type=int,
+                        default=3,
+                        help="number of runs of which the fastest is recorded")
+    parser.add_argument("--max-threads",
+                        type=int,
+                        default=64,
+                        help="largest number of threads of the reduction")
+    parser.add_argument(
+        "--configurations",
+        nargs="+",
+        choices=[name for name, _ in CONFIGURATIONS],
+        help="configurations to run instead of all but {}; native always "
+        "runs".format(", ".join(sorted(OPT_IN_CONFIGURATIONS))))
+    args = parser.parse_args()
+
+    configurations = [
+        (name, knobs) for name, knobs in CONFIGURATIONS
+        if knobs is None or (name not in OPT_IN_CONFIGURATIONS
+                             if args.configurations is None else
+                             name in args.configurations)
+    ]
+    results = run_benchmarks(args, configurations)
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=2)
+        f.write("\n")
+    print("Results written to {}".format(args.output))
+
+
+if __name__ == "__main__":
+    main()